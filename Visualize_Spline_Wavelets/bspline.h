@@ -0,0 +1,134 @@
+/*
+ * bspline.h
+ * Cardinal B-splines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_BSPLINE_H
+#define SPLINE_BSPLINE_H
+
+
+/*
+ * Reference implementation by the Cox-de Boor recursion, 2^(k-1) calls of
+ * Bspline<1> per evaluation. Kept to verify BsplineHorner<k>.
+ * @param x value
+ * @param s shift
+ */
+template <int k>
+double Bspline(double x, double s)
+{
+    if (s <= x && x < (s + k))
+    {
+        double a = (x - s) / ((s + k - 1) - s);
+        double b = ((s + k) - x) / ((s + k) - (s + 1));
+
+        return (a * Bspline<k-1>(x, s) + b * Bspline<k-1>(x, (s + 1)));
+    }
+    else { return 0.0; }
+};
+
+/*
+ * @param x value
+ * @param s shift
+ */
+template <>
+inline double Bspline<1>(double x, double s)
+{
+    if (s <= x && x < (s + 1)) { return 1.0; } else { return 0.0; }
+};
+
+
+
+/*
+ * Polynomial pieces of N_k with support [0, k]:
+ * N_k(r + t) = sum_p coefficient[r][p] t^p for t in [0, 1), r = 0, ..., k-1,
+ * in the scalar type T.
+ */
+template <int k, typename T = double>
+struct bspline_pieces_t
+{
+    T coefficient[k][k];
+};
+
+
+/*
+ * pieces of N_k from those of N_{k-1} by the recursion
+ * N_k(x) = x / (k-1) N_{k-1}(x) + (k-x) / (k-1) N_{k-1}(x-1),
+ * evaluated by the compiler for the built-in floating point types and at
+ * run time for dd_real
+ */
+template <int k, typename T = double>
+constexpr bspline_pieces_t<k, T> bspline_pieces()
+{
+    bspline_pieces_t<k, T> pieces = {};
+
+    if constexpr (k == 1)
+    {
+        pieces.coefficient[0][0] = 1.0;
+    }
+    else
+    {
+        const bspline_pieces_t<k-1, T> lower = bspline_pieces<k-1, T>();
+
+        for (int r = 0; r < k; r++)
+        {
+            /* x / (k-1) N_{k-1}(x) with x = r + t */
+            if (r < k-1)
+            {
+                for (int p = 0; p < k-1; p++)
+                {
+                    pieces.coefficient[r][p] += T(r) * lower.coefficient[r][p] / T(k-1);
+                    pieces.coefficient[r][p+1] += lower.coefficient[r][p] / T(k-1);
+                }
+            }
+            /* (k-x) / (k-1) N_{k-1}(x-1) with x-1 = (r-1) + t */
+            if (r > 0)
+            {
+                for (int p = 0; p < k-1; p++)
+                {
+                    pieces.coefficient[r][p] += T(k - r) * lower.coefficient[r-1][p] / T(k-1);
+                    pieces.coefficient[r][p+1] -= lower.coefficient[r-1][p] / T(k-1);
+                }
+            }
+        }
+    }
+
+    return pieces;
+}
+
+
+template <int k>
+inline constexpr bspline_pieces_t<k> bspline_table = bspline_pieces<k>();
+
+
+/*
+ * N_k(x - s) by one lookup of the unit interval and Horner's rule,
+ * k-1 multiplications and additions per evaluation
+ * @param x value
+ * @param s shift
+ */
+template <int k>
+inline double BsplineHorner(double x, double s)
+{
+    const double y = x - s;
+    if (!(0.0 <= y && y < k)) { return 0.0; }
+
+    const int r = (int) y;
+    const double t = y - r;
+    const double* c = bspline_table<k>.coefficient[r];
+
+    double value = c[k-1];
+    for (int p = k-2; p >= 0; p--)
+    {
+        value = value * t + c[p];
+    }
+
+    return value;
+}
+
+#endif /* SPLINE_BSPLINE_H */
@@ -0,0 +1,173 @@
+/*
+ * multilevel_synthesis.cpp
+ * Functions given by spline wavelet coefficients on several levels.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <climits>
+#include <math.h>
+#include <algorithm>
+#include <ostream>
+#include "multilevel_synthesis.h"
+
+using namespace std;
+
+
+/*
+ * refinement mask a[l] = 2^(1-m) binom(m, l), l = 0..m, of N_m
+ */
+static vector<double> bspline_mask(int m)
+{
+    vector<double> a(m + 1, 0.0);
+    double binomial = 1.0;
+    for (int l = 0; l <= m; l++)
+    {
+        a[l] = ldexp(binomial, 1 - m);
+        binomial = binomial * (m - l) / (l + 1);
+    }
+
+    return a;
+}
+
+
+coefficients_t reconstruct_level(const psi_t& psi, const coefficients_t& scaling, const coefficients_t& wavelet)
+{
+    const vector<double> a = bspline_mask(psi.spline_order);
+    const int m = psi.spline_order;
+    const int nc = (int) scaling.values.size(), nd = (int) wavelet.values.size();
+
+    /* c_j[k] reaches 2k .. 2k+m, d_j[k] reaches 2k + mask_start - 2 .. 2k + mask_end - 2 */
+    int low = INT_MAX, high = INT_MIN;
+    if (nc > 0)
+    {
+        low = min(low, 2*scaling.first);
+        high = max(high, 2*(scaling.first + nc - 1) + m);
+    }
+    if (nd > 0)
+    {
+        low = min(low, 2*wavelet.first + psi.mask_start - 2);
+        high = max(high, 2*(wavelet.first + nd - 1) + psi.mask_end - 2);
+    }
+
+    coefficients_t fine;
+    fine.first = (low <= high) ? low : 0;
+    fine.values.assign((low <= high) ? high - low + 1 : 0, 0.0);
+
+    for (int k = 0; k < nc; k++)
+    {
+        const double c = scaling.values[k];
+        double* f = fine.values.data() + (2*(scaling.first + k) - fine.first);
+        for (int l = 0; l <= m; l++)
+        {
+            f[l] += a[l] * c;
+        }
+    }
+
+    const int taps = psi.mask_end - psi.mask_start + 1;
+    for (int k = 0; k < nd; k++)
+    {
+        const double d = wavelet.values[k];
+        double* f = fine.values.data() + (2*(wavelet.first + k) + psi.mask_start - 2 - fine.first);
+        for (int i = 0; i < taps; i++)
+        {
+            f[i] += psi.mask[i] * d;
+        }
+    }
+
+    return fine;
+}
+
+
+/*
+ * c_J from c_{j0} and d_{j0}, ..., d_{J-1}
+ */
+static coefficients_t pyramid(const psi_t& psi, const coefficients_t& scaling, const vector<coefficients_t>& wavelets)
+{
+    coefficients_t c = scaling;
+    for (size_t j = 0; j < wavelets.size(); j++)
+    {
+        c = reconstruct_level(psi, c, wavelets[j]);
+    }
+
+    return c;
+}
+
+
+MultilevelFunction::MultilevelFunction(const psi_t& psi, int coarsest_level, const coefficients_t& scaling,
+                                       const vector<coefficients_t>& wavelets)
+    : finest(pyramid(psi, scaling, wavelets)), level(coarsest_level + (int) wavelets.size()),
+      evaluator(psi.spline_order, finest.values.data(), finest.first, finest.values.size(), ldexp(1.0, level))
+{
+}
+
+
+bool verify_multilevel(ostream* log)
+{
+    bool all_equal = true;
+    unsigned int seed = 1;
+    const auto random = [&seed] () { seed = seed * 1103515245u + 12345u; return (double) (seed >> 8) / (1 << 24) - 0.5; };
+
+    if (log != NULL)
+    {
+        *log << "\nWavelet | Max. difference of the multilevel synthesis\n"
+             << "----------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const int j0 = 1, levels = 4;
+
+        /* coefficients on [0, 4], points on [-1, 5] */
+        coefficients_t scaling = { -psi.spline_order, vector<double>(4 << j0) };
+        for (size_t k = 0; k < scaling.values.size(); k++) { scaling.values[k] = random(); }
+        vector<coefficients_t> wavelets(levels);
+        for (int j = 0; j < levels; j++)
+        {
+            wavelets[j].first = -2;
+            wavelets[j].values.resize(4 << (j0 + j));
+            for (size_t k = 0; k < wavelets[j].values.size(); k++) { wavelets[j].values[k] = random(); }
+        }
+
+        const size_t n = 6001;
+        vector<double> x(n), y(n), direct(n, 0.0), shifted(n), term(n);
+        for (size_t i = 0; i < n; i++) { x[i] = -1.0 + 6.0 * i / (n - 1); }
+
+        const MultilevelFunction f(psi, j0, scaling, wavelets);
+        f.evaluate(x.data(), y.data(), n);
+
+        const double one = 1.0;
+        const WaveletEvaluator bspline(psi.spline_order, &one, 0, 1, 1.0), wavelet(psi);
+        const auto add = [&] (const WaveletEvaluator& g, int j, int k, double c) {
+            for (size_t i = 0; i < n; i++) { shifted[i] = ldexp(x[i], j) - k; }
+            g.evaluate(shifted.data(), term.data(), n);
+            for (size_t i = 0; i < n; i++) { direct[i] += c * term[i]; }
+        };
+        for (size_t k = 0; k < scaling.values.size(); k++)
+        {
+            add(bspline, j0, scaling.first + (int) k, scaling.values[k]);
+        }
+        for (int j = 0; j < levels; j++)
+        {
+            for (size_t k = 0; k < wavelets[j].values.size(); k++)
+            {
+                add(wavelet, j0 + j, wavelets[j].first + (int) k, wavelets[j].values[k]);
+            }
+        }
+
+        double difference = 0.0, scale = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            difference = max(difference, fabs(y[i] - direct[i]));
+            scale = max(scale, fabs(direct[i]));
+        }
+        if (log != NULL) { *log << "    " << psi.spline_order << "," << psi.vanishing_moments << " | " << difference << "\n"; }
+        all_equal = all_equal && difference <= 1e-12 * scale;
+    }
+
+    return all_equal;
+}
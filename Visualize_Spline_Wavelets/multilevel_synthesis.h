@@ -0,0 +1,97 @@
+/*
+ * multilevel_synthesis.h
+ * Functions given by spline wavelet coefficients on several levels.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_MULTILEVEL_SYNTHESIS_H
+#define SPLINE_MULTILEVEL_SYNTHESIS_H
+
+#include <cstddef>
+#include <vector>
+#include "spline_wavelets.h"
+#include "wavelet_evaluator.h"
+
+
+/*
+ * coefficients of one level, values[i] belongs to the shift first + i
+ */
+typedef struct {
+    int first;
+    std::vector<double> values;
+}coefficients_t;
+
+
+/*
+ * One step of the pyramid reconstruction with the refinement mask
+ * a[l] = 2^(1-m) binom(m, l) of N_m and the mask b of psi:
+ * N_m(2^j x - k) = sum_l a[l] N_m(2^(j+1) x - 2k - l) and
+ * psi(2^j x - k) = sum_i b[i] N_m(2^(j+1) x - 2k - i + 2), so
+ * c_{j+1}[n] = sum_k c_j[k] a[n-2k] + sum_k d_j[k] b[n-2k+2].
+ * O((#c + #d) * mask length) operations.
+ * @param psi spline wavelet
+ * @param scaling B-spline coefficients c_j
+ * @param wavelet wavelet coefficients d_j, may be empty
+ * @return B-spline coefficients c_{j+1}
+ */
+coefficients_t reconstruct_level(const psi_t& psi, const coefficients_t& scaling, const coefficients_t& wavelet);
+
+
+/*
+ * f(x) = sum_k c[k] N_m(2^j0 x - k) + sum_{j=j0}^{J-1} sum_k d_j[k] psi(2^j x - k).
+ *
+ * The constructor reconstructs the B-spline coefficients of f on the finest
+ * level J = j0 + number of wavelet levels by the pyramid algorithm, all
+ * evaluations then use one piecewise polynomial of N_m(2^J x - k) instead of
+ * every single wavelet.
+ */
+class MultilevelFunction
+{
+public:
+    /*
+     * @param psi spline wavelet, the B-splines are those of its order
+     * @param coarsest_level j0
+     * @param scaling c
+     * @param wavelets d_{j0}, ..., d_{J-1}
+     */
+    MultilevelFunction(const psi_t& psi, int coarsest_level, const coefficients_t& scaling,
+                       const std::vector<coefficients_t>& wavelets);
+
+    /* false if the spline order of psi is not implemented */
+    bool valid() const { return evaluator.valid(); }
+
+    int finest_level() const { return level; }
+
+    /* B-spline coefficients of f on the finest level */
+    const coefficients_t& bspline_coefficients() const { return finest; }
+
+    void set_thread_pool(ThreadPool* pool) { evaluator.set_thread_pool(pool); }
+
+    /*
+     * @param x points
+     * @param y f(x[i])
+     * @param n number of points
+     */
+    void evaluate(const double* x, double* y, size_t n) const { evaluator.evaluate(x, y, n); }
+
+private:
+    coefficients_t finest;
+    int level;
+    WaveletEvaluator evaluator;
+};
+
+
+/*
+ * Compare the pyramid reconstruction of random multilevel expansions of
+ * every spline wavelet with the sum of the single B-splines and wavelets.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_multilevel(std::ostream* log);
+
+#endif /* SPLINE_MULTILEVEL_SYNTHESIS_H */
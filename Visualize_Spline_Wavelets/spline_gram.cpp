@@ -0,0 +1,253 @@
+/*
+ * spline_gram.cpp
+ * Exact inner products of shifted B-splines and spline wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <stdint.h>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include "spline_gram.h"
+
+using namespace std;
+
+
+const char* gram_kind_name(gram_kind_t kind)
+{
+    switch (kind)
+    {
+        case gram_bspline: return "<N_m, N_m(. - k)>";
+        case gram_mixed:   return "<N_m, psi(. - k)>";
+        default:           return "<psi, psi(. - k)>";
+    }
+}
+
+
+/*
+ * r-th derivative of the pieces of f in x, each piece in t = z - p:
+ * d/dx = scale d/dz lowers the degree by one per derivative
+ * @param f spline
+ * @param r derivative order, less than the spline order
+ * @param derivative order - r coefficients per piece
+ */
+static void derivative_pieces(const WaveletEvaluator& f, int r, vector<double>& derivative)
+{
+    const int order = f.spline_order(), degree = order - r;
+    const vector<double>& coefficient = f.piece_coefficients();
+    const size_t pieces = coefficient.size() / order;
+    const double factor = pow(f.piece_scale(), r);
+
+    derivative.assign(pieces * degree, 0.0);
+    for (size_t p = 0; p < pieces; p++)
+    {
+        for (int d = r; d < order; d++)
+        {
+            /* t^d -> d! / (d-r)! t^(d-r) */
+            double falling = 1.0;
+            for (int i = 0; i < r; i++) { falling *= d - i; }
+            derivative[p * degree + d - r] = factor * falling * coefficient[p * order + d];
+        }
+    }
+}
+
+
+bool spline_gram(const WaveletEvaluator& f, const WaveletEvaluator& g, int r, band_t& band)
+{
+    const int order = f.spline_order();
+    const double scale = f.piece_scale();
+    const double offset = g.piece_shift() - f.piece_shift();
+    band.first = 0;
+    band.entry.clear();
+    if (!f.valid() || g.spline_order() != order || r < 0 || r >= order) { return false; }
+    if (g.piece_scale() != scale || scale < 1.0 || scale != floor(scale) || offset != floor(offset)) { return false; }
+
+    const int s = (int) scale, delta = (int) offset, degree = order - r;
+    vector<double> F, G;
+    derivative_pieces(f, r, F);
+    derivative_pieces(g, r, G);
+    const int Pf = f.pieces(), Pg = g.pieces();
+
+    /* int_0^1 t^a t^b dt */
+    vector<double> hilbert(degree * degree);
+    for (int a = 0; a < degree; a++)
+    {
+        for (int b = 0; b < degree; b++) { hilbert[a * degree + b] = 1.0 / (a + b + 1); }
+    }
+
+    /*
+     * the piece p of f meets the piece q = p + delta - s k of g(. - k),
+     * both nonzero for 1 <= p <= Pf and 1 <= q <= Pg
+     */
+    const int low = delta + 1 - Pg, high = delta + Pf - 1;
+    const int first = (low >= 0) ? (low + s - 1) / s : -(-low / s);
+    const int last = (high >= 0) ? high / s : -((-high + s - 1) / s);
+    if (last < first) { return true; }
+
+    band.first = first;
+    band.entry.assign(last - first + 1, 0.0);
+    for (int k = first; k <= last; k++)
+    {
+        double value = 0.0;
+        for (int p = 1; p <= Pf; p++)
+        {
+            const int q = p + delta - s * k;
+            if (q < 1 || q > Pg) { continue; }
+
+            const double* A = &F[p * degree];
+            const double* B = &G[q * degree];
+            for (int a = 0; a < degree; a++)
+            {
+                double row = 0.0;
+                for (int b = 0; b < degree; b++) { row += hilbert[a * degree + b] * B[b]; }
+                value += A[a] * row;
+            }
+        }
+        /* dx = dz / scale */
+        band.entry[k - first] = value / scale;
+    }
+
+    return true;
+}
+
+
+static unordered_map<uint64_t, unique_ptr<band_t> > gram_cache;
+static mutex gram_cache_lock;
+
+
+const band_t* select_spline_gram(const psi_t& psi, gram_kind_t kind, int r)
+{
+    const int m = psi.spline_order;
+    const uint64_t key = ((uint64_t) (uint16_t) psi.spline_order << 32) | ((uint64_t) (uint16_t) psi.vanishing_moments << 16)
+                         | ((uint64_t) (r & 0xff) << 8) | (uint64_t) kind;
+
+    lock_guard<mutex> guard(gram_cache_lock);
+
+    const auto found = gram_cache.find(key);
+    if (found != gram_cache.end()) { return found->second.get(); }
+
+    /* N_m(x) = sum_k binom(m, k) / 2^(m-1) N_m(2x - k), on the knots of psi */
+    vector<double> refinement(m + 1, 0.0);
+    refinement[0] = 1.0;
+    for (int i = 1; i <= m; i++)
+    {
+        for (int j = i; j > 0; j--) { refinement[j] += refinement[j-1]; }
+    }
+    for (int i = 0; i <= m; i++) { refinement[i] = ldexp(refinement[i], 1 - m); }
+
+    const WaveletEvaluator bspline(m, refinement.data(), 0, m + 1, 2.0), wavelet(psi);
+    const WaveletEvaluator& f = (kind == gram_wavelet) ? wavelet : bspline;
+    const WaveletEvaluator& g = (kind == gram_bspline) ? bspline : wavelet;
+
+    unique_ptr<band_t> band(new band_t);
+    if (!spline_gram(f, g, r, *band)) { return NULL; }
+
+    return (gram_cache[key] = move(band)).get();
+}
+
+
+/*
+ * N_n(j) at the integer j by the truncated powers,
+ * N_n(x) = 1/(n-1)! sum_i (-1)^i binom(n, i) (x - i)_+^(n-1),
+ * all terms are integers below 2^53 for n <= 14
+ */
+static double bspline_at_integer(int n, int j)
+{
+    if (j <= 0 || j >= n) { return 0.0; }
+
+    double value = 0.0, binomial = 1.0, factorial = 1.0;
+    for (int i = 0; i <= n && i < j; i++)
+    {
+        value += ((i % 2 == 0) ? binomial : -binomial) * pow((double) (j - i), n - 1);
+        binomial = binomial * (n - i) / (i + 1);
+    }
+    for (int i = 2; i < n; i++) { factorial *= i; }
+
+    return value / factorial;
+}
+
+
+/*
+ * int N_m^(r)(z) N_m^(r)(z - k) dz = (-1)^r N_2m^(2r)(m + k)
+ *   = (-1)^r sum_j (-1)^j binom(2r, j) N_{2m-2r}(m + k - j)
+ */
+static double bspline_gram(int m, int r, int k)
+{
+    double value = 0.0, binomial = 1.0;
+    for (int j = 0; j <= 2*r; j++)
+    {
+        value += ((j % 2 == 0) ? binomial : -binomial) * bspline_at_integer(2*m - 2*r, m + k - j);
+        binomial = binomial * (2*r - j) / (j + 1);
+    }
+
+    return (r % 2 == 0) ? value : -value;
+}
+
+
+bool verify_spline_gram(ostream* log)
+{
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nWavelet | Max. difference of the Gram matrices, r = 0, 1, ...\n"
+             << "----------------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const int m = psi.spline_order;
+
+        /* N_m and psi as series of N_m(2x - first - i) */
+        vector<double> refinement(m + 1, ldexp(1.0, 1 - m));
+        for (int i = 1; i <= m; i++) { refinement[i] = refinement[i-1] * (m - i + 1) / i; }
+        const vector<double> wavelet(psi.mask, psi.mask + (psi.mask_end - psi.mask_start + 1));
+        const struct { const vector<double>* c; int first; } series[] = { {&refinement, 0}, {&wavelet, psi.mask_start - 2} };
+        const int pairs[][2] = { {0, 0}, {0, 1}, {1, 1} };
+
+        if (log != NULL) { *log << "    " << m << "," << psi.vanishing_moments << " |"; }
+        for (int r = 0; r < m; r++)
+        {
+            double difference = 0.0, scale = 0.0;
+            for (int kind = gram_bspline; kind <= gram_wavelet; kind++)
+            {
+                const band_t* band = select_spline_gram(psi, (gram_kind_t) kind, r);
+                if (band == NULL || select_spline_gram(psi, (gram_kind_t) kind, r) != band)
+                {
+                    all_equal = false;
+                    continue;
+                }
+
+                const auto& f = series[pairs[kind][0]];
+                const auto& g = series[pairs[kind][1]];
+                for (int k = band->first - 2; k < band->first + (int) band->entry.size() + 2; k++)
+                {
+                    double expected = 0.0;
+                    for (size_t i = 0; i < f.c->size(); i++)
+                    {
+                        for (size_t j = 0; j < g.c->size(); j++)
+                        {
+                            const int shift = 2*k + (g.first + (int) j) - (f.first + (int) i);
+                            expected += (*f.c)[i] * (*g.c)[j] * bspline_gram(m, r, shift);
+                        }
+                    }
+                    expected *= ldexp(1.0, 2*r - 1);
+                    difference = max(difference, fabs(band_value(*band, k) - expected));
+                    scale = max(scale, fabs(expected));
+                }
+            }
+            if (log != NULL) { *log << " " << difference; }
+            all_equal = all_equal && difference <= 1e-12 * max(1.0, scale);
+        }
+        if (log != NULL) { *log << "\n"; }
+    }
+
+    return all_equal;
+}
@@ -0,0 +1,63 @@
+/*
+ * spline_gram.h
+ * Exact inner products of shifted B-splines and spline wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_SPLINE_GRAM_H
+#define SPLINE_SPLINE_GRAM_H
+
+#include "spline_wavelets.h"
+#include "wavelet_evaluator.h"
+#include "../common/banded_matrix.h"
+
+
+/*
+ * pairs of functions of the inner products, N_m with support [0, m] and
+ * psi with support [output_start, output_end]
+ */
+typedef enum {
+    gram_bspline = 0,  /* <N_m, N_m(. - k)> */
+    gram_mixed,        /* <N_m, psi(. - k)> */
+    gram_wavelet       /* <psi, psi(. - k)> */
+}gram_kind_t;
+
+const char* gram_kind_name(gram_kind_t kind);
+
+/*
+ * Inner products G(k) = int f^(r)(x) g^(r)(x - k) dx of two splines of the
+ * same order, multiplied piece by piece: the product of two polynomial
+ * pieces is integrated over the unit interval in closed form, no sampling
+ * is involved. f and g need the same integer scale and shifts differing by
+ * an integer, so that the knots of g(. - k) are knots of f.
+ * @param f, g splines, e.g. WaveletEvaluator(psi)
+ * @param r derivative order, 0..m-1 for splines of order m
+ * @param band G(k) for all k with overlapping supports
+ * @return false if the splines do not fit or r is out of range
+ */
+bool spline_gram(const WaveletEvaluator& f, const WaveletEvaluator& g, int r, band_t& band);
+
+/*
+ * spline_gram() of the pair kind of N_m and the spline wavelet psi of
+ * order m, computed once and kept in a cache keyed by order, vanishing
+ * moments, r and kind. Entries are never removed, so the pointer stays
+ * valid. Safe to call from several threads.
+ * @return band or NULL if r is out of range
+ */
+const band_t* select_spline_gram(const psi_t& psi, gram_kind_t kind, int r);
+
+/*
+ * Compare the inner products of every spline wavelet and its B-spline with
+ * the two-scale sums sum_{i,j} c[i] d[j] 4^r / 2 G(2k + j - i) over the
+ * closed form G of the B-spline inner products, for all derivatives.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_spline_gram(std::ostream* log);
+
+#endif /* SPLINE_SPLINE_GRAM_H */
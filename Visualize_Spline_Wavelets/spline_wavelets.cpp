@@ -0,0 +1,360 @@
+/*
+ * spline_wavelets.cpp
+ * Masks of the implemented spline wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <math.h>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include "spline_wavelets.h"
+
+using namespace std;
+
+
+// <editor-fold defaultstate="collapsed" desc="data of implemented spline wavelets">
+static const double psi22mask[] = {1./4., 1./2., -3./2., 1./2., 1./4.};
+
+static const double psi23mask[] = {5./32., 5./16., -45./32., 7./8., 11./32., -3./16., -3./32.};
+
+static const double psi24mask[] = {-3./64., -3./32., 1./4., 19./32., -45./32., 19./32., 1./4., -3./32., -3./64.};
+
+static const double psi32mask[] = {5./16., 15./16., -15./16., -1./8., 9./8., 3./16.};
+
+static const double psi33mask[] = {-3./32., -9./32., 7./32., 45./32., -45./32., -7./32., 9./32., 3./32.};
+
+static const double psi34mask[] = {-7./128., -21./128., 7./32., 35./32., -105./64., 1./64., 19./32., 3./32., -15./128., -5./128.};
+
+static const double psi42mask[] = {3./16., 3./4., 5./16., -5./2., 5./16., 3./4., 3./16.};
+
+static const double psi43mask[] = {7./64., 7./16., 0., -35./16., 35./32., 17./16., -1./8., -5./16., -5./64.};
+
+static const double psi44mask[] = {-5./128., -5./32., -1./128., 3./4., 35./64., -35./16., 35./64., 3./4., -1./128., -5./32., -5./128.};
+
+static const double psi52mask[] = {7./32., 35./32., 32./32., -105./32., -35./32., 33./32., 25./32., 5./32.};
+
+static const double psi53mask[] = {-5./64., -25./64., -13./32., 35./32., 35./16., -35./16., -35./32., 13./32., 25./64., 5./64.};
+
+static const double psi54mask[] = {-45./1024., -225./1024., -171./1024., 945./1024., 735./512., -1365./512., -315./512., 593./512., 575./1024., -165./1024., -175./1024., -35./1024};
+
+static const double psi62mask[] = {5./32., 15./16., 7./4., -7./16., -77./16., -7./16., 7./4., 15./16., 5./32.};
+
+static const double psi63mask[] = {45./512., 135./256., 441./512., -63./64., -987./256., 189./128., 693./256., 25./64., -375./512., -105./256., -35./512.};
+
+static const double psi64mask[] = {-35./1024., -105./512., -165./512., 235./512., 1827./1024., 63./256., -987./256., 63./256., 1827./1024., 235./512., -165./512., -105./512, -35./1024.};
+
+// </editor-fold>
+
+/*
+ * {spline_order, vanishing_moments, mask, mask_start, mask_end, output_start, output_end}
+ */
+const psi_t builtin_psi[] = {
+    {2, 2, psi22mask, -1, 3, -2, 2},
+    {2, 3, psi23mask, -1, 5, -2, 4},
+    {2, 4, psi24mask, -1, 7, -2, 5},
+    {3, 2, psi32mask, -1, 4, -2, 4},
+    {3, 3, psi33mask, -1, 6, -2, 5},
+    {3, 4, psi34mask, -1, 8, -2, 6},
+    {4, 2, psi42mask, -2, 4, -3, 4},
+    {4, 3, psi43mask, -2, 6, -3, 5},
+    {4, 4, psi44mask, -2, 8, -3, 6},
+    {5, 2, psi52mask, -2, 5, -3, 4},
+    {5, 3, psi53mask, -2, 7, -3, 6},
+    {5, 4, psi54mask, -2, 9, -3, 6},
+    {6, 2, psi62mask, -3, 5, -4, 4},
+    {6, 3, psi63mask, -3, 7, -4, 6},
+    {6, 4, psi64mask, -3, 9, -4, 7}
+};
+
+const int builtin_psi_count = sizeof(builtin_psi) / sizeof(builtin_psi[0]);
+
+
+/*
+ * product of Laurent polynomials given by their coefficients
+ */
+static vector<int64_t> multiply(const vector<int64_t>& a, const vector<int64_t>& b)
+{
+    vector<int64_t> product(a.size() + b.size() - 1, 0);
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        for (size_t j = 0; j < b.size(); j++)
+        {
+            product[i + j] += a[i] * b[j];
+        }
+    }
+
+    return product;
+}
+
+
+bool construct_psi(int spline_order, int vanishing_moments, vector<double>& mask, psi_t& psi)
+{
+    const int m = spline_order, mt = vanishing_moments;
+    if (m < 1 || m > max_spline_order || mt < 1 || mt > max_vanishing_moments || (m + mt) % 2 != 0)
+    {
+        return false;
+    }
+    const int l = (m + mt) / 2;
+
+    /* 4^(l-1) sum_{n<l} binom(l-1+n, n) sin^2n, sin^2 = (2 - z - 1/z) / 4 */
+    vector<int64_t> P(2*l - 1, 0), power(1, 1);
+    const vector<int64_t> sin2 = {-1, 2, -1};
+    int64_t binomial = 1; /* binom(l-1+n, n) */
+    for (int n = 0; n < l; n++)
+    {
+        const int64_t scale = binomial << (2 * (l - 1 - n));
+        for (size_t i = 0; i < power.size(); i++)
+        {
+            P[(l - 1 - n) + i] += scale * power[i];
+        }
+        power = multiply(power, sin2);
+        binomial = binomial * (l + n) / (n + 1);
+    }
+
+    /* 2^mt cos^mt = (1 + z)^mt up to a shift */
+    vector<int64_t> cosine(1, 1);
+    for (int i = 0; i < mt; i++)
+    {
+        cosine = multiply(cosine, vector<int64_t>{1, 1});
+    }
+
+    /* dual mask = 2 (1 + z)^mt P / (2^mt 4^(l-1)), exact in double */
+    const vector<int64_t> dual = multiply(cosine, P);
+    const double denominator = ldexp(1.0, mt + 2*(l - 1) - 1);
+    const int length = (int) dual.size();
+    const int start = -(m / 2);
+
+    mask.resize(length);
+    for (int i = 0; i < length; i++)
+    {
+        const double value = (double) dual[length - 1 - i] / denominator;
+        mask[i] = ((start + i) % 2 == 0) ? value : -value;
+    }
+
+    /* psi(x) = sum_k mask[k] N_m(2x + 2 - k) vanishes outside [(start-2)/2, (end-2+m)/2] */
+    psi.spline_order = m;
+    psi.vanishing_moments = mt;
+    psi.mask = mask.data();
+    psi.mask_start = start;
+    psi.mask_end = start + length - 1;
+    psi.output_start = start - 1;
+    psi.output_end = (psi.mask_end - 2 + m + 1) / 2;
+
+    return true;
+}
+
+
+/*
+ * constructed spline wavelet, psi.mask points into mask
+ */
+typedef struct {
+    vector<double> mask;
+    psi_t psi;
+}cached_psi_t;
+
+static unordered_map<uint32_t, unique_ptr<cached_psi_t> > psi_cache;
+static mutex psi_cache_lock;
+
+static uint32_t psi_key(int spline_order, int vanishing_moments)
+{
+    return ((uint32_t) spline_order << 16) | (uint32_t) vanishing_moments;
+}
+
+
+const psi_t* select_psi(int16_t spline_order, int16_t vanishing_moments)
+{
+    for (int i = 0; i < builtin_psi_count; i++)
+    {
+        if (builtin_psi[i].spline_order == spline_order && builtin_psi[i].vanishing_moments == vanishing_moments)
+        {
+            return &builtin_psi[i];
+        }
+    }
+
+    lock_guard<mutex> guard(psi_cache_lock);
+
+    unique_ptr<cached_psi_t>& entry = psi_cache[psi_key(spline_order, vanishing_moments)];
+    if (entry == NULL)
+    {
+        unique_ptr<cached_psi_t> constructed(new cached_psi_t);
+        if (!construct_psi(spline_order, vanishing_moments, constructed->mask, constructed->psi))
+        {
+            psi_cache.erase(psi_key(spline_order, vanishing_moments));
+            return NULL;
+        }
+        entry = move(constructed);
+    }
+
+    return &entry->psi;
+}
+
+
+/*
+ * structural checks of a loaded spline wavelet, without the polynomial
+ * products of construct_psi: the length 2 mt + m - 1 and the bounds of
+ * construct_psi, and the vanishing sum of the coefficients, psi has at
+ * least one vanishing moment
+ */
+static bool plausible_psi(const psi_t& psi, int length)
+{
+    const int m = psi.spline_order, mt = psi.vanishing_moments;
+    if (m < 1 || m > max_spline_order || mt < 1 || mt > max_vanishing_moments || (m + mt) % 2 != 0
+        || length != 2*mt + m - 1 || psi.mask_start != -(m / 2) || psi.output_start != psi.mask_start - 1
+        || psi.output_end != (psi.mask_end - 2 + m + 1) / 2)
+    {
+        return false;
+    }
+
+    double sum = 0.0, norm = 0.0;
+    for (int i = 0; i < length; i++)
+    {
+        if (!isfinite(psi.mask[i])) { return false; }
+        sum += psi.mask[i];
+        norm += fabs(psi.mask[i]);
+    }
+
+    return norm > 0.0 && fabs(sum) <= 1e-12 * norm;
+}
+
+
+bool load_psi_cache(const char* filename)
+{
+    ifstream file(filename);
+    if (!file) { return false; }
+
+    lock_guard<mutex> guard(psi_cache_lock);
+
+    string line;
+    while (getline(file, line))
+    {
+        if (line.empty() || line[0] == '#') { continue; }
+
+        istringstream fields(line);
+        unique_ptr<cached_psi_t> loaded(new cached_psi_t);
+        psi_t& psi = loaded->psi;
+        int order, moments, length;
+        if (!(fields >> order >> moments >> psi.mask_start >> psi.output_start >> psi.output_end >> length)
+            || order < 1 || order > max_spline_order || moments < 1 || length < 1)
+        {
+            return false;
+        }
+
+        loaded->mask.resize(length);
+        for (int i = 0; i < length; i++)
+        {
+            if (!(fields >> loaded->mask[i])) { return false; }
+        }
+        psi.spline_order = order;
+        psi.vanishing_moments = moments;
+        psi.mask = loaded->mask.data();
+        psi.mask_end = psi.mask_start + length - 1;
+
+        /* a stale or edited entry is discarded and constructed again on demand */
+        if (!plausible_psi(psi, length)) { continue; }
+
+        /* entries in use keep their address */
+        unique_ptr<cached_psi_t>& entry = psi_cache[psi_key(order, moments)];
+        if (entry == NULL) { entry = move(loaded); }
+    }
+
+    return true;
+}
+
+
+bool save_psi_cache(const char* filename)
+{
+    ofstream file(filename);
+    if (!file) { return false; }
+
+    lock_guard<mutex> guard(psi_cache_lock);
+
+    /* sorted by key, so equal caches give equal files */
+    vector<uint32_t> keys;
+    for (const auto& entry : psi_cache) { keys.push_back(entry.first); }
+    sort(keys.begin(), keys.end());
+
+    file << "# order moments mask_start output_start output_end length entries\n" << setprecision(17);
+    for (size_t k = 0; k < keys.size(); k++)
+    {
+        const cached_psi_t& entry = *psi_cache[keys[k]];
+        const psi_t& psi = entry.psi;
+        file << psi.spline_order << " " << psi.vanishing_moments << " " << psi.mask_start << " "
+             << psi.output_start << " " << psi.output_end << " " << entry.mask.size();
+        for (size_t i = 0; i < entry.mask.size(); i++)
+        {
+            file << " " << entry.mask[i];
+        }
+        file << "\n";
+    }
+
+    return file.good();
+}
+
+
+int psi_cache_size()
+{
+    lock_guard<mutex> guard(psi_cache_lock);
+
+    return (int) psi_cache.size();
+}
+
+
+bool verify_construction(ostream* log)
+{
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nWavelet | Constructed mask\n"
+             << "--------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& table = builtin_psi[p];
+        vector<double> mask;
+        psi_t psi;
+        if (!construct_psi(table.spline_order, table.vanishing_moments, mask, psi)) { continue; }
+
+        const bool equal = psi.mask_start == table.mask_start && psi.mask_end == table.mask_end
+                           && memcmp(psi.mask, table.mask, mask.size() * sizeof(double)) == 0;
+        if (log != NULL) { *log << "    " << table.spline_order << "," << table.vanishing_moments << " | " << (equal ? "equal" : "differs") << "\n"; }
+        all_equal = all_equal && equal;
+    }
+
+    /* entries loaded by load_psi_cache are only checked structurally there */
+    lock_guard<mutex> guard(psi_cache_lock);
+    vector<uint32_t> keys;
+    for (const auto& entry : psi_cache) { keys.push_back(entry.first); }
+    sort(keys.begin(), keys.end());
+    for (size_t k = 0; k < keys.size(); k++)
+    {
+        const cached_psi_t& entry = *psi_cache[keys[k]];
+        const psi_t& cached = entry.psi;
+        vector<double> mask;
+        psi_t psi;
+        const bool equal = construct_psi(cached.spline_order, cached.vanishing_moments, mask, psi)
+                           && mask == entry.mask && psi.mask_start == cached.mask_start
+                           && psi.output_start == cached.output_start && psi.output_end == cached.output_end;
+        if (log != NULL)
+        {
+            *log << "    " << cached.spline_order << "," << cached.vanishing_moments << " | "
+                 << (equal ? "cached, equal" : "cached, differs") << "\n";
+        }
+        all_equal = all_equal && equal;
+    }
+
+    return all_equal;
+}
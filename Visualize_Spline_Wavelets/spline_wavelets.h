@@ -0,0 +1,97 @@
+/*
+ * spline_wavelets.h
+ * Masks of the implemented spline wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_SPLINE_WAVELETS_H
+#define SPLINE_SPLINE_WAVELETS_H
+
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+
+
+/*
+ * data structure for spline wavelets
+ */
+typedef struct {
+    int16_t spline_order;      /* B spline order */
+    int16_t vanishing_moments; /* vanishing moments */
+    const double* mask;
+    int mask_start;
+    int mask_end;
+    int output_start;      /* lower bound of the support */
+    int output_end;        /* upper bound of the support */
+}psi_t;
+
+
+/* largest spline order of the evaluation kernels and of constructed wavelets */
+const int max_spline_order = 8;
+
+/* largest number of vanishing moments of constructed wavelets */
+const int max_vanishing_moments = 12;
+
+/*
+ * implemented spline wavelets, spline orders 2..6 and vanishing moments 2..4
+ */
+extern const psi_t builtin_psi[];
+extern const int builtin_psi_count;
+
+/*
+ * Mask of the spline wavelet of the biorthogonal CDF pair (N_m, dual of
+ * order mt) with m + mt = 2l even. The dual mask has the symbol
+ * 2 cos^mt(xi/2) sum_{n<l} binom(l-1+n, n) sin^2n(xi/2), its coefficients are
+ * dyadic rationals computed in integer arithmetic. The wavelet mask is the
+ * reversed dual mask with alternating signs,
+ * mask[i] = (-1)^(mask_start+i) dual[length-1-i], mask_start = -floor(m/2),
+ * which reproduces the table entries with m + mt even.
+ * @param spline_order m, 1..max_spline_order
+ * @param vanishing_moments mt, 1..max_vanishing_moments
+ * @param mask 2 mt + m - 1 coefficients
+ * @param psi fields of the spline wavelet, psi.mask is set to mask.data()
+ * @return false if m + mt is odd or out of range
+ */
+bool construct_psi(int spline_order, int vanishing_moments, std::vector<double>& mask, psi_t& psi);
+
+/*
+ * The table entries first, otherwise the constructed spline wavelet, which
+ * is computed once and kept in a cache keyed by (order << 16) | moments.
+ * Entries of the cache are never removed, so the pointer stays valid.
+ * Safe to call from several threads.
+ * @param spline_order B spline order
+ * @param vanishing_moments vanishing moments
+ * @return spline wavelet or NULL if the combination is not implemented
+ */
+const psi_t* select_psi(int16_t spline_order, int16_t vanishing_moments);
+
+/*
+ * Text file of the constructed masks, one line
+ * "order moments mask_start output_start output_end length entries..."
+ * per spline wavelet, entries with 17 significant digits. Loaded lines
+ * are checked structurally, without construct_psi: lines whose length,
+ * bounds or coefficient sum do not fit a spline wavelet are discarded.
+ * verify_construction() compares the loaded entries with construct_psi.
+ * @return false if the file cannot be read or written, or is malformed
+ */
+bool load_psi_cache(const char* filename);
+bool save_psi_cache(const char* filename);
+
+/* number of constructed spline wavelets in the cache */
+int psi_cache_size();
+
+/*
+ * Compare the constructed masks with the table entries whose spline order
+ * and vanishing moments have an even sum, and the entries of the cache,
+ * e.g. loaded by load_psi_cache, with construct_psi.
+ * @param log receives a table, may be NULL
+ * @return true if all masks agree exactly
+ */
+bool verify_construction(std::ostream* log);
+
+#endif /* SPLINE_SPLINE_WAVELETS_H */
@@ -0,0 +1,203 @@
+/*
+ * tensor_sampler.cpp
+ * Sampling of tensor product spline wavelets on large 2D grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <ostream>
+#include "bspline.h"
+#include "tensor_sampler.h"
+#include "wavelet_sampler.h"
+
+using namespace std;
+
+static const char* const kind_names[] = {"phi_phi", "psi_phi", "phi_psi", "psi_psi"};
+
+/* B-spline coefficient of phi = N_m as series of one term */
+static const double unit_coefficient = 1.0;
+
+
+const char* tensor_kind_name(tensor_kind_t kind)
+{
+    return kind_names[kind];
+}
+
+
+bool parse_tensor_kind(const string& name, tensor_kind_t& kind)
+{
+    for (int k = tensor_phi_phi; k <= tensor_psi_psi; k++)
+    {
+        if (name == kind_names[k])
+        {
+            kind = (tensor_kind_t) k;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+
+TensorSampler::TensorSampler(const psi_t& psi, tensor_kind_t kind)
+    : psi(psi), tensor_kind(kind), wavelet(psi), bspline(psi.spline_order, &unit_coefficient, 0, 1, 1.0), threads(NULL)
+{
+}
+
+
+void TensorSampler::set_thread_pool(ThreadPool* pool)
+{
+    threads = pool;
+    wavelet.set_thread_pool(pool);
+    bspline.set_thread_pool(pool);
+}
+
+
+void TensorSampler::axis(bool wavelet_factor, size_t R, vector<double>& points, vector<double>& values) const
+{
+    /* psi on [output_start, output_end], N_m on [0, m] */
+    const double start = wavelet_factor ? psi.output_start : 0.0;
+    const double end = wavelet_factor ? psi.output_end : psi.spline_order;
+    const double step = (end - start) / R;
+
+    points.resize(R + 1);
+    values.resize(R + 1);
+    for (size_t i = 0; i <= R; i++) { points[i] = start + i * step; }
+
+    (wavelet_factor ? wavelet : bspline).evaluate(points.data(), values.data(), points.size());
+}
+
+
+void TensorSampler::axis_x(size_t R, vector<double>& x, vector<double>& f) const
+{
+    axis(tensor_kind == tensor_psi_phi || tensor_kind == tensor_psi_psi, R, x, f);
+}
+
+
+void TensorSampler::axis_y(size_t R, vector<double>& y, vector<double>& g) const
+{
+    axis(tensor_kind == tensor_phi_psi || tensor_kind == tensor_psi_psi, R, y, g);
+}
+
+
+bool TensorSampler::stream(size_t R, const strip_consumer_t& consumer) const
+{
+    if (!valid()) { return false; }
+
+    vector<double> x, f, y, g;
+    axis_x(R, x, f);
+    axis_y(R, y, g);
+
+    return stream_tensor_product(f.data(), f.size(), g.data(), g.size(), threads, consumer);
+}
+
+
+bool TensorSampler::write(size_t R, const char* filename, output_format_t format, double& min_value, double& max_value) const
+{
+    if (!valid()) { return false; }
+
+    vector<double> x, f, y, g;
+    axis_x(R, x, f);
+    axis_y(R, y, g);
+
+    const string factor[] = {"N_" + to_string(psi.spline_order),
+                             "\\psi_" + to_string(psi.spline_order) + "^" + to_string(psi.vanishing_moments)};
+    const bool wavelet_x = tensor_kind == tensor_psi_phi || tensor_kind == tensor_psi_psi;
+    const bool wavelet_y = tensor_kind == tensor_phi_psi || tensor_kind == tensor_psi_psi;
+    const string title = factor[wavelet_x] + "(x) " + factor[wavelet_y] + "(y)";
+
+    return write_tensor_product(filename, format, title, x.data(), f.data(), x.size(),
+                                y.data(), g.data(), y.size(), threads, min_value, max_value);
+}
+
+
+/*
+ * reference N_m(x) by the recursion of Bspline<m>
+ */
+static double bspline_reference(int m, double x)
+{
+    switch (m)
+    {
+        case 1: return Bspline<1>(x, 0.0);
+        case 2: return Bspline<2>(x, 0.0);
+        case 3: return Bspline<3>(x, 0.0);
+        case 4: return Bspline<4>(x, 0.0);
+        case 5: return Bspline<5>(x, 0.0);
+        case 6: return Bspline<6>(x, 0.0);
+        case 7: return Bspline<7>(x, 0.0);
+        case 8: return Bspline<8>(x, 0.0);
+        default: return NAN;
+    }
+}
+
+
+bool verify_tensor_sampler(ostream* log)
+{
+    bool all_equal = true;
+    ThreadPool pool(2);
+    if (log != NULL)
+    {
+        *log << "\nWavelet | Max. difference of the tensor products phi_phi, psi_phi, phi_psi, psi_psi\n"
+             << "------------------------------------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const WaveletSampler reference(psi);
+        const size_t R = 600; /* two strips, so the threads take part */
+
+        if (log != NULL) { *log << "    " << psi.spline_order << "," << psi.vanishing_moments << " |"; }
+        for (int kind = tensor_phi_phi; kind <= tensor_psi_psi; kind++)
+        {
+            TensorSampler sampler(psi, (tensor_kind_t) kind);
+            vector<double> x, f, y, g;
+            sampler.axis_x(R, x, f);
+            sampler.axis_y(R, y, g);
+
+            /* reference factors, psi by the recursive synthesis, N_m by the recursion */
+            vector<double> fx(x.size()), gy(y.size());
+            const bool wavelet_x = (kind == tensor_psi_phi || kind == tensor_psi_psi);
+            const bool wavelet_y = (kind == tensor_phi_psi || kind == tensor_psi_psi);
+            if (wavelet_x) { reference.evaluate_reference(x.data(), fx.data(), x.size()); }
+            else { for (size_t j = 0; j < x.size(); j++) { fx[j] = bspline_reference(psi.spline_order, x[j]); } }
+            if (wavelet_y) { reference.evaluate_reference(y.data(), gy.data(), y.size()); }
+            else { for (size_t i = 0; i < y.size(); i++) { gy[i] = bspline_reference(psi.spline_order, y[i]); } }
+
+            vector<double> serial;
+            double difference = 0.0, scale = 0.0;
+            all_equal = all_equal && sampler.stream(R, [&] (size_t first, const double* values, size_t count) {
+                for (size_t i = 0; i < count; i++)
+                {
+                    for (size_t j = 0; j < x.size(); j++)
+                    {
+                        const double expected = gy[first + i] * fx[j];
+                        difference = max(difference, fabs(values[i * x.size() + j] - expected));
+                        scale = max(scale, fabs(expected));
+                    }
+                }
+                serial.insert(serial.end(), values, values + count * x.size());
+                return true;
+            });
+
+            vector<double> threaded;
+            sampler.set_thread_pool(&pool);
+            all_equal = all_equal && sampler.stream(R, [&] (size_t, const double* values, size_t count) {
+                threaded.insert(threaded.end(), values, values + count * x.size());
+                return true;
+            });
+
+            const bool threads_equal = (serial == threaded) && serial.size() == x.size() * y.size();
+            if (log != NULL) { *log << " " << difference << (threads_equal ? "" : " (threads differ)"); }
+            all_equal = all_equal && difference <= 1e-12 * max(1.0, scale) && threads_equal;
+        }
+        if (log != NULL) { *log << "\n"; }
+    }
+
+    return all_equal;
+}
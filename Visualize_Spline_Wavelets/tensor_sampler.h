@@ -0,0 +1,114 @@
+/*
+ * tensor_sampler.h
+ * Sampling of tensor product spline wavelets on large 2D grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_TENSOR_SAMPLER_H
+#define SPLINE_TENSOR_SAMPLER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "spline_wavelets.h"
+#include "wavelet_evaluator.h"
+#include "../common/thread_pool.h"
+#include "../common/tensor_grid.h"
+
+
+/*
+ * bivariate functions of the tensor product wavelet basis, phi = N_m with
+ * support [0, m], the first factor depends on x, the second on y
+ */
+typedef enum {
+    tensor_phi_phi = 0, /* phi(x) phi(y) */
+    tensor_psi_phi,     /* psi(x) phi(y) */
+    tensor_phi_psi,     /* phi(x) psi(y) */
+    tensor_psi_psi      /* psi(x) psi(y) */
+}tensor_kind_t;
+
+/* "phi_phi", "psi_phi", "phi_psi" or "psi_psi" */
+const char* tensor_kind_name(tensor_kind_t kind);
+
+/*
+ * @param name one of the names of tensor_kind_name()
+ * @return false if name is no tensor kind
+ */
+bool parse_tensor_kind(const std::string& name, tensor_kind_t& kind);
+
+
+/*
+ * Samples f(x) g(y) on the grid x_j = a + j (b - a) / R, y_i = c + i (d - c) / R,
+ * i, j = 0, ..., R, of the supports [a, b] of f and [c, d] of g. The
+ * univariate factors are evaluated once per axis by WaveletEvaluator,
+ * 2 (R + 1) evaluations instead of (R + 1)^2, and the grid is streamed
+ * in strips by stream_tensor_product().
+ */
+class TensorSampler
+{
+public:
+    /*
+     * @param psi spline wavelet, the mask is copied into the pieces
+     * @param kind factors along x and y
+     */
+    TensorSampler(const psi_t& psi, tensor_kind_t kind);
+
+    /* false if the spline order of psi is not implemented */
+    bool valid() const { return wavelet.valid() && bspline.valid(); }
+
+    /*
+     * @param pool threads of the univariate evaluations and the strips,
+     *        NULL (default) computes serially
+     */
+    void set_thread_pool(ThreadPool* pool);
+
+    /*
+     * grid points and factor values along x (columns) and y (rows)
+     * @param R resolution, R + 1 points per axis
+     */
+    void axis_x(size_t R, std::vector<double>& x, std::vector<double>& f) const;
+    void axis_y(size_t R, std::vector<double>& y, std::vector<double>& g) const;
+
+    /*
+     * @param R resolution
+     * @param consumer receives the rows of the grid strip by strip
+     * @return false if memory is exhausted or the consumer stopped
+     */
+    bool stream(size_t R, const strip_consumer_t& consumer) const;
+
+    /*
+     * the grid as file, see write_tensor_product()
+     * @param filename output file, NULL only computes the range
+     * @return false if the file cannot be written or memory is exhausted
+     */
+    bool write(size_t R, const char* filename, output_format_t format, double& min_value, double& max_value) const;
+
+    const psi_t& wavelet_of() const { return psi; }
+    tensor_kind_t kind() const { return tensor_kind; }
+
+private:
+    void axis(bool wavelet_factor, size_t R, std::vector<double>& points, std::vector<double>& values) const;
+
+    psi_t psi;
+    tensor_kind_t tensor_kind;
+    WaveletEvaluator wavelet;
+    WaveletEvaluator bspline;
+    ThreadPool* threads;
+};
+
+
+/*
+ * Compare the tensor product grids of all kinds with the products of the
+ * reference evaluations of both factors at every grid point, and the
+ * threaded strips with the serial ones bit for bit.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_tensor_sampler(std::ostream* log);
+
+#endif /* SPLINE_TENSOR_SAMPLER_H */
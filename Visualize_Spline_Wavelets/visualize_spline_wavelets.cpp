@@ -10,212 +10,574 @@
  */
 
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <math.h>
 #include <stdint.h>
+#include <string>
+#include <vector>
+#include "bspline.h"
+#include "spline_wavelets.h"
+#include "wavelet_sampler.h"
+#include "multilevel_synthesis.h"
+#include "spline_gram.h"
+#include "tensor_sampler.h"
+#include "../common/batch.h"
+#include "../common/thread_pool.h"
+#include "../common/timer.h"
+#include "../common/output_writer.h"
+#include "../common/precision.h"
+#include "../common/table_cache.h"
+#include "../libmiscwavelets/verify_interface.h"
 
 using namespace std;
 
 
+
+/*
+ * @return "_d<r>" for derivatives, empty for r = 0
+ */
+static string derivative_suffix(int derivative)
+{
+    return (derivative > 0) ? "_d" + to_string(derivative) : string();
+}
+
+
+/*
+ * Sample psi on the grid of resolution R and stream the samples into an
+ * output file, nothing but one chunk per thread is held in memory.
+ * @param table samples from the table cache, NULL samples psi
+ * @param filename output file, NULL if nothing should be written
+ * @param format format_matlab writes a plot script, the binary formats
+ *        write the pairs (x, psi(x)) as rows of an array with two columns
+ * @param trace print every sample
+ * @param min_value smallest sample
+ * @param max_value largest sample
+ * @return false if the file cannot be written or the sampling failed
+ */
+static bool sample_spline_wavelet(const WaveletSampler& sampler, size_t R, const double* table, const char* filename,
+                                  output_format_t format, bool trace, double& min_value, double& max_value)
+{
+    const psi_t& psi = sampler.wavelet();
+    const size_t samples = sampler.samples(R);
+
+    BufferedWriter ofs;
+    if (filename != NULL)
+    {
+        if (!ofs.open(filename)) { return false; }
+
+        if (format == format_npy) { write_npy_header(ofs, vector<size_t>{samples, 2}); }
+        if (format == format_matlab)
+        {
+            /* the grid is known in advance, so X is written before the samples */
+            ofs << "X = [";
+            for (size_t i = 0; i < samples; i++)
+            {
+                ofs << sampler.grid_point(R, i) << " ";
+            }
+            ofs << "];\n\nY = [";
+        }
+    }
+
+    min_value = HUGE_VAL;
+    max_value = -HUGE_VAL;
+    vector<double> rows;
+
+    const sample_consumer_t consumer = [&] (size_t, const double* x, const double* y, size_t count) {
+        for (size_t i = 0; i < count; i++)
+        {
+            min_value = min(min_value, y[i]);
+            max_value = max(max_value, y[i]);
+        }
+
+        if (trace)
+        {
+            ostringstream lines;
+            for (size_t i = 0; i < count; i++)
+            {
+                lines << "(" << x[i] << ", " << y[i] << ")" << '\n';
+            }
+            cout << lines.str();
+        }
+
+        if (filename == NULL) { return true; }
+        if (format == format_matlab)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                ofs << y[i] << " ";
+            }
+        }
+        else
+        {
+            rows.resize(2 * count);
+            for (size_t i = 0; i < count; i++)
+            {
+                rows[2*i] = x[i];
+                rows[2*i+1] = y[i];
+            }
+            ofs.write_values(rows.data(), rows.size(), format);
+        }
+
+        return !ofs.failed();
+    };
+    const bool sampled = (table != NULL) ? sampler.stream(R, table, consumer) : sampler.stream(R, consumer);
+
+    if (filename == NULL) { return sampled; }
+
+    if (format == format_matlab)
+    {
+        ofs << "];\n\nfigure;\nplot(X,Y, 'b', 'LineWidth', 2);\n"
+            << "axis tight;\nset(gca, 'FontSize', 20);\n"
+            << "title('N_" << psi.spline_order << ": spline wavelet \\psi_" << psi.spline_order << "^" << psi.vanishing_moments;
+        if (sampler.derivative() > 0) { ofs << ", derivative " << sampler.derivative(); }
+        ofs << "');\n";
+    }
+
+    return ofs.close() && sampled;
+}
+
+
+
+/*
+ * Batch mode: compute a list of (spline order, vanishing moments,
+ * resolution) jobs without user input, the jobs are distributed over the
+ * threads of a pool.
+ *
+ * Usage: visualize_spline_wavelets --batch [--orders 2,3,...] [--moments 2,3,...]
+ *            [--resolutions 200,...] [--jobs file] [--threads n] [--dir directory]
+ *
+ * --orders, --moments and --resolutions form all implemented combinations,
+ * tabulated or constructed (default: the table, R = 200), each line
+ * "order moments [resolution]" of a job file adds one job. The output of
+ * each job is written to spline_wavelet_<order>_<moments>_<resolution>.m
+ * (or the extension of the selected output format).
+ */
+static int batch(int argc, char** argv, verbosity_t verbosity, output_format_t format, int derivative)
+{
+    vector<int> orders, moments, resolutions;
+    vector<job_t> jobs;
+    string dir, error;
+    int threads = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const string option = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool valid = (value != NULL);
+
+        if (option == "--orders")           { valid = valid && parse_int_list(value, orders); }
+        else if (option == "--moments")     { valid = valid && parse_int_list(value, moments); }
+        else if (option == "--resolutions") { valid = valid && parse_int_list(value, resolutions); }
+        else if (option == "--threads")     { valid = valid && (threads = atoi(value)) >= 0; }
+        else if (option == "--dir")         { if (valid) { dir = value; } }
+        else if (option == "--jobs")
+        {
+            if (valid && !read_job_file(value, 2, 3, jobs, error))
+            {
+                cout << "\n" << error << ".\nProgram end." << endl;
+                return 1;
+            }
+        }
+        else { valid = false; }
+
+        if (!valid)
+        {
+            cout << "\nInvalid batch option '" << option << "'.\nProgram end." << endl;
+            return 1;
+        }
+        i++;
+    }
+
+    /* job file lines without resolution use R = 200 */
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (jobs[i].size() == 2) { jobs[i].push_back(200); }
+    }
+
+    if (jobs.empty() || !orders.empty() || !moments.empty() || !resolutions.empty())
+    {
+        if (resolutions.empty()) { resolutions.push_back(200); }
+
+        if (orders.empty())  { orders = vector<int>{2, 3, 4, 5, 6}; }
+        if (moments.empty()) { moments = vector<int>{2, 3, 4}; }
+
+        for (size_t o = 0; o < orders.size(); o++)
+        {
+            for (size_t v = 0; v < moments.size(); v++)
+            {
+                if (select_psi(orders[o], moments[v]) == NULL) { continue; }
+
+                for (size_t j = 0; j < resolutions.size(); j++)
+                {
+                    jobs.push_back(job_t{orders[o], moments[v], resolutions[j]});
+                }
+            }
+        }
+    }
+
+    /* validate all jobs before starting */
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        if (select_psi(jobs[i][0], jobs[i][1]) == NULL)
+        {
+            cout << "\nCombination of spline order " << jobs[i][0]
+                 << " and vanishing moments " << jobs[i][1]
+                 << " not implemented.\nProgram end." << endl;
+            return 1;
+        }
+        if (jobs[i][2] < 1)
+        {
+            cout << "\nResolution has to be positive.\nProgram end." << endl;
+            return 1;
+        }
+    }
+
+    ThreadPool pool(threads);
+    cout << "\nJobs: " << jobs.size() << "\nThreads: " << pool.size() << endl;
+
+    /* every job is computed serially by one thread, reports are printed in job order */
+    vector<string> report(jobs.size());
+    vector<int> failed(jobs.size(), 0);
+    pool.run(jobs.size(), [&] (size_t i) {
+        const psi_t& psi = *select_psi(jobs[i][0], jobs[i][1]);
+        const int R = jobs[i][2];
+        const WaveletSampler sampler(psi, derivative);
+        double min_value, max_value;
+        Timer timer;
+
+        char filename[250];
+        sprintf(filename, "spline_wavelet_%d_%d%s_%d%s", psi.spline_order, psi.vanishing_moments,
+                derivative_suffix(derivative).c_str(), R, format_extension(format));
+        const string path = output_path(dir, filename);
+
+        if (!sampler.valid())
+        {
+            report[i] = string(filename) + ": spline order not implemented or derivative too large";
+            failed[i] = 1;
+        }
+        else if (!sample_spline_wavelet(sampler, R, NULL, path.c_str(), format, false, min_value, max_value))
+        {
+            report[i] = string(filename) + ": cannot write " + path;
+            failed[i] = 1;
+        }
+        else
+        {
+            ostringstream line;
+            line << path;
+            if (verbosity >= verbosity_summary)
+            {
+                line << " (" << sampler.samples(R) << " samples, " << timer.seconds() << " s)";
+            }
+            report[i] = line.str();
+        }
+    });
+
+    int failures = 0;
+    cout << "\nOutput:" << endl;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        cout << report[i] << "\n";
+        failures += failed[i];
+    }
+
+    cout << "\n" << (jobs.size() - failures) << " of " << jobs.size() << " jobs done." << endl
+         << "\nProgram end." << endl;
+
+    return (failures == 0) ? 0 : 1;
+}
+
+
+
 /*
- * @param x value
- * @param s shift
+ * Usage: visualize_spline_wavelets --gram <spline order> <vanishing moments> <r>
+ * Prints the inner products of the r-th derivatives of N_m and psi with the
+ * shifts of N_m and psi: r = 0 gives the mass, r = 1 the stiffness matrices.
  */
-template <int k>
-double Bspline(double x, double s)
+static int gram_matrices(int argc, char** argv)
 {
-    if (s <= x && x < (s + k))
+    if (argc != 5)
     {
-        double a = (x - s) / ((s + k - 1) - s);
-        double b = ((s + k) - x) / ((s + k) - (s + 1));
+        cout << "\nUsage: visualize_spline_wavelets --gram <spline order> <vanishing moments> <r>.\nProgram end." << endl;
+        return 1;
+    }
+
+    const psi_t* psi = select_psi(atoi(argv[2]), atoi(argv[3]));
+    const int r = atoi(argv[4]);
+    if (psi == NULL || r < 0 || r >= psi->spline_order)
+    {
+        cout << "\nCombination of spline order " << argv[2] << " and vanishing moments " << argv[3]
+             << " not implemented or r not below the spline order.\nProgram end." << endl;
+        return 1;
+    }
+
+    cout << "\nSpline order: " << psi->spline_order << "\nVanishing moments: " << psi->vanishing_moments
+         << "\nDerivative: " << r << endl;
+    Timer timer;
+    const band_t* bands[gram_wavelet + 1];
+    for (int kind = gram_bspline; kind <= gram_wavelet; kind++)
+    {
+        bands[kind] = select_spline_gram(*psi, (gram_kind_t) kind, r);
+    }
+    const double elapsed = timer.seconds();
 
-        return (a * Bspline<k-1>(x, s) + b * Bspline<k-1>(x, (s + 1)));
+    for (int kind = gram_bspline; kind <= gram_wavelet; kind++)
+    {
+        cout << "\n" << gram_kind_name((gram_kind_t) kind) << ", band: " << band_lower(*bands[kind]) << " lower, "
+             << band_upper(*bands[kind]) << " upper diagonals\n" << endl;
+        print_band(*bands[kind], cout);
     }
-    else { return 0.0; }
-};
+    cout << "\nComputed in " << setprecision(3) << elapsed * 1e6 << " us.\n"
+         << "\nProgram end." << endl;
+
+    return 0;
+}
+
+
 
 /*
- * @param x value
- * @param s shift
+ * Usage: visualize_spline_wavelets --tensor <spline order> <vanishing moments> <kind>
+ * Samples phi(x) phi(y), psi(x) phi(y), phi(x) psi(y) or psi(x) psi(y),
+ * kind phi_phi, psi_phi, phi_psi or psi_psi, with phi = N_m on the
+ * (R+1) x (R+1) grid of the supports of the factors.
  */
-template <>
-double Bspline<1>(double x, double s)
+static int tensor_grid(int argc, char** argv, verbosity_t verbosity, output_format_t format, size_t R, int threads)
 {
-    if (s <= x && x < (s + 1)) { return 1.0; } else { return 0.0; }
-};
+    tensor_kind_t kind;
+    if (argc != 5 || !parse_tensor_kind(argv[4], kind))
+    {
+        cout << "\nUsage: visualize_spline_wavelets --tensor <spline order> <vanishing moments> "
+             << "{phi_phi, psi_phi, phi_psi, psi_psi}.\nProgram end." << endl;
+        return 1;
+    }
+
+    const psi_t* psi = select_psi(atoi(argv[2]), atoi(argv[3]));
+    if (psi == NULL)
+    {
+        cout << "\nCombination of spline order " << argv[2] << " and vanishing moments " << argv[3]
+             << " not implemented.\nProgram end." << endl;
+        return 1;
+    }
+
+    TensorSampler sampler(*psi, kind);
+    ThreadPool pool(threads);
+    if (pool.size() > 1)
+    {
+        sampler.set_thread_pool(&pool);
+    }
+    if (!sampler.valid())
+    {
+        cout << "\nSpline order " << psi->spline_order << " not implemented.\nProgram end." << endl;
+        return 2;
+    }
+
+    char filename[250];
+    sprintf(filename, "spline_wavelet_%d_%d_%s%s", psi->spline_order, psi->vanishing_moments,
+            tensor_kind_name(kind), format_extension(format));
+
+    cout << "\nSpline order: " << psi->spline_order << "\nVanishing moments: " << psi->vanishing_moments
+         << "\nTensor product: " << tensor_kind_name(kind) << "\nGrid: " << (R + 1) << " x " << (R + 1) << endl;
+
+    Timer timer;
+    double min_value, max_value;
+    if (!sampler.write(R, filename, format, min_value, max_value))
+    {
+        cout << "\nCannot write output file '" << filename << "'.\nProgram end." << endl;
+        return 1;
+    }
+    const double seconds = timer.seconds();
+
+    if (verbosity >= verbosity_summary)
+    {
+        cout << "Samples: " << (R + 1) * (R + 1) << "\n"
+             << "Min: " << min_value << "\n"
+             << "Max: " << max_value << "\n"
+             << "Threads: " << pool.size() << "\n"
+             << "Time: " << seconds << " s\n";
+    }
+    cout << "\nOutput written to: " << endl
+         << filename << endl
+         << "\nProgram end." << endl;
+
+    return 0;
+}
 
 
 
 /*
- * data structure for spline wavelets
+ * Usage: visualize_spline_wavelets --precisions <spline order> <vanishing moments>
+ * Evaluates psi at the R+1 grid points in float, double, long double and
+ * double-double and reports time, throughput and the largest difference to
+ * double-double, absolute and relative to the maximum of |psi|.
  */
-typedef struct {
-    int16_t spline_order;      /* B spline order */
-    int16_t vanishing_moments; /* vanishing moments */
-    const double* mask;
-    int mask_start;
-    int mask_end;
-    int output_start;      /* lower bound of the support */
-    int output_end;        /* upper bound of the support */
-}psi_t;
+static int precision_report(int argc, char** argv, size_t R, int threads)
+{
+    const psi_t* psi = (argc == 4) ? select_psi(atoi(argv[2]), atoi(argv[3])) : NULL;
+    if (psi == NULL)
+    {
+        cout << "\nUsage: visualize_spline_wavelets --precisions <spline order> <vanishing moments>, "
+             << "the combination has to be implemented.\nProgram end." << endl;
+        return 1;
+    }
+
+    const WaveletSampler sampler(*psi);
+    if (!sampler.valid())
+    {
+        cout << "\nSpline order " << psi->spline_order << " not implemented.\nProgram end." << endl;
+        return 2;
+    }
+    ThreadPool pool(threads);
+    vector<precision_run_t> runs;
+    double scale;
+    compare_precisions(sampler, R, (pool.size() > 1) ? &pool : NULL, runs, scale);
+
+    ostringstream report;
+    report << "\nSpline order: " << psi->spline_order << "\nVanishing moments: " << psi->vanishing_moments
+           << "\nSamples: " << (R + 1) << "\nInstruction set: " << simd_name(detect_simd()) << "\nThreads: " << pool.size() << "\n"
+           << "\n    Precision |   Time (s) |    Samples/s |   Difference |     Relative\n"
+           << "---------------------------------------------------------------------------\n";
+    for (int p = precision_float; p <= precision_double_double; p++)
+    {
+        const precision_run_t& run = runs[p];
+        report << setw(13) << precision_name((precision_t) p) << " | " << setw(10) << run.seconds << " | "
+               << setw(12) << (R + 1) / max(run.seconds, 1e-9) << " | ";
+        if (p == precision_double_double)
+        {
+            report << setw(12) << "-" << " | " << setw(12) << "-" << "\n";
+        }
+        else
+        {
+            report << setw(12) << run.difference << " | " << setw(12) << run.difference / scale << "\n";
+        }
+    }
+    cout << report.str() << "\nProgram end." << endl;
+
+    return 0;
+}
 
 
 
 /*
  * Visualize spline wavelets
+ *
+ * Usage: visualize_spline_wavelets [spline order] [vanishing moments]
+ *        visualize_spline_wavelets --batch ...
+ *        visualize_spline_wavelets --gram <spline order> <vanishing moments> <r>
+ *        visualize_spline_wavelets --tensor <spline order> <vanishing moments> <kind>
+ *        visualize_spline_wavelets --precisions <spline order> <vanishing moments>
+ *        visualize_spline_wavelets --verify
+ *
+ * -q suppresses the summary, -v additionally prints every sample.
+ * --format {m, npy, f64, f32} selects the output format (default m).
+ * --resolution R samples R+1 points (default 200), --threads n splits the
+ * grid over n threads (0 uses all hardware threads).
+ * Combinations outside the table with an even sum are constructed, --cache
+ * file loads the constructed masks from file and stores new ones there.
+ * --derivative r samples psi^(r), r below the spline order.
+ * --tensor samples the (R+1) x (R+1) grid of a tensor product of N_m and psi.
+ * --precisions compares the evaluation of psi in float, double, long double
+ * and double-double at the R+1 grid points.
+ * --table-cache directory maps the samples from a cache of tables shared by
+ * processes and stores them there on a miss, --table-limit MB bounds the
+ * size of the cache (default 1024).
   */
 int main(int argc, char** argv)
 {
-    cout << "Visualize spline wavelets." << endl
-         << "Implemented pairs (spline order, vanishing moments): " << endl;
+    const verbosity_t verbosity = take_verbosity(argc, argv);
 
-    /*
-     * data of implemented spline wavelets
-     */
-    psi_t psi, psi22, psi23, psi24, psi32, psi33, psi34, psi42, psi43, psi44, psi52, psi53, psi54, psi62, psi63, psi64;
-
-    // <editor-fold defaultstate="collapsed" desc="data of implemented spline wavelets">
-    psi22.spline_order = 2;
-    psi22.vanishing_moments = 2;
-    const double psi22mask[] = {1./4., 1./2., -3./2., 1./2., 1./4.};
-    psi22.mask = psi22mask;
-    psi22.mask_start = -1;
-    psi22.mask_end = 3;
-    psi22.output_start = -2;
-    psi22.output_end = 2;
-
-    psi23.spline_order = 2;
-    psi23.vanishing_moments = 3;
-    const double psi23mask[] = {5./32., 5./16., -45./32., 7./8., 11./32., -3./16., -3./32.};
-    psi23.mask = psi23mask;
-    psi23.mask_start = -1;
-    psi23.mask_end = 5;
-    psi23.output_start = -2;
-    psi23.output_end = 4;
-
-    psi24.spline_order = 2;
-    psi24.vanishing_moments = 4;
-    const double psi24mask[] = {-3./64., -3./32., 1./4., 19./32., -45./32., 19./32., 1./4., -3./32., -3./64.};
-    psi24.mask = psi24mask;
-    psi24.mask_start = -1;
-    psi24.mask_end = 7;
-    psi24.output_start = -2;
-    psi24.output_end = 5;
-
-    psi32.spline_order = 3;
-    psi32.vanishing_moments = 2;
-    const double psi32mask[] = {5./16., 15./16., -15./16., -1./8., 9./8., 3./16.};
-    psi32.mask = psi32mask;
-    psi32.mask_start = -1;
-    psi32.mask_end = 4;
-    psi32.output_start = -2;
-    psi32.output_end = 4;
-
-    psi33.spline_order = 3;
-    psi33.vanishing_moments = 3;
-    const double psi33mask[] = {-3./32., -9./32., 7./32., 45./32., -45./32., -7./32., 9./32., 3./32.};
-    psi33.mask = psi33mask;
-    psi33.mask_start = -1;
-    psi33.mask_end = 6;
-    psi33.output_start = -2;
-    psi33.output_end = 5;
-
-    psi34.spline_order = 3;
-    psi34.vanishing_moments = 4;
-    const double psi34mask[] = {-7./128., -21./128., 7./32., 35./32., -105./64., 1./64., 19./32., 3./32., -15./128., -5./128.};
-    psi34.mask = psi34mask;
-    psi34.mask_start = -1;
-    psi34.mask_end = 8;
-    psi34.output_start = -2;
-    psi34.output_end = 6;
-
-    psi42.spline_order = 4;
-    psi42.vanishing_moments = 2;
-    const double psi42mask[] = {3./16., 3./4., 5./16., -5./2., 5./16., 3./4., 3./16.};
-    psi42.mask = psi42mask;
-    psi42.mask_start = -2;
-    psi42.mask_end = 4;
-    psi42.output_start = -3;
-    psi42.output_end = 4;
-
-    psi43.spline_order = 4;
-    psi43.vanishing_moments = 3;
-    const double psi43mask[] = {7./64., 7./16., 0., -35./16., 35./32., 17./16., -1./8., -5./16., -5./64.};
-    psi43.mask = psi43mask;
-    psi43.mask_start = -2;
-    psi43.mask_end = 6;
-    psi43.output_start = -3;
-    psi43.output_end = 5;
-
-    psi44.spline_order = 4;
-    psi44.vanishing_moments = 4;
-    const double psi44mask[] = {-5./128., -5./32., -1./128., 3./4., 35./64., -35./16., 35./64., 3./4., -1./128., -5./32., -5./128.};
-    psi44.mask = psi44mask;
-    psi44.mask_start = -2;
-    psi44.mask_end = 8;
-    psi44.output_start = -3;
-    psi44.output_end = 6;
-
-    psi52.spline_order = 5;
-    psi52.vanishing_moments = 2;
-    const double psi52mask[] = {7./32., 35./32., 32./32., -105./32., -35./32., 33./32., 25./32., 5./32.};
-    psi52.mask = psi52mask;
-    psi52.mask_start = -2;
-    psi52.mask_end = 5;
-    psi52.output_start = -3;
-    psi52.output_end = 4;
-
-
-    psi53.spline_order = 5;
-    psi53.vanishing_moments = 3;
-    const double psi53mask[] = {-5./64., -25./64., -13./32., 35./32., 35./16., -35./16., -35./32., 13./32., 25./64., 5./64.};
-    psi53.mask = psi53mask;
-    psi53.mask_start = -2;
-    psi53.mask_end = 7;
-    psi53.output_start = -3;
-    psi53.output_end = 6;
-
-
-    psi54.spline_order = 5;
-    psi54.vanishing_moments = 4;
-    const double psi54mask[] = {-45./1024., -225./1024., -171./1024., 945./1024., 735./512., -1365./512., -315./512., 593./512., 575./1024., -165./1024., -175./1024., -35./1024};
-    psi54.mask = psi54mask;
-    psi54.mask_start = -2;
-    psi54.mask_end = 9;
-    psi54.output_start = -3;
-    psi54.output_end = 6;
-
-    psi62.spline_order = 6;
-    psi62.vanishing_moments = 2;
-    const double psi62mask[] = {5./32., 15./16., 7./4., -7./16., -77./16., -7./16., 7./4., 15./16., 5./32.};
-    psi62.mask = psi62mask;
-    psi62.mask_start = -3;
-    psi62.mask_end = 5;
-    psi62.output_start = -4;
-    psi62.output_end = 4;
-
-    psi63.spline_order = 6;
-    psi63.vanishing_moments = 3;
-    const double psi63mask[] = {45./512., 135./256., 441./512., -63./64., -987./256., 189./128., 693./256., 25./64., -375./512., -105./256., -35./512.};
-    psi63.mask = psi63mask;
-    psi63.mask_start = -3;
-    psi63.mask_end = 7;
-    psi63.output_start = -4;
-    psi63.output_end = 6;
-
-
-    psi64.spline_order = 6;
-    psi64.vanishing_moments = 4;
-    const double psi64mask[] = {-35./1024., -105./512., -165./512., 235./512., 1827./1024., 63./256., -987./256., 63./256., 1827./1024., 235./512., -165./512., -105./512, -35./1024.};
-    psi64.mask = psi64mask;
-    psi64.mask_start = -3;
-    psi64.mask_end = 9;
-    psi64.output_start = -4;
-    psi64.output_end = 7;
-    // </editor-fold>
+    cout << "Visualize spline wavelets." << endl;
+
+    string format_name;
+    output_format_t format = format_matlab;
+    if (take_option(argc, argv, "--format", format_name) && !parse_output_format(format_name, format))
+    {
+        cout << "\nOutput format has to be m, npy, f64 or f32.\nProgram end." << endl;
+        return 1;
+    }
+
+    string resolution_value, threads_value;
+    long long R = 200; /* resolution, e.g., R = 200 */
+    int threads = 1;
+    if (take_option(argc, argv, "--resolution", resolution_value) && (R = atoll(resolution_value.c_str())) < 1)
+    {
+        cout << "\nResolution has to be positive.\nProgram end." << endl;
+        return 1;
+    }
+    if (take_option(argc, argv, "--threads", threads_value) && (threads = atoi(threads_value.c_str())) < 0)
+    {
+        cout << "\nNumber of threads has to be nonnegative.\nProgram end." << endl;
+        return 1;
+    }
 
+    string derivative_value;
+    int derivative = 0;
+    if (take_option(argc, argv, "--derivative", derivative_value) && (derivative = atoi(derivative_value.c_str())) < 0)
+    {
+        cout << "\nDerivative order has to be nonnegative.\nProgram end." << endl;
+        return 1;
+    }
+
+    string table_cache, table_limit;
+    const bool use_table_cache = take_option(argc, argv, "--table-cache", table_cache);
+    long long limit = 1024; /* megabytes of the table cache */
+    if (take_option(argc, argv, "--table-limit", table_limit) && (limit = atoll(table_limit.c_str())) < 1)
+    {
+        cout << "\nTable cache limit has to be positive.\nProgram end." << endl;
+        return 1;
+    }
+
+    string cache_file;
+    const bool use_cache = take_option(argc, argv, "--cache", cache_file);
+    if (use_cache)
+    {
+        load_psi_cache(cache_file.c_str()); /* a missing file starts an empty cache */
+    }
+    const int cached = psi_cache_size();
+
+    if (argc >= 2 && string(argv[1]) == "--batch")
+    {
+        const int result = batch(argc, argv, verbosity, format, derivative);
+        if (use_cache && psi_cache_size() > cached && !save_psi_cache(cache_file.c_str()))
+        {
+            cout << "\nCannot write mask cache '" << cache_file << "'." << endl;
+        }
+        return result;
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--gram")
+    {
+        return gram_matrices(argc, argv);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--tensor")
+    {
+        return tensor_grid(argc, argv, verbosity, format, (size_t) R, threads);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--precisions")
+    {
+        return precision_report(argc, argv, (size_t) R, threads);
+    }
+
+    if (argc == 2 && string(argv[1]) == "--verify")
+    {
+        const bool splines_equal = verify_bsplines(&cout);
+        const bool masks_equal = verify_construction(&cout);
+        const bool multilevel_equal = verify_multilevel(&cout);
+        const bool gram_equal = verify_spline_gram(&cout);
+        const bool derivatives_equal = verify_wavelet_derivatives(&cout);
+        const bool tensor_equal = verify_tensor_sampler(&cout);
+        const bool precisions_equal = verify_wavelet_precisions(&cout);
+        const bool interface_equal = verify_c_wavelets(&cout);
+        const bool all_equal = verify_synthesis(&cout) && splines_equal && masks_equal && multilevel_equal && gram_equal
+                               && derivatives_equal && tensor_equal && precisions_equal && interface_equal;
+        cout << (all_equal ? "\nAll B-splines and wavelets agree." : "\nWarning: B-splines or wavelets differ.") << endl;
+        return all_equal ? 0 : 1;
+    }
 
+    cout << "Implemented pairs (spline order, vanishing moments): " << endl;
 
     /*
      *  user input of spline order and vanishing moments
@@ -234,178 +596,112 @@ int main(int argc, char** argv)
     else
     {
 
-        cout << "\nInput spline order {2,3,4,5,6}: ";
+        cout << "\nInput spline order {2,3,4,5,6} (up to " << max_spline_order << "): ";
         cin >> spline_order;
-        cout << "Input vanishing moments {2,3,4}: ";
+        cout << "Input vanishing moments {2,3,4} (up to " << max_vanishing_moments << " if the sum is even): ";
         cin >> vanishing_moments;
     }
 
     /*
      * select spline wavelet according to user input
      */
-    int identifier = (spline_order << 16) | vanishing_moments;
-#if 0
-    for (int i = 2; i < 5; i++)
+    const psi_t* selected = select_psi(spline_order, vanishing_moments);
+    if (selected == NULL)
     {
-        for (int j = 2; j < 5; j ++)
-        {
-            cout << "(" << i << ", " << j << "): identifier = " << ( (i << 16)|j ) << endl;
-        }
+        cout << "\nCombination of spline order " << spline_order
+             << " and vanishing moments " << vanishing_moments
+             << " not implemented.\nProgram end." << endl;
+        return 1;
     }
-#endif
-
-    switch (identifier)
-    {
-        case 131074:
-            psi = psi22;
-            break;
-        case 131075:
-            psi = psi23;
-            break;
-        case 131076:
-            psi = psi24;
-            break;
-        case 196610:
-            psi = psi32;
-            break;
-        case 196611:
-            psi = psi33;
-            break;
-        case 196612:
-            psi = psi34;
-            break;
-        case 262146:
-            psi = psi42;
-            break;
-        case 262147:
-            psi = psi43;
-            break;
-        case 262148:
-            psi = psi44;
-            break;
-        case 327682:
-            psi = psi52;
-            break;
-        case 327683:
-            psi = psi53;
-            break;
-        case 327684:
-            psi = psi54;
-            break;
-        case 393218:
-            psi = psi62;
-            break;
-        case 393219:
-            psi = psi63;
-            break;
-        case 393220:
-            psi = psi64;
-            break;
-        default:
-            cout << "\nCombination of spline order " << spline_order
-                 << " and vanishing moments " << vanishing_moments
-                 << " not implemented.\nProgram end." << endl;
-            return 1;
-            break;
+    const psi_t& psi = *selected;
+
+    if (use_cache && psi_cache_size() > cached && !save_psi_cache(cache_file.c_str()))
+    {
+        cout << "\nCannot write mask cache '" << cache_file << "'." << endl;
     }
 
     //cout << *(psi.mask + 2) << endl; /* test output third mask entry */
 
     /* program parameter */
-    const int R = 200; /* resolution, e.g., R = 200 */
-    double step_size = ( (double) (psi.mask_end - psi.mask_start) / (double) R );
-    double scaling_wavelet[R+1] = {0.0}; /* data container */
-    double x_values[R+1] = {0.0};
-    int stop_write_index = R;
-    double value;
+    WaveletSampler sampler(psi, derivative);
+    ThreadPool pool(threads);
+    if (pool.size() > 1)
+    {
+        sampler.set_thread_pool(&pool);
+    }
+    double step_size = sampler.step_size(R);
+
+    if (!sampler.valid())
+    {
+        if (derivative >= psi.spline_order)
+        {
+            cout << "\nDerivative has to be below the spline order " << psi.spline_order << ". Program end." << endl;
+        }
+        else { cout << "\nSpline order " << psi.spline_order << " not implemented. Program end." << endl; }
+        return 2;
+    }
 
 
     /* setup output file */
     char filename[250];
-    sprintf(filename, "spline_wavelet_%d_%d.m", psi.spline_order, psi.vanishing_moments);
-    ofstream ofs;
+    sprintf(filename, "spline_wavelet_%d_%d%s%s", psi.spline_order, psi.vanishing_moments,
+            derivative_suffix(derivative).c_str(), format_extension(format));
 
     /* ask user if output should be written to file */
-    char answer;
+    char answer = 'n';
     bool output_file_open = false;
     cout << "\nWrite output to file '" << filename << "' [y,N]? ";
     cin >> answer;
-    if (answer == 'y' || answer == 'Y' )
-    {
-        ofs.open(filename);
-        output_file_open = true;
-    }
-    else
-    {
-        ofs.close(); /* just to make sure */
-    }
+    output_file_open = (answer == 'y' || answer == 'Y');
 
     cout << "\nOutput interval: [" << psi.output_start << ", " << psi.output_end << ")" << endl
          << "Resolution: " << step_size << endl
          << "\nOutput:" << endl;
 
-    /* compute and write x values */
-    ofs << "X = [";
-    for (int i = 0; i <= R; i++)
+    /* sampling, the samples go straight into the output file */
+    Timer timer;
+    MappedTable table;
+    string table_path;
+    bool generated = false;
+    if (use_table_cache)
     {
-        x_values[i] = (double)(psi.output_start) + i * step_size;
-        //cout << i << "  " << x_values[i] << endl;
-
-        /* write x values to file */
-        if (x_values[i] <= psi.output_end)
+        /* the samples are mapped from the table cache, generated on a miss */
+        TableCache cache(table_cache, (unsigned long long) limit << 20);
+        const uint64_t key = sampler.table_key(R);
+        table_path = cache.table_path(key);
+        if (!cache.fetch(key, sampler.samples(R), [&] (double* values, size_t n) { return sampler.sample(R, values, n); },
+                         table, &generated))
         {
-            ofs << x_values[i] << " ";
-            stop_write_index = i;
+            cout << "\nCannot compute or store the samples in the table cache '" << table_cache << "'.\nProgram end." << endl;
+            return 1;
         }
     }
-    ofs << "];\n\nY = [";
-
 
-    for (int k = psi.mask_start; k <= psi.mask_end; k++)
+    double min_value, max_value;
+    if (!sample_spline_wavelet(sampler, R, table.data(), output_file_open ? filename : NULL, format,
+                               verbosity >= verbosity_trace, min_value, max_value))
     {
-        for (int i = 0; i <= R; i++)
-        {
-            //scaling_wavelet[i] += *(psi.mask + (k-psi.mask_start)) * Bspline<spline_order>(2*x_values[i], -2.0 + k);
-
-            switch (psi.spline_order)
-            {
-                case 2:
-                    value = *(psi.mask + (k-psi.mask_start)) * Bspline<2>(2*x_values[i], -2.0 + k);
-                    break;
-                case 3:
-                    value = *(psi.mask + (k-psi.mask_start)) * Bspline<3>(2*x_values[i], -2.0 + k);
-                    break;
-                case 4:
-                    value = *(psi.mask + (k-psi.mask_start)) * Bspline<4>(2*x_values[i], -2.0 + k);
-                    break;
-                case 5:
-                    value = *(psi.mask + (k-psi.mask_start)) * Bspline<5>(2*x_values[i], -2.0 + k);
-                    break;
-                case 6:
-                    value = *(psi.mask + (k-psi.mask_start)) * Bspline<6>(2*x_values[i], -2.0 + k);
-                    break;
-                default:
-                    cout << "\nSpline order " << psi.spline_order << " not implemented. Program end." << endl;
-                    return 2;
-                    break;
-            }
-            scaling_wavelet[i] += value;
-        }
+        if (output_file_open) { cout << "\nCannot write output file '" << filename << "'." << endl; }
+        else { cout << "\nNot enough memory for resolution " << R << "." << endl; }
+        output_file_open = false;
     }
+    const double seconds = timer.seconds();
 
-    /* output results */
-    for (int i = 0; i <= stop_write_index; i++)
+    if (verbosity >= verbosity_summary)
     {
-        cout << "(" << x_values[i] << ", " << scaling_wavelet[i] << ")" << endl;
-        ofs << scaling_wavelet[i] << " ";
+        ostringstream summary;
+        if (use_table_cache)
+        {
+            summary << "Table: " << table_path << (generated ? " (generated)" : " (cached)") << "\n";
+        }
+        summary << "Samples: " << sampler.samples(R) << "\n"
+                << "Min: " << min_value << "\n"
+                << "Max: " << max_value << "\n"
+                << "Threads: " << pool.size() << "\n"
+                << "Time: " << seconds << " s\n";
+        cout << summary.str();
     }
 
-    ofs << "];\n\nfigure;\nplot(X,Y, 'b', 'LineWidth', 2);" << endl
-        << "axis tight;\nset(gca, 'FontSize', 20);" << endl
-        << "title('N_" << psi.spline_order << ": spline wavelet \\psi_" << psi.spline_order << "^" << psi.vanishing_moments << "');" << endl;
-
-    ofs.close();
-
     cout << "\nCardinal B-spline: N_" << psi.spline_order << endl
          << "Vanishing moments: " << psi.vanishing_moments << endl
          << "Output interval: [" << psi.output_start << ", " << psi.output_end << ")" << endl
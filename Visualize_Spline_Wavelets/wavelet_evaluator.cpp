@@ -0,0 +1,210 @@
+/*
+ * wavelet_evaluator.cpp
+ * Vectorized evaluation of spline wavelets at arbitrary points.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <climits>
+#include <iomanip>
+#include <ostream>
+#include <type_traits>
+#include "bspline.h"
+#include "wavelet_evaluator.h"
+
+using namespace std;
+
+/* i = 0, 8, 16, ... start the cache lines of x and y */
+static const size_t points_per_line = 8;
+
+/* smaller arrays are not worth waking up the threads */
+static const size_t min_points_per_thread = 16384;
+
+
+simd_t detect_simd()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) { return simd_avx512; }
+    if (__builtin_cpu_supports("avx2"))    { return simd_avx2; }
+#endif
+    return simd_scalar;
+}
+
+
+const char* simd_name(simd_t simd)
+{
+    switch (simd)
+    {
+        case simd_avx2:   return "AVX2";
+        case simd_avx512: return "AVX-512";
+        default:          return "scalar";
+    }
+}
+
+
+/*
+ * coefficients of the pieces of f(z) = sum_i c[i] N_order(z - (first + i)):
+ * on [n, n+1) the B-splines N_order(t + r), r = 0..order-1, of the shifts
+ * n - r contribute, the piece of [n, n+1) gets the index n - first + 1.
+ * Float pieces are accumulated in double and rounded once.
+ */
+template <int order, typename T>
+static void pieces_of(const double* c, int first, size_t count, vector<T>& result)
+{
+    typedef typename conditional<is_same<T, float>::value, double, T>::type wide_t;
+    static const bspline_pieces_t<order, wide_t> table = bspline_pieces<order, wide_t>();
+
+    const size_t pieces = count + order - 1;
+    vector<wide_t> coefficient((pieces + 2) * order, wide_t(0.0));
+
+    for (size_t p = 1; p <= pieces; p++)
+    {
+        for (int r = 0; r < order; r++)
+        {
+            /* shift n - r = first + p - 1 - r, i.e. c[p - 1 - r] */
+            if (p < (size_t) (r + 1) || p - 1 - r >= count) { continue; }
+
+            const wide_t a = c[p - 1 - r];
+            for (int d = 0; d < order; d++)
+            {
+                coefficient[p * order + d] += a * table.coefficient[r][d];
+            }
+        }
+    }
+
+    result.resize(coefficient.size());
+    for (size_t i = 0; i < coefficient.size(); i++) { result[i] = T(coefficient[i]); }
+}
+
+
+/*
+ * psi(x) = sum_k mask[k] N_order(2x + 2 - k) is the series with the shifts
+ * first = mask_start - 2
+ */
+template <typename T>
+BasicWaveletEvaluator<T>::BasicWaveletEvaluator(const psi_t& psi, int derivative)
+    : BasicWaveletEvaluator(psi.spline_order, psi.mask, psi.mask_start - 2, psi.mask_end - psi.mask_start + 1, 2.0, derivative)
+{
+}
+
+
+template <typename T>
+BasicWaveletEvaluator<T>::BasicWaveletEvaluator(int spline_order, const double* c, int first, size_t count, double scale, int derivative)
+    : scale(scale), shift(1.0 - first), order(spline_order - derivative),
+      instruction_set(detect_simd()), threads(NULL)
+{
+    /* scale^r (Delta^r c)[i] = scale^r sum_l (-1)^l binom(r, l) c[i - l], i < count + r */
+    vector<double> differences;
+    if (derivative > 0 && derivative < spline_order)
+    {
+        differences.assign(c, c + count);
+        for (int l = 0; l < derivative; l++)
+        {
+            differences.push_back(0.0);
+            for (size_t i = differences.size() - 1; i > 0; i--)
+            {
+                differences[i] = scale * (differences[i] - differences[i-1]);
+            }
+            differences[0] *= scale;
+        }
+        c = differences.data();
+        count = differences.size();
+    }
+    if (derivative < 0 || derivative >= spline_order) { order = 0; }
+
+    switch (order)
+    {
+        case 1: pieces_of<1, T>(c, first, count, coefficient); break;
+        case 2: pieces_of<2, T>(c, first, count, coefficient); break;
+        case 3: pieces_of<3, T>(c, first, count, coefficient); break;
+        case 4: pieces_of<4, T>(c, first, count, coefficient); break;
+        case 5: pieces_of<5, T>(c, first, count, coefficient); break;
+        case 6: pieces_of<6, T>(c, first, count, coefficient); break;
+        case 7: pieces_of<7, T>(c, first, count, coefficient); break;
+        case 8: pieces_of<8, T>(c, first, count, coefficient); break;
+        default: order = 0;
+    }
+
+    select_simd(instruction_set);
+}
+
+
+template <typename T>
+simd_t BasicWaveletEvaluator<T>::select_simd(simd_t simd)
+{
+    /* the vector kernels gather with 32 bit indices piece * order */
+    const simd_t supported = (coefficient.size() > (size_t) INT32_MAX) ? simd_scalar : detect_simd();
+    instruction_set = (simd > supported) ? supported : simd;
+
+    return instruction_set;
+}
+
+
+template <typename T>
+void BasicWaveletEvaluator<T>::evaluate(const T* x, T* y, size_t n) const
+{
+    if (!valid() || n == 0) { return; }
+
+    const basic_piecewise<T> psi = { coefficient.data(), scale, shift, T(pieces() + 1), order };
+    const basic_evaluation_kernel<T> kernel = evaluation_kernel<T>(instruction_set, order);
+
+    if (threads == NULL)
+    {
+        kernel(psi, x, y, n);
+    }
+    else
+    {
+        threads->parallel_for(0, n, points_per_line, min_points_per_thread,
+                              [&] (size_t begin, size_t end) { kernel(psi, x + begin, y + begin, end - begin); });
+    }
+}
+
+
+template class BasicWaveletEvaluator<float>;
+template class BasicWaveletEvaluator<double>;
+template class BasicWaveletEvaluator<long double>;
+template class BasicWaveletEvaluator<dd_real>;
+
+
+/*
+ * largest difference of BsplineHorner<k> and the recursive reference
+ * Bspline<k> on a grid of [-1, k+1] with spacing 1/1024
+ */
+template <int k>
+static double bspline_difference()
+{
+    double difference = 0.0;
+    for (int i = -1024; i <= 1024 * (k + 1); i++)
+    {
+        const double x = i / 1024.0 + 0.3;
+        difference = max(difference, fabs(BsplineHorner<k>(x, 0.3) - Bspline<k>(x, 0.3)));
+    }
+
+    return difference;
+}
+
+
+bool verify_bsplines(ostream* log)
+{
+    const double difference[] = { bspline_difference<2>(), bspline_difference<3>(), bspline_difference<4>(),
+                                  bspline_difference<5>(), bspline_difference<6>() };
+
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nOrder | Max. difference to the recursion\n"
+             << "------------------------------------------\n";
+    }
+    for (int k = 2; k <= 6; k++)
+    {
+        if (log != NULL) { *log << setw(5) << k << " | " << difference[k-2] << "\n"; }
+        all_equal = all_equal && difference[k-2] < 1e-13;
+    }
+
+    return all_equal;
+}
@@ -0,0 +1,164 @@
+/*
+ * wavelet_evaluator.h
+ * Vectorized evaluation of spline wavelets at arbitrary points.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_WAVELET_EVALUATOR_H
+#define SPLINE_WAVELET_EVALUATOR_H
+
+#include <cstddef>
+#include <vector>
+#include "spline_wavelets.h"
+#include "../common/thread_pool.h"
+#include "../common/precision.h"
+
+
+/*
+ * instruction sets of the evaluation kernels
+ */
+typedef enum {
+    simd_scalar = 0,
+    simd_avx2,
+    simd_avx512
+}simd_t;
+
+/*
+ * psi as piecewise polynomial in z = scale x + shift: on [p, p+1) psi is
+ * sum_d coefficient[p * order + d] (z - p)^d. The pieces 0 and last are
+ * zero, every z is clamped to [0, last], so points outside the support
+ * need no branch. T is float, double, long double or dd_real.
+ */
+template <typename T>
+struct basic_piecewise
+{
+    const T* coefficient;
+    T scale;
+    T shift;
+    T last;
+    int order;
+};
+
+typedef basic_piecewise<double> piecewise_t;
+
+/*
+ * y[i] = psi(x[i]) for i < n by one interval lookup and Horner's rule.
+ * All kernels use the same operations in the same order without fused
+ * multiply-add, so their results agree bit for bit with the scalar one.
+ */
+template <typename T>
+using basic_evaluation_kernel = void (*)(const basic_piecewise<T>& psi, const T* x, T* y, size_t n);
+
+typedef basic_evaluation_kernel<double> evaluation_kernel_t;
+
+/* widest instruction set supported by the cpu */
+simd_t detect_simd();
+
+const char* simd_name(simd_t simd);
+
+/*
+ * dispatch table of wavelet_evaluator_simd.cpp, simd has to be supported
+ * by the cpu, float and double have vector kernels (twice the points per
+ * vector for float), long double and dd_real the scalar one
+ * @return kernel unrolled for the spline order, NULL for orders other
+ *         than 1, ..., max_spline_order
+ */
+template <typename T = double>
+basic_evaluation_kernel<T> evaluation_kernel(simd_t simd, int order);
+
+
+/*
+ * Evaluates psi, or any series of B-splines sum_i c[i] N_m(scale x - k_i),
+ * at arrays of points: SIMD across points, and with a thread
+ * pool one contiguous chunk of points per thread. Every point is computed
+ * independently by the same arithmetic, so the result does not depend on
+ * the instruction set or the number of threads. The points, the values
+ * and the pieces are of type T; the pieces are computed from the double
+ * coefficients c in the wider of T and double.
+ */
+template <typename T>
+class BasicWaveletEvaluator
+{
+public:
+    /*
+     * @param psi spline wavelet, the mask is copied into the pieces
+     * @param derivative order r of psi^(r), 0..m-1
+     */
+    explicit BasicWaveletEvaluator(const psi_t& psi, int derivative = 0);
+
+    /*
+     * f(x) = sum_i c[i] N_m(scale x - (first + i)), or its derivative
+     * f^(r)(x) = scale^r sum_i (Delta^r c)[i] N_{m-r}(scale x - (first + i))
+     * by N_m' = N_{m-1} - N_{m-1}(. - 1), so derivatives are evaluated by the
+     * kernels of order m - r at the cost of values.
+     * @param spline_order m
+     * @param c B-spline coefficients, copied into the pieces
+     * @param first shift of c[0]
+     * @param count number of coefficients
+     * @param scale dilation, e.g. 2^J
+     * @param derivative order r, 0..m-1
+     */
+    BasicWaveletEvaluator(int spline_order, const double* c, int first, size_t count, double scale, int derivative = 0);
+
+    /* false if the spline order of psi is not implemented or r too large */
+    bool valid() const { return order > 0; }
+
+    /*
+     * @param pool threads used by evaluate(), NULL (default) computes serially
+     */
+    void set_thread_pool(ThreadPool* pool) { threads = pool; }
+
+    /*
+     * @param simd instruction set, reduced to detect_simd() if not supported
+     *        and to simd_scalar beyond 2^31 coefficients, the index limit
+     *        of the vector gathers
+     * @return instruction set used by evaluate()
+     */
+    simd_t select_simd(simd_t simd);
+    simd_t selected_simd() const { return instruction_set; }
+
+    /*
+     * @param x points, NaN and infinite points give NaN
+     * @param y psi(x[i])
+     * @param n number of points
+     */
+    void evaluate(const T* x, T* y, size_t n) const;
+
+    /* number of nonzero polynomial pieces */
+    int pieces() const { return (int) (coefficient.size() / (order > 0 ? order : 1)) - 2; }
+
+    /*
+     * pieces in z = scale x + shift, see piecewise_t: on [p, p+1) the
+     * function is sum_d piece_coefficients()[p * order + d] (z - p)^d
+     */
+    const std::vector<T>& piece_coefficients() const { return coefficient; }
+    T piece_scale() const { return scale; }
+    T piece_shift() const { return shift; }
+    int spline_order() const { return order; }
+
+private:
+    std::vector<T> coefficient;
+    T scale;
+    T shift;
+    int order;  /* spline order, 0 if not implemented */
+    simd_t instruction_set;
+    ThreadPool* threads;
+};
+
+typedef BasicWaveletEvaluator<double> WaveletEvaluator;
+
+
+/*
+ * Compare the piecewise polynomial B-splines N_2, ..., N_6 with the
+ * reference recursion.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_bsplines(std::ostream* log);
+
+#endif /* SPLINE_WAVELET_EVALUATOR_H */
@@ -0,0 +1,248 @@
+/*
+ * wavelet_evaluator_simd.cpp
+ * Scalar and vectorized (AVX2, AVX-512) evaluation kernels of spline
+ * wavelets in piecewise polynomial form.
+ *
+ * Every kernel computes z = scale x + shift, the piece floor(z) clamped to
+ * [0, last] and t = z - floor(z), gathers the coefficients of the pieces
+ * and applies Horner's rule with separate multiplication and addition.
+ * The remaining points are handled by the scalar kernel. Float kernels
+ * hold twice the points of double per vector, long double and dd_real use
+ * the scalar kernel only. The functions are
+ * compiled for their instruction set by target attributes and selected at
+ * run time, see wavelet_evaluator.cpp.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <type_traits>
+#include "wavelet_evaluator.h"
+
+using namespace std;
+
+
+template <int order, typename T>
+static void evaluate_scalar(const basic_piecewise<T>& psi, const T* x, T* y, size_t n)
+{
+    const T zero = T(0.0);
+    for (size_t i = 0; i < n; i++)
+    {
+        const T z = psi.scale * x[i] + psi.shift;
+        const T f = floor(z);
+        const T t = z - f;
+
+        /* same clamping as max_pd / min_pd, NaN goes to the zero piece 0 */
+        T piece = (f > zero) ? f : zero;
+        piece = (piece < psi.last) ? piece : psi.last;
+        const T* c = psi.coefficient + (size_t) to_double(piece) * order;
+
+        T value = c[order-1];
+#pragma GCC unroll 8
+        for (int d = order-2; d >= 0; d--)
+        {
+            value = value * t + c[d];
+        }
+        y[i] = value;
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+
+/*
+ * 4 points per vector
+ */
+template <int order>
+__attribute__((target("avx2")))
+static void evaluate_avx2(const piecewise_t& psi, const double* x, double* y, size_t n)
+{
+    const __m256d scale = _mm256_set1_pd(psi.scale);
+    const __m256d shift = _mm256_set1_pd(psi.shift);
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d last = _mm256_set1_pd(psi.last);
+    const __m128i stride = _mm_set1_epi32(order);
+    const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256d z = _mm256_add_pd(_mm256_mul_pd(scale, _mm256_loadu_pd(x + i)), shift);
+        const __m256d f = _mm256_floor_pd(z);
+        const __m256d t = _mm256_sub_pd(z, f);
+        const __m256d piece = _mm256_min_pd(_mm256_max_pd(f, zero), last);
+        const __m128i base = _mm_mullo_epi32(_mm256_cvttpd_epi32(piece), stride);
+
+        /* masked gathers with a defined source, all lanes are loaded */
+        __m256d value = _mm256_mask_i32gather_pd(zero, psi.coefficient + (order-1), base, all, 8);
+#pragma GCC unroll 8
+        for (int d = order-2; d >= 0; d--)
+        {
+            value = _mm256_add_pd(_mm256_mul_pd(value, t), _mm256_mask_i32gather_pd(zero, psi.coefficient + d, base, all, 8));
+        }
+        _mm256_storeu_pd(y + i, value);
+    }
+
+    evaluate_scalar<order, double>(psi, x + i, y + i, n - i);
+}
+
+
+/*
+ * 8 points per vector
+ */
+template <int order>
+__attribute__((target("avx512f")))
+static void evaluate_avx512(const piecewise_t& psi, const double* x, double* y, size_t n)
+{
+    const __m512d scale = _mm512_set1_pd(psi.scale);
+    const __m512d shift = _mm512_set1_pd(psi.shift);
+    const __m512d zero = _mm512_setzero_pd();
+    const __m512d last = _mm512_set1_pd(psi.last);
+    const __m256i stride = _mm256_set1_epi32(order);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512d z = _mm512_add_pd(_mm512_mul_pd(scale, _mm512_loadu_pd(x + i)), shift);
+        /* masked forms with a defined source, all lanes are computed */
+        const __m512d f = _mm512_mask_roundscale_pd(zero, 0xFF, z, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512d t = _mm512_sub_pd(z, f);
+        const __m512d piece = _mm512_mask_min_pd(zero, 0xFF, _mm512_mask_max_pd(zero, 0xFF, f, zero), last);
+        const __m256i base = _mm256_mullo_epi32(_mm512_mask_cvttpd_epi32(_mm256_setzero_si256(), 0xFF, piece), stride);
+
+        __m512d value = _mm512_mask_i32gather_pd(zero, 0xFF, base, psi.coefficient + (order-1), 8);
+#pragma GCC unroll 8
+        for (int d = order-2; d >= 0; d--)
+        {
+            value = _mm512_add_pd(_mm512_mul_pd(value, t), _mm512_mask_i32gather_pd(zero, 0xFF, base, psi.coefficient + d, 8));
+        }
+        _mm512_storeu_pd(y + i, value);
+    }
+
+    evaluate_avx2<order>(psi, x + i, y + i, n - i);
+}
+
+
+/*
+ * 8 float points per vector
+ */
+template <int order>
+__attribute__((target("avx2")))
+static void evaluate_avx2_float(const basic_piecewise<float>& psi, const float* x, float* y, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(psi.scale);
+    const __m256 shift = _mm256_set1_ps(psi.shift);
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 last = _mm256_set1_ps(psi.last);
+    const __m256i stride = _mm256_set1_epi32(order);
+    const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m256 z = _mm256_add_ps(_mm256_mul_ps(scale, _mm256_loadu_ps(x + i)), shift);
+        const __m256 f = _mm256_floor_ps(z);
+        const __m256 t = _mm256_sub_ps(z, f);
+        const __m256 piece = _mm256_min_ps(_mm256_max_ps(f, zero), last);
+        const __m256i base = _mm256_mullo_epi32(_mm256_cvttps_epi32(piece), stride);
+
+        /* masked gathers with a defined source, all lanes are loaded */
+        __m256 value = _mm256_mask_i32gather_ps(zero, psi.coefficient + (order-1), base, all, 4);
+#pragma GCC unroll 8
+        for (int d = order-2; d >= 0; d--)
+        {
+            value = _mm256_add_ps(_mm256_mul_ps(value, t), _mm256_mask_i32gather_ps(zero, psi.coefficient + d, base, all, 4));
+        }
+        _mm256_storeu_ps(y + i, value);
+    }
+
+    evaluate_scalar<order, float>(psi, x + i, y + i, n - i);
+}
+
+
+/*
+ * 16 float points per vector
+ */
+template <int order>
+__attribute__((target("avx512f")))
+static void evaluate_avx512_float(const basic_piecewise<float>& psi, const float* x, float* y, size_t n)
+{
+    const __m512 scale = _mm512_set1_ps(psi.scale);
+    const __m512 shift = _mm512_set1_ps(psi.shift);
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 last = _mm512_set1_ps(psi.last);
+    const __m512i stride = _mm512_set1_epi32(order);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m512 z = _mm512_add_ps(_mm512_mul_ps(scale, _mm512_loadu_ps(x + i)), shift);
+        /* masked forms with a defined source, all lanes are computed */
+        const __m512 f = _mm512_mask_roundscale_ps(zero, 0xFFFF, z, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+        const __m512 t = _mm512_sub_ps(z, f);
+        const __m512 piece = _mm512_mask_min_ps(zero, 0xFFFF, _mm512_mask_max_ps(zero, 0xFFFF, f, zero), last);
+        const __m512i base = _mm512_mullo_epi32(_mm512_mask_cvttps_epi32(_mm512_setzero_si512(), 0xFFFF, piece), stride);
+
+        __m512 value = _mm512_mask_i32gather_ps(zero, 0xFFFF, base, psi.coefficient + (order-1), 4);
+#pragma GCC unroll 8
+        for (int d = order-2; d >= 0; d--)
+        {
+            value = _mm512_add_ps(_mm512_mul_ps(value, t), _mm512_mask_i32gather_ps(zero, 0xFFFF, base, psi.coefficient + d, 4));
+        }
+        _mm512_storeu_ps(y + i, value);
+    }
+
+    evaluate_avx2_float<order>(psi, x + i, y + i, n - i);
+}
+
+#endif
+
+
+template <int order, typename T>
+static basic_evaluation_kernel<T> kernel_of(simd_t simd)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (is_same<T, double>::value)
+    {
+        if (simd == simd_avx512) { return evaluate_avx512<order>; }
+        if (simd == simd_avx2)   { return evaluate_avx2<order>; }
+    }
+    if constexpr (is_same<T, float>::value)
+    {
+        if (simd == simd_avx512) { return evaluate_avx512_float<order>; }
+        if (simd == simd_avx2)   { return evaluate_avx2_float<order>; }
+    }
+#endif
+    return evaluate_scalar<order, T>;
+}
+
+
+template <typename T>
+basic_evaluation_kernel<T> evaluation_kernel(simd_t simd, int order)
+{
+    switch (order)
+    {
+        case 1: return kernel_of<1, T>(simd);
+        case 2: return kernel_of<2, T>(simd);
+        case 3: return kernel_of<3, T>(simd);
+        case 4: return kernel_of<4, T>(simd);
+        case 5: return kernel_of<5, T>(simd);
+        case 6: return kernel_of<6, T>(simd);
+        case 7: return kernel_of<7, T>(simd);
+        case 8: return kernel_of<8, T>(simd);
+        default: return NULL;
+    }
+}
+
+
+template basic_evaluation_kernel<float> evaluation_kernel<float>(simd_t, int);
+template basic_evaluation_kernel<double> evaluation_kernel<double>(simd_t, int);
+template basic_evaluation_kernel<long double> evaluation_kernel<long double>(simd_t, int);
+template basic_evaluation_kernel<dd_real> evaluation_kernel<dd_real>(simd_t, int);
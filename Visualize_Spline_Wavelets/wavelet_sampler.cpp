@@ -0,0 +1,426 @@
+/*
+ * wavelet_sampler.cpp
+ * Sampling of spline wavelets on large equidistant grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <new>
+#include <string>
+#include "bspline.h"
+#include "wavelet_sampler.h"
+#include "../common/table_cache.h"
+#include "../common/timer.h"
+
+using namespace std;
+
+
+/*
+ * reference: every mask tap times every sample point with the recursive
+ * B-spline, O(mask length * n * 2^order). The derivative psi^(r) uses the
+ * differences N_m^(r)(x) = sum_l (-1)^l binom(r, l) N_{m-r}(x - l), so
+ * order is m - r.
+ */
+template <int order>
+static void synthesize_reference(const psi_t& psi, int r, const double* x, double* y, size_t n)
+{
+    fill(y, y + n, 0.0);
+
+    for (int k = psi.mask_start; k <= psi.mask_end; k++)
+    {
+        double binomial = ldexp(1.0, r); /* d/dx N(2x) = 2 N'(2x) */
+        for (int l = 0; l <= r; l++)
+        {
+            const double c = *(psi.mask + (k-psi.mask_start)) * ((l % 2 == 0) ? binomial : -binomial);
+            for (size_t i = 0; i < n; i++)
+            {
+                y[i] += c * Bspline<order>(2*x[i], -2.0 + k + l);
+            }
+            binomial = binomial * (r - l) / (l + 1);
+        }
+    }
+}
+
+
+WaveletSampler::WaveletSampler(const psi_t& psi, int derivative)
+    : psi(psi), evaluator(psi, derivative), derivative_order(derivative), chunk(65536), threads(NULL)
+{
+}
+
+
+double WaveletSampler::step_size(size_t R) const
+{
+    return ( (double) (psi.mask_end - psi.mask_start) / (double) R );
+}
+
+
+double WaveletSampler::grid_point(size_t R, size_t i) const
+{
+    return (double)(psi.output_start) + (double) i * step_size(R);
+}
+
+
+size_t WaveletSampler::samples(size_t R) const
+{
+    if (R == 0) { return 0; }
+
+    /* estimate of the last index, corrected with the rounded grid points */
+    size_t last = (size_t) min((double) R, floor((psi.output_end - psi.output_start) / step_size(R)));
+    while (last < R && grid_point(R, last + 1) <= psi.output_end) { last++; }
+    while (last > 0 && grid_point(R, last) > psi.output_end) { last--; }
+
+    return last + 1;
+}
+
+
+bool WaveletSampler::stream(size_t R, const sample_consumer_t& consumer) const
+{
+    if (!valid() || R == 0) { return false; }
+
+    const size_t total = samples(R);
+    const size_t parallel = (threads == NULL) ? 1 : (size_t) threads->size();
+
+    AlignedBuffer<double> x, y;
+    try
+    {
+        x.resize(parallel * chunk);
+        y.resize(parallel * chunk);
+    }
+    catch (const bad_alloc&)
+    {
+        return false;
+    }
+
+    for (size_t first = 0; first < total; first += parallel * chunk)
+    {
+        /* up to one chunk per thread */
+        const size_t chunks = min(parallel, (total - first + chunk - 1) / chunk);
+        const auto compute = [&] (size_t c) {
+            const size_t begin = first + c * chunk;
+            const size_t count = min(chunk, total - begin);
+            double* xc = x.data() + c * chunk;
+            for (size_t i = 0; i < count; i++) { xc[i] = grid_point(R, begin + i); }
+            evaluator.evaluate(xc, y.data() + c * chunk, count);
+        };
+
+        if (chunks > 1) { threads->run(chunks, compute); }
+        else { compute(0); }
+
+        for (size_t c = 0; c < chunks; c++)
+        {
+            const size_t begin = first + c * chunk;
+            if (!consumer(begin, x.data() + c * chunk, y.data() + c * chunk, min(chunk, total - begin)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool WaveletSampler::stream(size_t R, const double* table, const sample_consumer_t& consumer) const
+{
+    const size_t total = samples(R);
+    vector<double> x(min(total, chunk));
+    for (size_t first = 0; first < total; first += chunk)
+    {
+        const size_t count = min(total - first, chunk);
+        for (size_t i = 0; i < count; i++) { x[i] = grid_point(R, first + i); }
+        if (!consumer(first, x.data(), table + first, count)) { return false; }
+    }
+
+    return true;
+}
+
+
+bool WaveletSampler::sample(size_t R, double* values, size_t count) const
+{
+    return stream(R, [&] (size_t first, const double*, const double* y, size_t n) {
+        if (first + n > count) { return false; }
+        memcpy(values + first, y, n * sizeof(double));
+        return true;
+    });
+}
+
+
+uint64_t WaveletSampler::table_key(size_t R) const
+{
+    return TableKey().add(string("spline wavelet")).add((int) psi.spline_order).add((int) psi.vanishing_moments)
+                     .add(psi.mask, (psi.mask_end - psi.mask_start + 1) * sizeof(double))
+                     .add(psi.mask_start).add(psi.output_start).add(derivative_order)
+                     .add((long long) R).add((int) precision_double).value();
+}
+
+
+bool WaveletSampler::evaluate(const double* x, double* y, size_t n) const
+{
+    if (!valid()) { return false; }
+
+    if (threads == NULL || threads->size() == 1)
+    {
+        evaluator.evaluate(x, y, n);
+    }
+    else
+    {
+        /* every thread takes at least one chunk of points, as in stream() */
+        threads->parallel_for(0, n, 8, chunk,
+                              [&] (size_t begin, size_t end) { evaluator.evaluate(x + begin, y + begin, end - begin); });
+    }
+    return true;
+}
+
+
+bool WaveletSampler::evaluate_reference(const double* x, double* y, size_t n) const
+{
+    const int r = derivative_order;
+    switch (psi.spline_order - r)
+    {
+        case 1: synthesize_reference<1>(psi, r, x, y, n); return true;
+        case 2: synthesize_reference<2>(psi, r, x, y, n); return true;
+        case 3: synthesize_reference<3>(psi, r, x, y, n); return true;
+        case 4: synthesize_reference<4>(psi, r, x, y, n); return true;
+        case 5: synthesize_reference<5>(psi, r, x, y, n); return true;
+        case 6: synthesize_reference<6>(psi, r, x, y, n); return true;
+        case 7: synthesize_reference<7>(psi, r, x, y, n); return true;
+        case 8: synthesize_reference<8>(psi, r, x, y, n); return true;
+        default: return false;
+    }
+}
+
+
+bool verify_synthesis(ostream* log)
+{
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nWavelet | Max. difference to the reference synthesis | Kernels\n"
+             << "----------------------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const WaveletSampler sampler(psi);
+        const size_t R = 1000, n = R + 101;
+
+        /* the grid and points around and outside of the support */
+        vector<double> x_values(n), reference(n);
+        for (size_t i = 0; i <= R; i++) { x_values[i] = sampler.grid_point(R, i); }
+        for (size_t i = R + 1; i < n; i++) { x_values[i] = psi.output_start - 5.0 + 0.137 * (i - R); }
+        sampler.evaluate_reference(x_values.data(), reference.data(), n);
+
+        WaveletEvaluator evaluator(psi);
+        vector<vector<double> > values(simd_avx512 + 1, vector<double>(n));
+        for (int simd = simd_scalar; simd <= detect_simd(); simd++)
+        {
+            evaluator.select_simd((simd_t) simd);
+            evaluator.evaluate(x_values.data(), values[simd].data(), n);
+        }
+
+        double difference = 0.0, scale = 0.0;
+        for (size_t i = 0; i < n; i++)
+        {
+            difference = max(difference, fabs(values[simd_scalar][i] - reference[i]));
+            scale = max(scale, fabs(reference[i]));
+        }
+        bool kernels_equal = true;
+        for (int simd = simd_scalar + 1; simd <= detect_simd(); simd++)
+        {
+            kernels_equal = kernels_equal && memcmp(values[simd].data(), values[simd_scalar].data(), n * sizeof(double)) == 0;
+        }
+
+        if (log != NULL)
+        {
+            *log << "    " << psi.spline_order << "," << psi.vanishing_moments << " | " << setw(42) << difference
+                 << " | " << (kernels_equal ? "equal" : "differ") << "\n";
+        }
+        all_equal = all_equal && difference <= 1e-12 * scale && kernels_equal;
+    }
+    if (log != NULL) { *log << "\nInstruction set: " << simd_name(detect_simd()) << "\n"; }
+
+    return all_equal;
+}
+
+
+bool verify_wavelet_derivatives(ostream* log)
+{
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nWavelet | r | Max. difference to the reference derivative | Kernels\n"
+             << "--------------------------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        for (int r = 1; r < psi.spline_order; r++)
+        {
+            const WaveletSampler sampler(psi, r);
+            const size_t R = 1000, n = R + 1;
+
+            vector<double> x_values(n), reference(n);
+            for (size_t i = 0; i < n; i++) { x_values[i] = sampler.grid_point(R, i) + 1e-4; } /* off the knots */
+            sampler.evaluate_reference(x_values.data(), reference.data(), n);
+
+            WaveletEvaluator evaluator(psi, r);
+            vector<vector<double> > values(simd_avx512 + 1, vector<double>(n));
+            for (int simd = simd_scalar; simd <= detect_simd(); simd++)
+            {
+                evaluator.select_simd((simd_t) simd);
+                evaluator.evaluate(x_values.data(), values[simd].data(), n);
+            }
+
+            double difference = 0.0, scale = 0.0;
+            for (size_t i = 0; i < n; i++)
+            {
+                difference = max(difference, fabs(values[simd_scalar][i] - reference[i]));
+                scale = max(scale, fabs(reference[i]));
+            }
+            bool kernels_equal = true;
+            for (int simd = simd_scalar + 1; simd <= detect_simd(); simd++)
+            {
+                kernels_equal = kernels_equal && memcmp(values[simd].data(), values[simd_scalar].data(), n * sizeof(double)) == 0;
+            }
+
+            if (log != NULL)
+            {
+                *log << "    " << psi.spline_order << "," << psi.vanishing_moments << " | " << r << " | " << setw(43) << difference
+                     << " | " << (kernels_equal ? "equal" : "differ") << "\n";
+            }
+            all_equal = all_equal && difference <= 1e-12 * max(1.0, scale) && kernels_equal;
+        }
+    }
+
+    return all_equal;
+}
+
+
+/*
+ * evaluates psi in the type T at the points x
+ * @param simd instruction set of the evaluator
+ * @param values psi(x[i]) in T
+ * @param seconds time of the evaluation
+ * @return largest difference to the double-double values reference
+ */
+template <typename T>
+static double evaluate_in_precision(const psi_t& psi, const vector<double>& x, const vector<dd_real>& reference,
+                                    simd_t simd, ThreadPool* pool, vector<T>& values, double& seconds)
+{
+    BasicWaveletEvaluator<T> evaluator(psi);
+    evaluator.select_simd(simd);
+    evaluator.set_thread_pool(pool);
+
+    vector<T> points(x.size());
+    for (size_t i = 0; i < x.size(); i++) { points[i] = T(x[i]); }
+    values.assign(x.size(), T(0.0));
+
+    Timer timer;
+    evaluator.evaluate(points.data(), values.data(), x.size());
+    seconds = timer.seconds();
+
+    double difference = 0.0;
+    for (size_t i = 0; i < x.size(); i++)
+    {
+        difference = max(difference, to_double(fabs(dd_real((long double) values[i]) - reference[i])));
+    }
+
+    return difference;
+}
+
+
+void compare_precisions(const WaveletSampler& sampler, size_t R, ThreadPool* pool, vector<precision_run_t>& runs,
+                        double& scale)
+{
+    const psi_t& psi = sampler.wavelet();
+    runs.assign(precision_double_double + 1, precision_run_t{0.0, 0.0});
+
+    vector<double> x_values(R + 1);
+    for (size_t i = 0; i <= R; i++) { x_values[i] = sampler.grid_point(R, i); }
+
+    BasicWaveletEvaluator<dd_real> evaluator(psi);
+    evaluator.set_thread_pool(pool);
+    vector<dd_real> points(x_values.begin(), x_values.end()), reference(R + 1);
+    Timer timer;
+    evaluator.evaluate(points.data(), reference.data(), R + 1);
+    runs[precision_double_double].seconds = timer.seconds();
+
+    scale = 0.0;
+    for (size_t i = 0; i <= R; i++) { scale = max(scale, to_double(fabs(reference[i]))); }
+
+    vector<float> float_values;
+    vector<double> double_values;
+    vector<long double> long_values;
+    const simd_t simd = detect_simd();
+    runs[precision_float].difference = evaluate_in_precision(psi, x_values, reference, simd, pool, float_values,
+                                                             runs[precision_float].seconds);
+    runs[precision_double].difference = evaluate_in_precision(psi, x_values, reference, simd, pool, double_values,
+                                                              runs[precision_double].seconds);
+    runs[precision_long_double].difference = evaluate_in_precision(psi, x_values, reference, simd, pool, long_values,
+                                                                   runs[precision_long_double].seconds);
+}
+
+
+bool verify_wavelet_precisions(ostream* log)
+{
+    bool all_equal = true;
+    if (log != NULL)
+    {
+        *log << "\nMax. relative difference to double-double\n"
+             << "\nWavelet |        float |       double |  long double | Kernels\n"
+             << "-----------------------------------------------------------------\n";
+    }
+    for (int p = 0; p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const WaveletSampler sampler(psi);
+        const size_t R = 1000, n = R + 101;
+
+        vector<double> x_values(n);
+        for (size_t i = 0; i <= R; i++) { x_values[i] = sampler.grid_point(R, i); }
+        for (size_t i = R + 1; i < n; i++) { x_values[i] = psi.output_start - 5.0 + 0.137 * (i - R); }
+
+        const BasicWaveletEvaluator<dd_real> evaluator(psi);
+        vector<dd_real> points(x_values.begin(), x_values.end()), reference(n);
+        evaluator.evaluate(points.data(), reference.data(), n);
+
+        double scale = 0.0;
+        for (size_t i = 0; i < n; i++) { scale = max(scale, to_double(fabs(reference[i]))); }
+
+        double seconds;
+        vector<float> float_values, vector_values;
+        vector<double> double_values;
+        vector<long double> long_values;
+        const double difference[] = {
+            evaluate_in_precision(psi, x_values, reference, simd_scalar, NULL, float_values, seconds) / scale,
+            evaluate_in_precision(psi, x_values, reference, simd_scalar, NULL, double_values, seconds) / scale,
+            evaluate_in_precision(psi, x_values, reference, simd_scalar, NULL, long_values, seconds) / scale };
+
+        bool kernels_equal = true;
+        for (int simd = simd_scalar + 1; simd <= detect_simd(); simd++)
+        {
+            evaluate_in_precision(psi, x_values, reference, (simd_t) simd, NULL, vector_values, seconds);
+            kernels_equal = kernels_equal && memcmp(vector_values.data(), float_values.data(), n * sizeof(float)) == 0;
+        }
+
+        if (log != NULL)
+        {
+            *log << "    " << psi.spline_order << "," << psi.vanishing_moments << " | " << setw(12) << difference[0]
+                 << " | " << setw(12) << difference[1] << " | " << setw(12) << difference[2]
+                 << " | " << (kernels_equal ? "equal" : "differ") << "\n";
+        }
+        all_equal = all_equal && kernels_equal && difference[0] <= 1e3 * unit_roundoff(precision_float)
+                    && difference[1] <= 1e3 * unit_roundoff(precision_double)
+                    && difference[2] <= 1e3 * unit_roundoff(precision_long_double);
+    }
+
+    return all_equal;
+}
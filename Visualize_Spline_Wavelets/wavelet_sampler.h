@@ -0,0 +1,167 @@
+/*
+ * wavelet_sampler.h
+ * Sampling of spline wavelets on large equidistant grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SPLINE_WAVELET_SAMPLER_H
+#define SPLINE_WAVELET_SAMPLER_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+#include "spline_wavelets.h"
+#include "wavelet_evaluator.h"
+#include "../common/aligned_buffer.h"
+#include "../common/precision.h"
+#include "../common/thread_pool.h"
+
+
+/*
+ * Receives the samples first, ..., first + count - 1 of a grid in
+ * increasing order. The arrays are only valid during the call.
+ * @return false to stop the sampling
+ */
+typedef std::function<bool (size_t first, const double* x, const double* y, size_t count)> sample_consumer_t;
+
+
+/*
+ * Samples psi(x) at x_i = output_start + i * (mask_end - mask_start) / R,
+ * i = 0, ..., R, as long as x_i <= output_end. The grid is processed in
+ * chunks of aligned heap buffers, so memory is bounded by the chunk size
+ * times the number of threads for any resolution. With a thread pool one
+ * chunk per thread is computed at a time, the consumer still receives the
+ * chunks in order from the calling thread. The samples are computed by
+ * WaveletEvaluator, so they do not depend on the number of threads.
+ */
+class WaveletSampler
+{
+public:
+    /*
+     * @param psi spline wavelet, the mask is not copied
+     * @param derivative samples psi^(r) instead of psi, r < spline order
+     */
+    explicit WaveletSampler(const psi_t& psi, int derivative = 0);
+
+    /* false if the spline order of psi is not implemented or r too large */
+    bool valid() const { return evaluator.valid(); }
+
+    /*
+     * @param pool threads used by stream() and evaluate(), NULL (default)
+     *        computes serially
+     */
+    void set_thread_pool(ThreadPool* pool) { threads = pool; }
+
+    /*
+     * @param samples samples per chunk, default 65536
+     */
+    void set_chunk_size(size_t samples) { chunk = (samples > 0) ? samples : 1; }
+
+    /* distance of the grid points for resolution R */
+    double step_size(size_t R) const;
+
+    /* x_i of the grid for resolution R */
+    double grid_point(size_t R, size_t i) const;
+
+    /* number of grid points x_i <= output_end */
+    size_t samples(size_t R) const;
+
+    /*
+     * @param R resolution
+     * @param consumer receives the samples chunk by chunk
+     * @return false if the spline order is not implemented, memory is
+     *         exhausted or the consumer stopped the sampling
+     */
+    bool stream(size_t R, const sample_consumer_t& consumer) const;
+
+    /*
+     * stream() of samples computed before, e.g. a table of the table cache,
+     * with the grid points of resolution R
+     * @param table samples(R) samples
+     */
+    bool stream(size_t R, const double* table, const sample_consumer_t& consumer) const;
+
+    /*
+     * the samples of resolution R as one array, the generator of the table
+     * cache
+     * @param count length of values, at least samples(R)
+     */
+    bool sample(size_t R, double* values, size_t count) const;
+
+    /*
+     * key of the samples of resolution R in the table cache: the mask, the
+     * derivative order and the resolution, evaluated in double
+     */
+    uint64_t table_key(size_t R) const;
+
+    /*
+     * psi, or psi^(r), at arbitrary points, in chunks of the chunk size
+     * over the threads
+     * @param x points
+     * @param y psi(x[i])
+     * @param n number of points
+     * @return false if the spline order is not implemented
+     */
+    bool evaluate(const double* x, double* y, size_t n) const;
+
+    /* evaluate() over all mask taps with the recursive B-spline, for verification */
+    bool evaluate_reference(const double* x, double* y, size_t n) const;
+
+    const psi_t& wavelet() const { return psi; }
+
+    /* order r of the sampled derivative */
+    int derivative() const { return derivative_order; }
+
+private:
+    psi_t psi;
+    WaveletEvaluator evaluator;
+    int derivative_order;
+    size_t chunk;
+    ThreadPool* threads;
+};
+
+
+/*
+ * Evaluates psi at the R+1 grid points in float, double and long double
+ * with the detected instruction set and compares with double-double.
+ * @param pool threads of the evaluators, may be NULL
+ * @param runs one entry per precision_t
+ * @param scale largest absolute value of the double-double samples
+ */
+void compare_precisions(const WaveletSampler& sampler, size_t R, ThreadPool* pool, std::vector<precision_run_t>& runs,
+                        double& scale);
+
+/*
+ * Compare the evaluation of every spline wavelet with the synthesis over
+ * all mask taps, and the vectorized kernels bit for bit with the scalar one.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_synthesis(std::ostream* log);
+
+/*
+ * Compare the derivatives psi^(r), r = 1, ..., m-1, by the B-spline series
+ * of order m - r with the differences of the recursive B-splines, and all
+ * kernels bit for bit.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within rounding
+ */
+bool verify_wavelet_derivatives(std::ostream* log);
+
+/*
+ * Evaluate every spline wavelet in float, double and long double and
+ * compare with double-double, and the float kernels bit for bit with the
+ * scalar one.
+ * @param log receives a table, may be NULL
+ * @return true if all differences are within the rounding of the type
+ */
+bool verify_wavelet_precisions(std::ostream* log);
+
+#endif /* SPLINE_WAVELET_SAMPLER_H */
@@ -0,0 +1,365 @@
+/*
+ * analysis_kernels.cpp
+ * Decimating convolution and lifting kernels of the wavelet transform.
+ *
+ * The vectorized kernels compute w consecutive coefficients per vector:
+ * the products of one tap with x_even[k+t], ..., x_even[k+w-1+t] are added
+ * to the accumulator, the odd phase follows in the same way. The lifting
+ * kernels accumulate the taps of one step likewise. Remaining coefficients
+ * are handled by the scalar kernels. The functions are compiled
+ * for their instruction set by target attributes and selected at run time.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include "analysis_kernels.h"
+
+using namespace std;
+
+
+/*
+ * floor(a / 2) for negative a as well
+ */
+static int floor_half(int a)
+{
+    return (a >= 0) ? a / 2 : -((1 - a) / 2);
+}
+
+
+analysis_filter_t analysis_filter(const filter_t& filter)
+{
+    analysis_filter_t result;
+    result.shift = floor_half(filter.first);
+    const int parity = filter.first - 2*result.shift;
+
+    /* tap i meets x[2(k+shift) + parity + i] */
+    for (size_t i = 0; i < filter.taps.size(); i++)
+    {
+        const int p = parity + (int) i;
+        if (p % 2 == 0)
+        {
+            result.even.resize(p/2 + 1, 0.0);
+            result.even[p/2] = filter.taps[i];
+        }
+        else
+        {
+            result.odd.resize(p/2 + 1, 0.0);
+            result.odd[p/2] = filter.taps[i];
+        }
+    }
+
+    return result;
+}
+
+
+void analyze_scalar(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    const double* even = filter.even.data();
+    const double* odd = filter.odd.data();
+    const int n_even = (int) filter.even.size();
+    const int n_odd = (int) filter.odd.size();
+
+    for (size_t k = begin; k < end; k++)
+    {
+        double value = 0.0;
+        for (int t = 0; t < n_even; t++)
+        {
+            value += even[t] * x_even[k + t];
+        }
+        for (int t = 0; t < n_odd; t++)
+        {
+            value += odd[t] * x_odd[k + t];
+        }
+        out[k] = 0.5 * value;
+    }
+}
+
+
+void lift_scalar(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    for (size_t i = begin; i < end; i++)
+    {
+        double sum = taps[0] * x[i];
+        for (int j = 1; j < count; j++)
+        {
+            sum += taps[j] * x[i + j];
+        }
+        y[i] += sign * sum;
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+
+/*
+ * 2 coefficients per vector, 2 vectors per iteration
+ */
+__attribute__((target("sse2")))
+void analyze_sse2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    const double* even = filter.even.data();
+    const double* odd = filter.odd.data();
+    const int n_even = (int) filter.even.size();
+    const int n_odd = (int) filter.odd.size();
+    const __m128d half = _mm_set1_pd(0.5);
+
+    size_t k = begin;
+    for (; k + 4 <= end; k += 4)
+    {
+        __m128d value0 = _mm_setzero_pd(), value1 = _mm_setzero_pd();
+        for (int t = 0; t < n_even; t++)
+        {
+            const __m128d a = _mm_set1_pd(even[t]);
+            value0 = _mm_add_pd(value0, _mm_mul_pd(a, _mm_loadu_pd(x_even + k + t)));
+            value1 = _mm_add_pd(value1, _mm_mul_pd(a, _mm_loadu_pd(x_even + k + t + 2)));
+        }
+        for (int t = 0; t < n_odd; t++)
+        {
+            const __m128d a = _mm_set1_pd(odd[t]);
+            value0 = _mm_add_pd(value0, _mm_mul_pd(a, _mm_loadu_pd(x_odd + k + t)));
+            value1 = _mm_add_pd(value1, _mm_mul_pd(a, _mm_loadu_pd(x_odd + k + t + 2)));
+        }
+        _mm_storeu_pd(out + k, _mm_mul_pd(half, value0));
+        _mm_storeu_pd(out + k + 2, _mm_mul_pd(half, value1));
+    }
+
+    analyze_scalar(filter, x_even, x_odd, k, end, out);
+}
+
+
+/*
+ * 4 coefficients per vector, 2 vectors per iteration
+ */
+__attribute__((target("avx2")))
+void analyze_avx2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    const double* even = filter.even.data();
+    const double* odd = filter.odd.data();
+    const int n_even = (int) filter.even.size();
+    const int n_odd = (int) filter.odd.size();
+    const __m256d half = _mm256_set1_pd(0.5);
+
+    size_t k = begin;
+    for (; k + 8 <= end; k += 8)
+    {
+        __m256d value0 = _mm256_setzero_pd(), value1 = _mm256_setzero_pd();
+        for (int t = 0; t < n_even; t++)
+        {
+            const __m256d a = _mm256_set1_pd(even[t]);
+            value0 = _mm256_add_pd(value0, _mm256_mul_pd(a, _mm256_loadu_pd(x_even + k + t)));
+            value1 = _mm256_add_pd(value1, _mm256_mul_pd(a, _mm256_loadu_pd(x_even + k + t + 4)));
+        }
+        for (int t = 0; t < n_odd; t++)
+        {
+            const __m256d a = _mm256_set1_pd(odd[t]);
+            value0 = _mm256_add_pd(value0, _mm256_mul_pd(a, _mm256_loadu_pd(x_odd + k + t)));
+            value1 = _mm256_add_pd(value1, _mm256_mul_pd(a, _mm256_loadu_pd(x_odd + k + t + 4)));
+        }
+        _mm256_storeu_pd(out + k, _mm256_mul_pd(half, value0));
+        _mm256_storeu_pd(out + k + 4, _mm256_mul_pd(half, value1));
+    }
+
+    analyze_scalar(filter, x_even, x_odd, k, end, out);
+}
+
+
+/*
+ * 8 coefficients per vector, 2 vectors per iteration
+ */
+__attribute__((target("avx512f")))
+void analyze_avx512(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    const double* even = filter.even.data();
+    const double* odd = filter.odd.data();
+    const int n_even = (int) filter.even.size();
+    const int n_odd = (int) filter.odd.size();
+    const __m512d half = _mm512_set1_pd(0.5);
+
+    size_t k = begin;
+    for (; k + 16 <= end; k += 16)
+    {
+        __m512d value0 = _mm512_setzero_pd(), value1 = _mm512_setzero_pd();
+        for (int t = 0; t < n_even; t++)
+        {
+            const __m512d a = _mm512_set1_pd(even[t]);
+            value0 = _mm512_add_pd(value0, _mm512_mul_pd(a, _mm512_loadu_pd(x_even + k + t)));
+            value1 = _mm512_add_pd(value1, _mm512_mul_pd(a, _mm512_loadu_pd(x_even + k + t + 8)));
+        }
+        for (int t = 0; t < n_odd; t++)
+        {
+            const __m512d a = _mm512_set1_pd(odd[t]);
+            value0 = _mm512_add_pd(value0, _mm512_mul_pd(a, _mm512_loadu_pd(x_odd + k + t)));
+            value1 = _mm512_add_pd(value1, _mm512_mul_pd(a, _mm512_loadu_pd(x_odd + k + t + 8)));
+        }
+        _mm512_storeu_pd(out + k, _mm512_mul_pd(half, value0));
+        _mm512_storeu_pd(out + k + 8, _mm512_mul_pd(half, value1));
+    }
+
+    analyze_scalar(filter, x_even, x_odd, k, end, out);
+}
+
+
+/*
+ * 2 values per vector, 2 vectors per iteration
+ */
+__attribute__((target("sse2")))
+void lift_sse2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    const __m128d s = _mm_set1_pd(sign);
+
+    size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+        const __m128d a = _mm_set1_pd(taps[0]);
+        __m128d sum0 = _mm_mul_pd(a, _mm_loadu_pd(x + i));
+        __m128d sum1 = _mm_mul_pd(a, _mm_loadu_pd(x + i + 2));
+        for (int j = 1; j < count; j++)
+        {
+            const __m128d b = _mm_set1_pd(taps[j]);
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(b, _mm_loadu_pd(x + i + j)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(b, _mm_loadu_pd(x + i + j + 2)));
+        }
+        _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(s, sum0)));
+        _mm_storeu_pd(y + i + 2, _mm_add_pd(_mm_loadu_pd(y + i + 2), _mm_mul_pd(s, sum1)));
+    }
+
+    lift_scalar(taps, count, x, y, i, end, sign);
+}
+
+
+/*
+ * 4 values per vector, 2 vectors per iteration
+ */
+__attribute__((target("avx2")))
+void lift_avx2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    const __m256d s = _mm256_set1_pd(sign);
+
+    size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+        const __m256d a = _mm256_set1_pd(taps[0]);
+        __m256d sum0 = _mm256_mul_pd(a, _mm256_loadu_pd(x + i));
+        __m256d sum1 = _mm256_mul_pd(a, _mm256_loadu_pd(x + i + 4));
+        for (int j = 1; j < count; j++)
+        {
+            const __m256d b = _mm256_set1_pd(taps[j]);
+            sum0 = _mm256_add_pd(sum0, _mm256_mul_pd(b, _mm256_loadu_pd(x + i + j)));
+            sum1 = _mm256_add_pd(sum1, _mm256_mul_pd(b, _mm256_loadu_pd(x + i + j + 4)));
+        }
+        _mm256_storeu_pd(y + i, _mm256_add_pd(_mm256_loadu_pd(y + i), _mm256_mul_pd(s, sum0)));
+        _mm256_storeu_pd(y + i + 4, _mm256_add_pd(_mm256_loadu_pd(y + i + 4), _mm256_mul_pd(s, sum1)));
+    }
+
+    lift_scalar(taps, count, x, y, i, end, sign);
+}
+
+
+/*
+ * 8 values per vector, 2 vectors per iteration
+ */
+__attribute__((target("avx512f")))
+void lift_avx512(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    const __m512d s = _mm512_set1_pd(sign);
+
+    size_t i = begin;
+    for (; i + 16 <= end; i += 16)
+    {
+        const __m512d a = _mm512_set1_pd(taps[0]);
+        __m512d sum0 = _mm512_mul_pd(a, _mm512_loadu_pd(x + i));
+        __m512d sum1 = _mm512_mul_pd(a, _mm512_loadu_pd(x + i + 8));
+        for (int j = 1; j < count; j++)
+        {
+            const __m512d b = _mm512_set1_pd(taps[j]);
+            sum0 = _mm512_add_pd(sum0, _mm512_mul_pd(b, _mm512_loadu_pd(x + i + j)));
+            sum1 = _mm512_add_pd(sum1, _mm512_mul_pd(b, _mm512_loadu_pd(x + i + j + 8)));
+        }
+        _mm512_storeu_pd(y + i, _mm512_add_pd(_mm512_loadu_pd(y + i), _mm512_mul_pd(s, sum0)));
+        _mm512_storeu_pd(y + i + 8, _mm512_add_pd(_mm512_loadu_pd(y + i + 8), _mm512_mul_pd(s, sum1)));
+    }
+
+    lift_scalar(taps, count, x, y, i, end, sign);
+}
+
+#else
+
+void analyze_sse2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    analyze_scalar(filter, x_even, x_odd, begin, end, out);
+}
+
+void analyze_avx2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    analyze_scalar(filter, x_even, x_odd, begin, end, out);
+}
+
+void analyze_avx512(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    analyze_scalar(filter, x_even, x_odd, begin, end, out);
+}
+
+void lift_sse2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    lift_scalar(taps, count, x, y, begin, end, sign);
+}
+
+void lift_avx2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    lift_scalar(taps, count, x, y, begin, end, sign);
+}
+
+void lift_avx512(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    lift_scalar(taps, count, x, y, begin, end, sign);
+}
+
+#endif
+
+
+/*
+ * @param isa instruction set supported by the cpu
+ */
+static analysis_kernel_t supported_kernel(isa_t isa)
+{
+    switch (isa)
+    {
+        case isa_sse2:   return analyze_sse2;
+        case isa_avx2:   return analyze_avx2;
+        case isa_avx512: return analyze_avx512;
+        default:         return analyze_scalar;
+    }
+}
+
+
+analysis_kernel_t analysis_kernel(isa_t isa)
+{
+    const isa_t supported = detect_isa();
+
+    return supported_kernel((isa > supported) ? supported : isa);
+}
+
+
+void analyze(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out)
+{
+    supported_kernel(selected_isa())(filter, x_even, x_odd, begin, end, out);
+}
+
+
+void lift(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign)
+{
+    switch (selected_isa())
+    {
+        case isa_sse2:   lift_sse2(taps, count, x, y, begin, end, sign); break;
+        case isa_avx2:   lift_avx2(taps, count, x, y, begin, end, sign); break;
+        case isa_avx512: lift_avx512(taps, count, x, y, begin, end, sign); break;
+        default:         lift_scalar(taps, count, x, y, begin, end, sign);
+    }
+}
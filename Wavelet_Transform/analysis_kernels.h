@@ -0,0 +1,86 @@
+/*
+ * analysis_kernels.h
+ * Decimating convolution and lifting kernels of the wavelet transform.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef TRANSFORM_ANALYSIS_KERNELS_H
+#define TRANSFORM_ANALYSIS_KERNELS_H
+
+#include <cstddef>
+#include <vector>
+#include "filter_banks.h"
+#include "../subdivision/kernels.h"
+
+
+/*
+ * Polyphase form of an analysis filter f with f.first = 2 shift + parity:
+ * sum_i f[i] x[2k + f.first + i] = sum_t even[t] x[2(k+shift+t)]
+ *                                + sum_t odd[t]  x[2(k+shift+t)+1].
+ */
+typedef struct {
+    std::vector<double> even;
+    std::vector<double> odd;
+    int shift;
+}analysis_filter_t;
+
+/*
+ * @param filter dual lowpass or dual highpass filter
+ * @return polyphase form of filter
+ */
+analysis_filter_t analysis_filter(const filter_t& filter);
+
+/*
+ * One level of the forward transform in polyphase form:
+ *   out[k] = 1/2 (sum_t even[t] * x_even[k+t] + sum_t odd[t] * x_odd[k+t])
+ * for begin <= k < end, x_even[i] = x[2i], x_odd[i] = x[2i+1] shifted by
+ * filter.shift.
+ *
+ * All kernels add the even products before the odd ones in the order of t
+ * without fused multiply-add, so they agree bit for bit with
+ * analyze_scalar().
+ */
+typedef void (*analysis_kernel_t)(const analysis_filter_t& filter, const double* x_even, const double* x_odd,
+                                  size_t begin, size_t end, double* out);
+
+void analyze_scalar(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out);
+void analyze_sse2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out);
+void analyze_avx2(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out);
+void analyze_avx512(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out);
+
+/*
+ * @param isa instruction set, reduced to detect_isa() if not supported
+ * @return kernel for isa
+ */
+analysis_kernel_t analysis_kernel(isa_t isa);
+
+/*
+ * dispatching kernel, uses the instruction set selected for refine() by
+ * select_isa(), so one choice covers both directions of the transform
+ */
+void analyze(const analysis_filter_t& filter, const double* x_even, const double* x_odd, size_t begin, size_t end, double* out);
+
+/*
+ * One lifting step on the even or odd samples of a block:
+ *   y[i] += sign * sum_j taps[j] * x[i+j]   for begin <= i < end.
+ * The sum runs in the order of j without fused multiply-add and is added
+ * with its sign, so all kernels agree bit for bit with lift_scalar() and
+ * the inverse step with sign -1 restores y exactly if x is unchanged.
+ */
+typedef void (*lifting_kernel_t)(const double* taps, int count, const double* x, double* y,
+                                 size_t begin, size_t end, double sign);
+
+void lift_scalar(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign);
+void lift_sse2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign);
+void lift_avx2(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign);
+void lift_avx512(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign);
+
+/* dispatching lifting kernel for the instruction set of select_isa() */
+void lift(const double* taps, int count, const double* x, double* y, size_t begin, size_t end, double sign);
+
+#endif /* TRANSFORM_ANALYSIS_KERNELS_H */
@@ -0,0 +1,612 @@
+/*
+ * dwt.cpp
+ * Multi-level discrete wavelet transform of 1D signals.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <algorithm>
+#include "dwt.h"
+
+using namespace std;
+
+
+const char* boundary_name(boundary_t boundary)
+{
+    return (boundary == boundary_periodic) ? "periodic" : "symmetric";
+}
+
+
+bool parse_boundary(const string& name, boundary_t& boundary)
+{
+    if (name == "periodic")  { boundary = boundary_periodic; return true; }
+    if (name == "symmetric") { boundary = boundary_symmetric; return true; }
+    return false;
+}
+
+
+const char* path_name(transform_path_t path)
+{
+    switch (path)
+    {
+    case path_lifting:         return "lifting";
+    case path_integer_lifting: return "integer lifting";
+    default:                   return "convolution";
+    }
+}
+
+
+/*
+ * floor(a / 2) for negative a as well
+ */
+static int64_t floor_half(int64_t a)
+{
+    return (a >= 0) ? a / 2 : -((1 - a) / 2);
+}
+
+/*
+ * @return u mod n in [0, n)
+ */
+static int64_t positive_mod(int64_t u, int64_t n)
+{
+    const int64_t r = u % n;
+    return (r < 0) ? r + n : r;
+}
+
+/*
+ * @param mask filter as refinement mask
+ */
+static polyphase_t filter_polyphase(const filter_t& filter)
+{
+    const mask_t mask = {filter.taps.data(), (int) filter.taps.size(), ""};
+    return polyphase(mask);
+}
+
+
+/*
+ * Run the lifting steps on s and d in place, forward or backwards with the
+ * opposite sign. Every step leaves fewer valid values: starting from
+ * [0, length), the valid range shrinks by lifting_left and lifting_right.
+ * @param integer round every step to an integer
+ */
+static void run_lifting(const lifting_t& lifting, double* s, double* d, size_t length, bool inverse, bool integer)
+{
+    const size_t steps = lifting.steps.size();
+    const double sign = inverse ? -1.0 : 1.0;
+    int64_t valid_begin = 0, valid_end = (int64_t) length;
+
+    for (size_t t = 0; t < steps; t++)
+    {
+        const lifting_step_t& step = lifting.steps[inverse ? steps - 1 - t : t];
+        double* y = step.update ? s : d;
+        const double* x = (step.update ? d : s) + step.first;
+        const double* taps = step.taps.data();
+        const int count = (int) step.taps.size();
+        valid_begin += max(0, -step.first);
+        valid_end -= max(0, step.first + count - 1);
+
+        if (!integer)
+        {
+            lift(taps, count, x, y, (size_t) valid_begin, (size_t) valid_end, sign);
+            continue;
+        }
+        for (int64_t i = valid_begin; i < valid_end; i++)
+        {
+            double sum = taps[0] * x[i];
+            for (int j = 1; j < count; j++) { sum += taps[j] * x[i + j]; }
+            y[i] += sign * floor(sum + 0.5);
+        }
+    }
+}
+
+
+/*
+ * Samples of the signal of one level: the first head_length samples in head,
+ * the others in window[r - window_first]. sample(u) extends the signal
+ * periodically or symmetrically beyond [0, length).
+ */
+struct WaveletTransform::level_source_t
+{
+    const double* head;
+    size_t head_length;
+    const double* window;
+    size_t window_first;
+    size_t length;
+    int64_t first;      /* shift k of the first coefficient */
+    boundary_t boundary;
+
+    double sample(int64_t u) const
+    {
+        const int64_t n = (int64_t) length;
+        if (u < 0 || u >= n)
+        {
+            if (boundary == boundary_periodic)
+            {
+                u = positive_mod(u, n);
+            }
+            else
+            {
+                u = positive_mod(u, 2*n);
+                if (u >= n) { u = 2*n - 1 - u; }
+            }
+        }
+        return ((size_t) u < head_length) ? head[u] : window[u - window_first];
+    }
+};
+
+
+WaveletTransform::WaveletTransform(const filter_bank_t& bank, boundary_t boundary) :
+    bank(bank),
+    extension(boundary),
+    dual_lowpass(analysis_filter(bank.dual_lowpass)),
+    dual_highpass(analysis_filter(bank.dual_highpass)),
+    lowpass(filter_polyphase(bank.lowpass)),
+    highpass(filter_polyphase(bank.highpass)),
+    selected(path_convolution),
+    lifting_left(0),
+    lifting_right(0)
+{
+    synthesis_first = min(bank.lowpass.first, bank.highpass.first);
+    synthesis_last = max(bank.lowpass.first + (int) bank.lowpass.taps.size(),
+                         bank.highpass.first + (int) bank.highpass.taps.size()) - 1;
+
+    phase_first = min(dual_lowpass.shift, dual_highpass.shift);
+    phase_last = max(dual_lowpass.shift + (int) max(dual_lowpass.even.size(), dual_lowpass.odd.size()),
+                     dual_highpass.shift + (int) max(dual_highpass.even.size(), dual_highpass.odd.size())) - 1;
+
+    /* the lifting steps read the pairs x[2i], x[2i+1] of every block farther out */
+    factored = factor_lifting(bank, factorization);
+    if (factored)
+    {
+        for (const lifting_step_t& step : factorization.steps)
+        {
+            lifting_left += max(0, -step.first);
+            lifting_right += max(0, step.first + (int) step.taps.size() - 1);
+        }
+        const int a = factorization.scaling_shift, b = factorization.detail_shift;
+        phase_first = min(phase_first, min(a, b) - lifting_left - max(0, factorization.offset));
+        phase_last = max(phase_last, max(a, b) + lifting_right + max(0, -factorization.offset));
+    }
+}
+
+
+bool WaveletTransform::select_path(transform_path_t path)
+{
+    if (path != path_convolution && !factored) { return false; }
+    if (path == path_integer_lifting && extension != boundary_periodic) { return false; }
+
+    selected = path;
+    return true;
+}
+
+
+bool WaveletTransform::plan(size_t n, int levels, vector<level_layout_t>& layout) const
+{
+    layout.assign(max(levels, 0), level_layout_t());
+    if (n == 0 || levels < 1) { return false; }
+
+    size_t length = n;
+    for (int j = 0; j < levels; j++)
+    {
+        level_layout_t& level = layout[j];
+        level.signal_length = length;
+        if (extension == boundary_periodic)
+        {
+            if (length % 2 != 0) { return false; }
+            level.first = 0;
+            level.band_length = length / 2;
+        }
+        else
+        {
+            /* coefficients whose synthesis functions reach [0, length) */
+            level.first = -floor_half(synthesis_last);
+            const int64_t last = floor_half((int64_t) length - 1 - synthesis_first);
+            level.band_length = (size_t) (last - level.first + 1);
+        }
+        length = level.band_length;
+    }
+
+    /* [c_L, d_L, d_{L-1}, ..., d_1] */
+    size_t offset = layout[levels - 1].band_length;
+    for (int j = levels - 1; j >= 0; j--)
+    {
+        layout[j].detail_offset = offset;
+        offset += layout[j].band_length;
+    }
+
+    return true;
+}
+
+
+size_t WaveletTransform::coefficient_count(size_t n, int levels) const
+{
+    vector<level_layout_t> layout;
+    if (!plan(n, levels, layout)) { return 0; }
+
+    return layout[0].detail_offset + layout[0].band_length;
+}
+
+
+size_t WaveletTransform::head_length(const level_layout_t& level) const
+{
+    /*
+     * The first block reads samples down to 2 (first + phase_first), the
+     * periodic extension at the end up to 2 phase_last + 1 samples of the
+     * front. c_j[k] overwrites c_{j-1} only behind these samples, while
+     * short signals are kept completely.
+     */
+    const int64_t front = max((int64_t) 0, -2*(level.first + phase_first)) + 2*(phase_last + 2);
+    const int64_t span = 2*(phase_last - phase_first + 2) + (synthesis_last - synthesis_first + 2);
+    const size_t n = level.signal_length;
+
+    return ((int64_t) n <= 2*(front + span)) ? n : (size_t) front;
+}
+
+
+void WaveletTransform::analyze_level(const level_source_t& source, size_t begin, size_t end, double* scaling, double* detail,
+                                     vector<double>& x_even, vector<double>& x_odd) const
+{
+    if (selected != path_convolution)
+    {
+        lift_level(source, begin, end, scaling, detail, x_even, x_odd);
+        return;
+    }
+
+    const int64_t n = (int64_t) source.length;
+    const int phases = phase_last - phase_first + 1;
+
+    for (size_t block = begin; block < end; block += block_size)
+    {
+        const size_t count = min(block_size, end - block);
+        const int64_t j0 = source.first + (int64_t) block + phase_first;
+        const size_t samples = count + phases - 1;
+        if (x_even.size() < samples)
+        {
+            x_even.resize(samples);
+            x_odd.resize(samples);
+        }
+
+        /* x_even[i] = x(2 (j0 + i)), x_odd[i] = x(2 (j0 + i) + 1) */
+        const int64_t u0 = 2*j0, u1 = 2*(j0 + (int64_t) samples);
+        if (u0 >= (int64_t) source.head_length && u1 <= n)
+        {
+            const double* x = source.window + (u0 - (int64_t) source.window_first);
+            for (size_t i = 0; i < samples; i++)
+            {
+                x_even[i] = x[2*i];
+                x_odd[i] = x[2*i+1];
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < samples; i++)
+            {
+                x_even[i] = source.sample(u0 + 2*(int64_t) i);
+                x_odd[i] = source.sample(u0 + 2*(int64_t) i + 1);
+            }
+        }
+
+        const size_t low = dual_lowpass.shift - phase_first, high = dual_highpass.shift - phase_first;
+        analyze(dual_lowpass, x_even.data() + low, x_odd.data() + low, 0, count, scaling + (block - begin));
+        analyze(dual_highpass, x_even.data() + high, x_odd.data() + high, 0, count, detail + (block - begin));
+    }
+}
+
+
+void WaveletTransform::lift_level(const level_source_t& source, size_t begin, size_t end, double* scaling, double* detail,
+                                  vector<double>& s, vector<double>& d) const
+{
+    const lifting_t& L = factorization;
+    const bool integer = (selected == path_integer_lifting);
+    const int64_t n = (int64_t) source.length;
+    const int a = L.scaling_shift, b = L.detail_shift;
+    const int parity = L.parity, offset = L.offset;
+    const double K1 = L.scaling, K2 = L.detail_scaling;
+
+    for (size_t block = begin; block < end; block += block_size)
+    {
+        const size_t count = min(block_size, end - block);
+        const int64_t k0 = source.first + (int64_t) block;
+        const int64_t lo = k0 + min(a, b) - lifting_left;
+        const size_t length = count + (max(a, b) - min(a, b)) + lifting_left + lifting_right;
+        if (s.size() < length)
+        {
+            s.resize(length);
+            d.resize(length);
+        }
+
+        /*
+         * s[i] = x(2 (lo + i) + parity), d[i] = x(2 (lo + i - offset) + 1 - parity),
+         * read from the window for i in [fast_begin, fast_end), extended elsewhere
+         */
+        const int64_t us = 2*lo + parity, ud = 2*(lo - offset) + 1 - parity;
+        const int64_t low = min(us, ud), high = max(us, ud);
+        const int64_t fast_begin = min((int64_t) length, max((int64_t) 0, ((int64_t) source.head_length - low + 1) / 2));
+        const int64_t fast_end = max(fast_begin, min((int64_t) length, floor_half(n - 1 - high) + 1));
+        for (int64_t i = 0; i < fast_begin; i++)
+        {
+            s[i] = source.sample(us + 2*i);
+            d[i] = source.sample(ud + 2*i);
+        }
+        if (fast_begin < fast_end)
+        {
+            const double* xs = source.window + (us - (int64_t) source.window_first);
+            const double* xd = source.window + (ud - (int64_t) source.window_first);
+            for (int64_t i = fast_begin; i < fast_end; i++)
+            {
+                s[i] = xs[2*i];
+                d[i] = xd[2*i];
+            }
+        }
+        for (int64_t i = fast_end; i < (int64_t) length; i++)
+        {
+            s[i] = source.sample(us + 2*i);
+            d[i] = source.sample(ud + 2*i);
+        }
+
+        run_lifting(L, s.data(), d.data(), length, false, integer);
+
+        /* c[k] = K1 s[k + a], d[k] = K2 d[k + b], + 0.0 turns -0 into 0 like the kernels */
+        const double* cs = s.data() + (k0 + a - lo);
+        const double* ds = d.data() + (k0 + b - lo);
+        double* c = scaling + (block - begin);
+        double* e = detail + (block - begin);
+        if (integer)
+        {
+            copy(cs, cs + count, c);
+            copy(ds, ds + count, e);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                c[i] = K1 * cs[i] + 0.0;
+                e[i] = K2 * ds[i] + 0.0;
+            }
+        }
+    }
+}
+
+
+bool WaveletTransform::forward(double* data, size_t n, int levels) const
+{
+    vector<level_layout_t> layout;
+    if (!plan(n, levels, layout)) { return false; }
+
+    size_t bands = 0;
+    for (int j = 0; j < levels; j++) { bands = max(bands, layout[j].band_length); }
+
+    vector<double> head, detail(bands), x_even, x_odd;
+    for (int j = 0; j < levels; j++)
+    {
+        const level_layout_t& level = layout[j];
+        head.assign(data, data + head_length(level));
+
+        const level_source_t source = {head.data(), head.size(), data, 0, level.signal_length, level.first, extension};
+        analyze_level(source, 0, level.band_length, data, detail.data(), x_even, x_odd);
+        copy(detail.begin(), detail.begin() + level.band_length, data + level.detail_offset);
+    }
+
+    return true;
+}
+
+
+void WaveletTransform::synthesize_level(const level_layout_t& level, const double* scaling, const double* detail, double* out) const
+{
+    const int64_t n = (int64_t) level.signal_length, m = (int64_t) level.band_length;
+    const int64_t padding = max(lowpass.padding, highpass.padding);
+
+    /* out[u] = fine_h[u + shift_h] + fine_g[u + shift_g], fine = refine(c) */
+    int64_t shift_h = -2*level.first - bank.lowpass.first;
+    int64_t shift_g = -2*level.first - bank.highpass.first;
+    if (extension == boundary_periodic)
+    {
+        shift_h = positive_mod(shift_h, n);
+        shift_g = positive_mod(shift_g, n);
+    }
+    const int64_t coarse_end = (n - 1 + max(shift_h, shift_g)) / 2 + 1;
+
+    /* coarse[-padding..coarse_end), zero or periodic beyond the band */
+    vector<double> c(padding + coarse_end, 0.0), d(padding + coarse_end, 0.0);
+    for (int64_t i = -padding; i < coarse_end; i++)
+    {
+        if (extension == boundary_periodic)
+        {
+            c[padding + i] = scaling[positive_mod(i, m)];
+            d[padding + i] = detail[positive_mod(i, m)];
+        }
+        else if (i >= 0 && i < m)
+        {
+            c[padding + i] = scaling[i];
+            d[padding + i] = detail[i];
+        }
+    }
+
+    vector<double> fine_h(2*block_size + 2), fine_g(2*block_size + 2);
+    for (int64_t u0 = 0; u0 < n; u0 += 2*block_size)
+    {
+        const int64_t u1 = min(n, u0 + 2*(int64_t) block_size);
+        const int64_t begin_h = (u0 + shift_h) / 2, end_h = (u1 - 1 + shift_h) / 2 + 1;
+        const int64_t begin_g = (u0 + shift_g) / 2, end_g = (u1 - 1 + shift_g) / 2 + 1;
+        refine(lowpass, c.data() + padding + begin_h, 0, end_h - begin_h, fine_h.data());
+        refine(highpass, d.data() + padding + begin_g, 0, end_g - begin_g, fine_g.data());
+
+        const double* h = fine_h.data() + (u0 + shift_h - 2*begin_h);
+        const double* g = fine_g.data() + (u0 + shift_g - 2*begin_g);
+        for (int64_t u = u0; u < u1; u++)
+        {
+            out[u] = h[u - u0] + g[u - u0];
+        }
+    }
+}
+
+
+void WaveletTransform::unlift_level(const level_layout_t& level, const double* scaling, const double* detail, double* out) const
+{
+    const lifting_t& L = factorization;
+    const bool integer = (selected == path_integer_lifting);
+    const int64_t n = (int64_t) level.signal_length, m = (int64_t) level.band_length;
+    const int a = L.scaling_shift, b = L.detail_shift;
+    const int parity = L.parity, offset = L.offset;
+
+    /* c[k] and d[k] of all k, zero or periodic beyond the band */
+    const vector<double> c(scaling, scaling + m), e(detail, detail + m);
+    const auto coefficient = [&](const vector<double>& band, int64_t k)
+    {
+        const int64_t i = k - level.first;
+        if (extension == boundary_periodic) { return band[positive_mod(i, m)]; }
+        return (i >= 0 && i < m) ? band[i] : 0.0;
+    };
+
+    vector<double> s, d;
+    for (int64_t u0 = 0; u0 < n; u0 += 2*block_size)
+    {
+        const int64_t u1 = min(n, u0 + 2*(int64_t) block_size);
+
+        /* pairs j whose s[j] or d[j] land in [u0, u1) */
+        const int64_t j0 = floor_half(u0) - 1 + min(0, offset), j1 = floor_half(u1) + 1 + max(0, offset);
+        const int64_t lo = j0 - lifting_left, length = j1 + lifting_right - lo;
+        s.resize(length);
+        d.resize(length);
+        for (int64_t i = 0; i < length; i++)
+        {
+            s[i] = coefficient(c, lo + i - a);
+            d[i] = coefficient(e, lo + i - b);
+            if (!integer)
+            {
+                s[i] /= L.scaling;
+                d[i] /= L.detail_scaling;
+            }
+        }
+
+        run_lifting(L, s.data(), d.data(), length, true, integer);
+
+        for (int64_t j = j0; j < j1; j++)
+        {
+            const int64_t us = 2*j + parity, ud = 2*(j - offset) + 1 - parity;
+            if (us >= u0 && us < u1) { out[us] = s[j - lo]; }
+            if (ud >= u0 && ud < u1) { out[ud] = d[j - lo]; }
+        }
+    }
+}
+
+
+bool WaveletTransform::inverse(double* data, size_t n, int levels) const
+{
+    vector<level_layout_t> layout;
+    if (!plan(n, levels, layout)) { return false; }
+
+    for (int j = levels - 1; j >= 0; j--)
+    {
+        if (selected == path_convolution) { synthesize_level(layout[j], data, data + layout[j].detail_offset, data); }
+        else                              { unlift_level(layout[j], data, data + layout[j].detail_offset, data); }
+    }
+
+    return true;
+}
+
+
+
+StreamingTransform::StreamingTransform(const filter_bank_t& bank) :
+    transform(bank, boundary_symmetric),
+    failed(false)
+{
+}
+
+
+bool StreamingTransform::start(size_t n, int levels, coefficient_consumer_t consumer)
+{
+    this->consumer = consumer;
+    failed = !transform.plan(n, levels, this->levels);
+    states.assign(failed ? 0 : levels, level_state_t());
+    for (size_t j = 0; j < states.size(); j++)
+    {
+        states[j].window_first = 0;
+        states[j].received = 0;
+        states[j].next = 0;
+        states[j].scaling.resize(WaveletTransform::block_size);
+        states[j].detail.resize(WaveletTransform::block_size);
+    }
+
+    return !failed;
+}
+
+
+bool StreamingTransform::push(const double* x, size_t count)
+{
+    if (failed || states.empty()) { return false; }
+
+    failed = !push_level(0, x, count);
+    return !failed;
+}
+
+
+bool StreamingTransform::push_level(int j, const double* x, size_t count)
+{
+    const level_layout_t& level = levels[j];
+    level_state_t& state = states[j];
+    const size_t n = level.signal_length, m = level.band_length;
+    if (state.received + count > n) { return false; }
+
+    const size_t head = transform.head_length(level);
+    if (state.head.size() < head)
+    {
+        state.head.insert(state.head.end(), x, x + min(count, head - state.head.size()));
+    }
+    state.window.insert(state.window.end(), x, x + count);
+    state.received += count;
+    if (state.received < head) { return true; }
+
+    /* coefficients whose samples have all arrived */
+    size_t ready = m;
+    if (state.received < n)
+    {
+        const int64_t last = floor_half((int64_t) state.received - 2) - level.first - transform.phase_last;
+        ready = (size_t) max((int64_t) state.next, min((int64_t) m, last + 1));
+    }
+
+    while (state.next < ready)
+    {
+        const size_t begin = state.next, end = min(ready, begin + WaveletTransform::block_size);
+        const WaveletTransform::level_source_t source = {state.head.data(), state.head.size(), state.window.data(),
+                                                         state.window_first, n, level.first, boundary_symmetric};
+        transform.analyze_level(source, begin, end, state.scaling.data(), state.detail.data(), x_even, x_odd);
+        state.next = end;
+
+        if (!consumer(j + 1, true, begin, state.detail.data(), end - begin)) { return false; }
+        const bool passed = (j + 1 == (int) levels.size())
+            ? consumer(j + 1, false, begin, state.scaling.data(), end - begin)
+            : push_level(j + 1, state.scaling.data(), end - begin);
+        if (!passed) { return false; }
+    }
+
+    /* drop the samples no block reads any more, keep the end for the extension */
+    const int64_t tail = 2*(level.first + (int64_t) m + transform.phase_last + 1) - (int64_t) n;
+    const int64_t keep = max((int64_t) 0, min(2*(level.first + (int64_t) state.next + transform.phase_first),
+                                              (int64_t) n - max(tail, (int64_t) 0)));
+    if ((size_t) keep > state.window_first + state.window.size() / 2)
+    {
+        const size_t drop = min((size_t) keep - state.window_first, state.window.size());
+        state.window.erase(state.window.begin(), state.window.begin() + drop);
+        state.window_first += drop;
+    }
+
+    return true;
+}
+
+
+bool StreamingTransform::finish()
+{
+    bool complete = !failed && !states.empty();
+    for (size_t j = 0; complete && j < states.size(); j++)
+    {
+        complete = states[j].next == levels[j].band_length;
+    }
+
+    return complete;
+}
@@ -0,0 +1,228 @@
+/*
+ * dwt.h
+ * Multi-level discrete wavelet transform of 1D signals.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef TRANSFORM_DWT_H
+#define TRANSFORM_DWT_H
+
+#include <cstddef>
+#include <functional>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "filter_banks.h"
+#include "analysis_kernels.h"
+#include "lifting.h"
+#include "../subdivision/kernels.h"
+
+
+/*
+ * extension of the signal beyond its ends
+ */
+typedef enum {
+    boundary_periodic = 0,  /* x[u + n] = x[u], n/2 coefficients per band */
+    boundary_symmetric      /* half sample symmetric, x[-1-u] = x[u] = x[2n-1-u],
+                               (n + synthesis support) / 2 coefficients per band */
+}boundary_t;
+
+/* @return "periodic" or "symmetric" */
+const char* boundary_name(boundary_t boundary);
+
+/* @return false if name is no boundary */
+bool parse_boundary(const std::string& name, boundary_t& boundary);
+
+/*
+ * computation of the transform
+ */
+typedef enum {
+    path_convolution = 0,  /* analysis and refinement kernels of the filters */
+    path_lifting,          /* lifting steps of factor_lifting() */
+    path_integer_lifting   /* lifting steps rounded to integers without the scaling,
+                              invertible on integer signals, periodic extension */
+}transform_path_t;
+
+/* @return "convolution", "lifting" or "integer lifting" */
+const char* path_name(transform_path_t path);
+
+/*
+ * sizes of level j = 1, 2, ... of the transform
+ */
+typedef struct {
+    size_t signal_length;  /* length of c_{j-1}, the signal for j = 1 */
+    size_t band_length;    /* number of coefficients of c_j and of d_j */
+    int64_t first;         /* shift k of c_j[0] and d_j[0] */
+    size_t detail_offset;  /* position of d_j in the coefficient array */
+}level_layout_t;
+
+
+/*
+ * Forward and inverse transform of a signal x of length n over L levels
+ * with the coefficients in the order [c_L, d_L, d_{L-1}, ..., d_1].
+ *
+ * Every level works in place on the front of the coefficient array: the
+ * analysis kernels read blocks of the even and odd samples of c_{j-1} and
+ * write c_j over c_{j-1}, d_j goes through a scratch band of the level. The
+ * synthesis uses the refinement kernels of the cascade algorithm for both
+ * filters. All instruction sets selected by select_isa() give the same
+ * coefficients bit for bit.
+ *
+ * The lifting path works on blocks of the even and odd samples in place,
+ * one lifting step after the other. Its coefficients differ from those of
+ * the convolution by rounding only, and are the same bit for bit on integer
+ * signals if all numbers of the factorization are dyadic.
+ */
+class WaveletTransform
+{
+public:
+    WaveletTransform(const filter_bank_t& bank, boundary_t boundary);
+
+    const filter_bank_t& filter_bank() const { return bank; }
+    boundary_t boundary() const { return extension; }
+
+    /* lifting factorization of the filter bank, valid if has_lifting() */
+    bool has_lifting() const { return factored; }
+    const lifting_t& lifting() const { return factorization; }
+
+    /*
+     * @param path computation of forward() and inverse()
+     * @return false if the filter bank has no lifting factorization, or
+     *         integer lifting is selected with symmetric extension
+     */
+    bool select_path(transform_path_t path);
+    transform_path_t path() const { return selected; }
+
+    /*
+     * @param n signal length
+     * @param levels L >= 1
+     * @param layout sizes of the levels 1, ..., L
+     * @return false if n is zero, or not divisible by 2^L for periodic
+     *         extension
+     */
+    bool plan(size_t n, int levels, std::vector<level_layout_t>& layout) const;
+
+    /* @return number of coefficients of plan(n, levels), 0 if impossible */
+    size_t coefficient_count(size_t n, int levels) const;
+
+    /*
+     * @param data signal in data[0..n), room for coefficient_count(n, levels)
+     *        values, which receive the coefficients
+     * @return false if plan() fails
+     */
+    bool forward(double* data, size_t n, int levels) const;
+
+    /*
+     * @param data coefficients of forward(), the signal in data[0..n)
+     * @return false if plan() fails
+     */
+    bool inverse(double* data, size_t n, int levels) const;
+
+    /* coefficients computed per call of the analysis kernels */
+    static const size_t block_size = 2048;
+
+private:
+    friend class StreamingTransform;
+
+    /* samples of one level, see dwt.cpp */
+    struct level_source_t;
+
+    /* analysis of the coefficients [begin, end) into scaling[0..), detail[0..) */
+    void analyze_level(const level_source_t& source, size_t begin, size_t end, double* scaling, double* detail,
+                       std::vector<double>& x_even, std::vector<double>& x_odd) const;
+
+    /* analyze_level() by the lifting steps, s and d as scratch */
+    void lift_level(const level_source_t& source, size_t begin, size_t end, double* scaling, double* detail,
+                    std::vector<double>& s, std::vector<double>& d) const;
+
+    /* number of first samples of a level kept for the extension */
+    size_t head_length(const level_layout_t& level) const;
+
+    /* synthesis of c_{j-1} from c_j and d_j */
+    void synthesize_level(const level_layout_t& level, const double* scaling, const double* detail, double* out) const;
+
+    /* synthesize_level() by the lifting steps */
+    void unlift_level(const level_layout_t& level, const double* scaling, const double* detail, double* out) const;
+
+    filter_bank_t bank;
+    boundary_t extension;
+    analysis_filter_t dual_lowpass, dual_highpass;
+    polyphase_t lowpass, highpass;
+    int synthesis_first, synthesis_last; /* union of the supports of h and g */
+    int phase_first, phase_last;         /* even/odd samples read by c[k], d[k] relative to k */
+    lifting_t factorization;
+    bool factored;
+    transform_path_t selected;
+    int lifting_left, lifting_right;     /* samples consumed by the steps at both ends of a block */
+};
+
+
+/*
+ * consumer of streamed coefficients: values of band c_j (detail false, only
+ * j = L) or d_j, starting at position first of the band
+ * @return false to stop the transform
+ */
+typedef std::function<bool(int level, bool detail, size_t first, const double* values, size_t count)> coefficient_consumer_t;
+
+/*
+ * Forward transform with symmetric extension of a signal which is passed
+ * in pieces of any size and never held in memory, so the signal may be
+ * larger than the memory. Every level keeps the samples read by its next
+ * block and the first and last few samples for the extension. The
+ * coefficients are the same bit for bit as those of WaveletTransform.
+ */
+class StreamingTransform
+{
+public:
+    explicit StreamingTransform(const filter_bank_t& bank);
+
+    /*
+     * @param n signal length, needed for the extension at the end
+     * @param levels L >= 1
+     * @param consumer receives the coefficients in increasing order per band
+     * @return false if plan() fails
+     */
+    bool start(size_t n, int levels, coefficient_consumer_t consumer);
+
+    /* @return false if the path is not available, see WaveletTransform */
+    bool select_path(transform_path_t path) { return transform.select_path(path); }
+
+    /* sizes of the levels after start() */
+    const std::vector<level_layout_t>& layout() const { return levels; }
+
+    /*
+     * @param x next count samples of the signal
+     * @return false if the consumer stopped or more than n samples arrive
+     */
+    bool push(const double* x, size_t count);
+
+    /* @return false if fewer than n samples were pushed or the consumer stopped */
+    bool finish();
+
+private:
+    struct level_state_t
+    {
+        std::vector<double> head;   /* first samples of the level */
+        std::vector<double> window; /* samples window_first, ... */
+        size_t window_first;
+        size_t received;
+        size_t next;                /* next coefficient to compute */
+        std::vector<double> scaling, detail;
+    };
+
+    bool push_level(int j, const double* x, size_t count);
+
+    WaveletTransform transform;
+    std::vector<level_layout_t> levels;
+    std::vector<level_state_t> states;
+    std::vector<double> x_even, x_odd;
+    coefficient_consumer_t consumer;
+    bool failed;
+};
+
+#endif /* TRANSFORM_DWT_H */
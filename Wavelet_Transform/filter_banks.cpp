@@ -0,0 +1,233 @@
+/*
+ * filter_banks.cpp
+ * Biorthogonal filter banks of the implemented wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstdio>
+#include <math.h>
+#include "filter_banks.h"
+#include "../subdivision/masks.h"
+#include "../Visualize_Spline_Wavelets/spline_wavelets.h"
+
+using namespace std;
+
+
+const char* const builtin_filter_banks[] = {
+    "Haar",
+    "Daubechies_2",
+    "CDF_1_3",
+    "CDF_2_2",
+    "CDF_2_4",
+    "CDF_3_3",
+    "CDF_3_5",
+    "CDF_4_2",
+    "CDF_4_4",
+    "CDF_4_6"
+};
+
+const int builtin_filter_bank_count = sizeof(builtin_filter_banks) / sizeof(builtin_filter_banks[0]);
+
+
+/* relative tolerance of the biorthogonality relations */
+static const double biorthogonality_tolerance = 1e-12;
+
+
+/*
+ * @return sum_n f[n] g[n-2k]
+ */
+static double correlation(const filter_t& f, const filter_t& g, int k)
+{
+    double sum = 0.0;
+    for (size_t i = 0; i < f.taps.size(); i++)
+    {
+        const int j = f.first + (int) i - 2*k - g.first;
+        if (j >= 0 && j < (int) g.taps.size())
+        {
+            sum += f.taps[i] * g.taps[j];
+        }
+    }
+
+    return sum;
+}
+
+/*
+ * @return largest deviation of sum_n f[n] g[n-2k] from value * delta_k
+ */
+static double biorthogonality_error(const filter_t& f, const filter_t& g, double value)
+{
+    /* f[n] g[n-2k] vanishes outside of this range of k */
+    const int k_low = (f.first - g.first - (int) g.taps.size()) / 2 - 1;
+    const int k_high = (f.first + (int) f.taps.size() - g.first) / 2 + 1;
+
+    double error = 0.0;
+    for (int k = k_low; k <= k_high; k++)
+    {
+        error = fmax(error, fabs(correlation(f, g, k) - ((k == 0) ? value : 0.0)));
+    }
+
+    return error;
+}
+
+/*
+ * @return filter f~[n] = (-1)^n f[1-n]
+ */
+static filter_t modulate(const filter_t& f)
+{
+    const int n = (int) f.taps.size();
+    filter_t result;
+    result.first = 2 - f.first - n;
+    result.taps.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        const int index = result.first + i;
+        const double tap = f.taps[n - 1 - i]; /* f[1-index] */
+        result.taps[i] = (index % 2 == 0) ? tap : -tap;
+    }
+
+    return result;
+}
+
+
+bool biorthogonal_bank(const string& name, const filter_t& lowpass, const filter_t& dual_lowpass, filter_bank_t& bank)
+{
+    if (lowpass.taps.empty() || dual_lowpass.taps.empty()) { return false; }
+
+    const int lh = (int) lowpass.taps.size(), ld = (int) dual_lowpass.taps.size();
+    filter_t shifted = dual_lowpass;
+
+    /* every shift with overlapping supports */
+    for (int first = lowpass.first - ld + 1; first < lowpass.first + lh; first++)
+    {
+        shifted.first = first;
+        if (biorthogonality_error(lowpass, shifted, 2.0) <= biorthogonality_tolerance * 2.0)
+        {
+            bank.name = name;
+            bank.lowpass = lowpass;
+            bank.dual_lowpass = shifted;
+            bank.highpass = modulate(shifted);
+            bank.dual_highpass = modulate(lowpass);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+/*
+ * @param mask refinement mask of subdivision/masks.cpp
+ * @return mask as filter starting at 0
+ */
+static filter_t mask_filter(const mask_t& mask)
+{
+    filter_t f;
+    f.taps.assign(mask.entry, mask.entry + mask.length);
+    f.first = 0;
+    return f;
+}
+
+/*
+ * @param name mask name in subdivision/masks.cpp
+ * @return mask or NULL
+ */
+static const mask_t* find_mask(const string& name)
+{
+    for (int i = 0; i < builtin_mask_count; i++)
+    {
+        if (builtin_masks[i].name == name) { return &builtin_masks[i]; }
+    }
+    return NULL;
+}
+
+
+bool select_filter_bank(const string& name, filter_bank_t& bank)
+{
+    if (name == "Haar" || name == "Daubechies_2")
+    {
+        const mask_t* mask = find_mask(name);
+        return mask != NULL && biorthogonal_bank(name, mask_filter(*mask), mask_filter(*mask), bank);
+    }
+
+    int m = 0, mt = 0;
+    char tail = 0;
+    if (sscanf(name.c_str(), "CDF_%d_%d%c", &m, &mt, &tail) != 2 || (m + mt) % 2 != 0)
+    {
+        return false;
+    }
+
+    const psi_t* psi = select_psi(m, mt);
+    if (psi == NULL) { return false; }
+
+    /* h[l] = 2^(1-m) binom(m, l) */
+    filter_t lowpass;
+    lowpass.first = 0;
+    lowpass.taps.resize(m + 1);
+    double binomial = 1.0;
+    for (int l = 0; l <= m; l++)
+    {
+        lowpass.taps[l] = ldexp(binomial, 1 - m);
+        binomial = binomial * (m - l) / (l + 1);
+    }
+
+    /* mask[i] = (-1)^(mask_start+i) dual[length-1-i], see construct_psi() */
+    const int length = psi->mask_end - psi->mask_start + 1;
+    filter_t dual;
+    dual.first = 0;
+    dual.taps.resize(length);
+    for (int j = 0; j < length; j++)
+    {
+        const double entry = psi->mask[length - 1 - j];
+        dual.taps[j] = ((psi->mask_start + length - 1 - j) % 2 == 0) ? entry : -entry;
+    }
+
+    return biorthogonal_bank(name, lowpass, dual, bank);
+}
+
+
+bool verify_filter_bank(const filter_bank_t& bank, ostream* log)
+{
+    const double tolerance = biorthogonality_tolerance * 2.0;
+    const double errors[4] = {
+        biorthogonality_error(bank.lowpass, bank.dual_lowpass, 2.0),
+        biorthogonality_error(bank.highpass, bank.dual_highpass, 2.0),
+        biorthogonality_error(bank.lowpass, bank.dual_highpass, 0.0),
+        biorthogonality_error(bank.highpass, bank.dual_lowpass, 0.0)
+    };
+
+    bool valid = true;
+    for (int i = 0; i < 4; i++)
+    {
+        valid = valid && errors[i] <= tolerance;
+    }
+
+    /* the dual masks of the cascade algorithm have to be the same numbers */
+    bool same_dual = true;
+    const mask_t* dual = find_mask(bank.name + "_dual");
+    if (dual != NULL)
+    {
+        same_dual = (int) bank.dual_lowpass.taps.size() == dual->length;
+        for (int i = 0; same_dual && i < dual->length; i++)
+        {
+            same_dual = bank.dual_lowpass.taps[i] == dual->entry[i];
+        }
+    }
+
+    if (log != NULL)
+    {
+        *log << bank.name << ": " << bank.lowpass.taps.size() << "/" << bank.dual_lowpass.taps.size()
+             << " taps, biorthogonality error " << fmax(fmax(errors[0], errors[1]), fmax(errors[2], errors[3]));
+        if (dual != NULL)
+        {
+            *log << ", dual mask " << (same_dual ? "equals " : "differs from ") << dual->name;
+        }
+        *log << (valid && same_dual ? "" : "  FAILED") << "\n";
+    }
+
+    return valid && same_dual;
+}
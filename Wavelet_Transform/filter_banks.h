@@ -0,0 +1,82 @@
+/*
+ * filter_banks.h
+ * Biorthogonal filter banks of the implemented wavelets.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef TRANSFORM_FILTER_BANKS_H
+#define TRANSFORM_FILTER_BANKS_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+
+/*
+ * finite filter, taps[i] belongs to the index first + i
+ */
+typedef struct {
+    std::vector<double> taps;
+    int first;
+}filter_t;
+
+/*
+ * Two channel filter bank with the normalization of the refinement masks
+ * (sum of the lowpass taps = 2). One level of the transform is
+ *   analysis:  c[k] = 1/2 sum_n x[n] h~[n-2k],  d[k] = 1/2 sum_n x[n] g~[n-2k]
+ *   synthesis: x[n] = sum_k c[k] h[n-2k] + sum_k d[k] g[n-2k]
+ * with the highpass filters g[n] = (-1)^n h~[1-n], g~[n] = (-1)^n h[1-n].
+ */
+typedef struct {
+    std::string name;
+    filter_t lowpass;       /* h, refinement mask of the primal scaling function */
+    filter_t highpass;      /* g, mask of the primal wavelet */
+    filter_t dual_lowpass;  /* h~ */
+    filter_t dual_highpass; /* g~ */
+}filter_bank_t;
+
+
+/*
+ * Complete the pair of lowpass filters (h, h~) to a filter bank. h~ is
+ * shifted so that sum_n h[n] h~[n-2k] = 2 delta_k, the highpass filters
+ * are derived from the shifted h~ and h.
+ * @param name name of the filter bank
+ * @param lowpass h
+ * @param dual_lowpass h~, any position, h~ = h for orthogonal wavelets
+ * @param bank completed filter bank
+ * @return false if no shift of h~ is biorthogonal to h
+ */
+bool biorthogonal_bank(const std::string& name, const filter_t& lowpass, const filter_t& dual_lowpass, filter_bank_t& bank);
+
+/*
+ * Filter banks by name:
+ *   "Haar", "Daubechies_2"  orthogonal masks of subdivision/masks.cpp
+ *   "CDF_m_mt"              CDF pair (N_m, dual of order mt), m + mt even,
+ *                           the dual mask is read off the spline wavelet
+ *                           mask of Visualize_Spline_Wavelets
+ * @param name name of the filter bank
+ * @param bank filter bank
+ * @return false if no filter bank of this name is implemented
+ */
+bool select_filter_bank(const std::string& name, filter_bank_t& bank);
+
+/* names of the filter banks with their own entry in the selection menu */
+extern const char* const builtin_filter_banks[];
+extern const int builtin_filter_bank_count;
+
+/*
+ * Check the biorthogonality relations of all four filters and that the CDF
+ * duals derived from the spline wavelet masks agree with the dual masks of
+ * subdivision/masks.cpp.
+ * @param bank filter bank
+ * @param log stream for a report, may be NULL
+ * @return true if the relations hold up to rounding
+ */
+bool verify_filter_bank(const filter_bank_t& bank, std::ostream* log);
+
+#endif /* TRANSFORM_FILTER_BANKS_H */
@@ -0,0 +1,458 @@
+/*
+ * lifting.cpp
+ * Lifting factorization of the biorthogonal filter banks.
+ *
+ * The analysis of a filter bank maps the even and odd samples by the
+ * polyphase matrix M = [He Ho; Ge Go] of Laurent polynomials,
+ * c = He x_even + Ho x_odd, d = Ge x_even + Go x_odd, where z^j stands for
+ * the shift (z^j x)[k] = x[k + j]. Every division step of the Euclidean
+ * algorithm on the first row, He <- He - q Ho (predict) or Ho <- Ho - q He
+ * (update), splits off one lifting step. When the first row has become
+ * (K1 z^a, 0), the determinant leaves Go = K2 z^b and Ge gives a last
+ * predict step.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "lifting.h"
+
+using namespace std;
+
+
+/*
+ * exact rational number num / den with den > 0 in lowest terms
+ */
+typedef struct {
+    int64_t num;
+    int64_t den;
+}rational_t;
+
+/* largest denominator of the taps accepted as rational */
+static const int64_t max_denominator = (int64_t) 1 << 40;
+
+
+/*
+ * @param overflow set if the result does not fit into 64 bits
+ */
+static rational_t make_rational(__int128 num, __int128 den, bool& overflow)
+{
+    if (den < 0) { num = -num; den = -den; }
+    __int128 a = (num < 0) ? -num : num, b = den;
+    while (b != 0)
+    {
+        const __int128 r = a % b;
+        a = b;
+        b = r;
+    }
+    if (a > 1) { num /= a; den /= a; }
+    if (num > INT64_MAX || num < -INT64_MAX || den > INT64_MAX)
+    {
+        overflow = true;
+        return {0, 1};
+    }
+    return {(int64_t) num, (int64_t) den};
+}
+
+static rational_t operator+(rational_t a, rational_t b)
+{
+    bool overflow = false;
+    const rational_t r = make_rational((__int128) a.num * b.den + (__int128) b.num * a.den, (__int128) a.den * b.den, overflow);
+    if (overflow) { throw overflow_error("rational"); }
+    return r;
+}
+
+static rational_t operator-(rational_t a)
+{
+    return {-a.num, a.den};
+}
+
+static rational_t operator*(rational_t a, rational_t b)
+{
+    bool overflow = false;
+    const rational_t r = make_rational((__int128) a.num * b.num, (__int128) a.den * b.den, overflow);
+    if (overflow) { throw overflow_error("rational"); }
+    return r;
+}
+
+static rational_t operator/(rational_t a, rational_t b)
+{
+    bool overflow = false;
+    const rational_t r = make_rational((__int128) a.num * b.den, (__int128) a.den * b.num, overflow);
+    if (overflow) { throw overflow_error("rational"); }
+    return r;
+}
+
+static bool is_dyadic(rational_t a)
+{
+    return (a.den & (a.den - 1)) == 0;
+}
+
+static double to_double(rational_t a)
+{
+    return (double) a.num / (double) a.den;
+}
+
+/*
+ * @return false if value is no dyadic rational with denominator up to max_denominator
+ */
+static bool to_rational(double value, rational_t& r)
+{
+    int64_t den = 1;
+    while (value * den != floor(value * den))
+    {
+        if (den >= max_denominator) { return false; }
+        den *= 2;
+    }
+    if (fabs(value * den) > 9e15) { return false; }
+
+    bool overflow = false;
+    r = make_rational((__int128) (value * den), den, overflow);
+    return !overflow;
+}
+
+
+/*
+ * Laurent polynomial sum_i c[i] z^(low + i) without zeros at the ends,
+ * the zero polynomial has no coefficients
+ */
+typedef struct {
+    int low;
+    vector<rational_t> c;
+}laurent_t;
+
+static laurent_t trimmed(laurent_t p)
+{
+    size_t begin = 0, end = p.c.size();
+    while (begin < end && p.c[begin].num == 0) { begin++; }
+    while (end > begin && p.c[end - 1].num == 0) { end--; }
+    laurent_t r = {p.low + (int) begin, vector<rational_t>(p.c.begin() + begin, p.c.begin() + end)};
+    return r;
+}
+
+/* @return coefficient of z^power */
+static rational_t coefficient(const laurent_t& p, int power)
+{
+    const int i = power - p.low;
+    return (i >= 0 && i < (int) p.c.size()) ? p.c[i] : rational_t{0, 1};
+}
+
+/* @return a - q b */
+static laurent_t subtract_product(const laurent_t& a, const laurent_t& q, const laurent_t& b)
+{
+    if (q.c.empty() || b.c.empty()) { return a; }
+
+    const int low = min(a.c.empty() ? q.low + b.low : a.low, q.low + b.low);
+    const int high = max(a.c.empty() ? q.low + b.low : a.low + (int) a.c.size(), q.low + b.low + (int) (q.c.size() + b.c.size()) - 1);
+    laurent_t r = {low, vector<rational_t>(high - low, rational_t{0, 1})};
+    for (int i = low; i < high; i++) { r.c[i - low] = coefficient(a, i); }
+    for (size_t i = 0; i < q.c.size(); i++)
+    {
+        for (size_t j = 0; j < b.c.size(); j++)
+        {
+            rational_t& t = r.c[q.low + (int) i + b.low + (int) j - low];
+            t = t + (-(q.c[i] * b.c[j]));
+        }
+    }
+
+    return trimmed(r);
+}
+
+
+/*
+ * All divisions a = q b + r with a remainder shorter than b, the remainder
+ * placed anywhere within the span of a. A monomial b also allows a monomial
+ * remainder, otherwise every division by b would end the algorithm.
+ */
+static void divisions(const laurent_t& a, const laurent_t& b, vector<pair<laurent_t, laurent_t> >& result)
+{
+    result.clear();
+    const int la = (int) a.c.size(), lb = (int) b.c.size();
+    const int b_low = b.low, b_high = b.low + lb - 1;
+
+    for (int remainder = lb - 1; remainder <= ((lb == 1) ? 1 : lb - 1); remainder++)
+    {
+        for (int s = 0; s + remainder <= la; s++)
+        {
+            laurent_t r = a, q = {0, vector<rational_t>()};
+            vector<pair<int, rational_t> > terms;
+
+            /* eliminate the coefficients left of the window from the left end of b */
+            for (int power = a.low; power < a.low + s; power++)
+            {
+                const rational_t t = coefficient(r, power);
+                if (t.num == 0) { continue; }
+                const laurent_t term = {power - b_low, vector<rational_t>(1, t / b.c[0])};
+                terms.push_back(make_pair(term.low, term.c[0]));
+                r = subtract_product(r, term, b);
+            }
+            /* and right of the window from the right end of b */
+            for (int power = a.low + la - 1; power >= a.low + s + remainder; power--)
+            {
+                const rational_t t = coefficient(r, power);
+                if (t.num == 0) { continue; }
+                const laurent_t term = {power - b_high, vector<rational_t>(1, t / b.c[lb - 1])};
+                terms.push_back(make_pair(term.low, term.c[0]));
+                r = subtract_product(r, term, b);
+            }
+            if (terms.empty() || (int) r.c.size() > remainder) { continue; }
+
+            int low = terms[0].first, high = terms[0].first;
+            for (const auto& t : terms) { low = min(low, t.first); high = max(high, t.first); }
+            q.low = low;
+            q.c.assign(high - low + 1, rational_t{0, 1});
+            for (const auto& t : terms) { q.c[t.first - low] = q.c[t.first - low] + t.second; }
+            result.push_back(make_pair(trimmed(q), r));
+        }
+    }
+}
+
+
+typedef struct {
+    bool update;
+    laurent_t q;
+}rational_step_t;
+
+/*
+ * depth first search over all sequences of divisions
+ */
+class LiftingSearch
+{
+public:
+    bool found;
+    vector<rational_step_t> best_steps;
+    rational_t best_scaling, best_detail;
+    int best_a, best_b;
+    int best_parity, best_offset;
+
+    LiftingSearch() : found(false) {}
+
+    void run(laurent_t m[2][2], int parity, int offset)
+    {
+        this->parity = parity;
+        this->offset = offset;
+        steps.clear();
+        search(m);
+    }
+
+private:
+    vector<rational_step_t> steps;
+    int parity, offset;
+    bool best_dyadic;
+    int best_taps;
+    size_t best_count;
+    double best_magnitude;
+    int best_spread;
+
+    void search(laurent_t m[2][2])
+    {
+        if ((int) steps.size() > max_lifting_steps) { return; }
+
+        if (m[0][1].c.empty() && m[0][0].c.size() == 1)
+        {
+            finish(m);
+            return;
+        }
+        if (m[0][0].c.empty()) { return; }
+
+        vector<pair<laurent_t, laurent_t> > options;
+        if (!m[0][1].c.empty() && m[0][0].c.size() >= m[0][1].c.size())
+        {
+            /* predict: He <- He - q Ho, Ge <- Ge - q Go */
+            divisions(m[0][0], m[0][1], options);
+            for (const auto& option : options)
+            {
+                if (option.second.c.empty()) { continue; }
+                laurent_t next[2][2] = {{option.second, m[0][1]}, {subtract_product(m[1][0], option.first, m[1][1]), m[1][1]}};
+                steps.push_back({false, option.first});
+                search(next);
+                steps.pop_back();
+            }
+        }
+        if (!m[0][1].c.empty() && m[0][1].c.size() >= m[0][0].c.size())
+        {
+            /* update: Ho <- Ho - q He, Go <- Go - q Ge */
+            divisions(m[0][1], m[0][0], options);
+            for (const auto& option : options)
+            {
+                laurent_t next[2][2] = {{m[0][0], option.second}, {m[1][0], subtract_product(m[1][1], option.first, m[1][0])}};
+                steps.push_back({true, option.first});
+                search(next);
+                steps.pop_back();
+            }
+        }
+    }
+
+    void finish(laurent_t m[2][2])
+    {
+        if (m[1][1].c.size() != 1) { return; }
+
+        const rational_t scaling = m[0][0].c[0], detail = m[1][1].c[0];
+        vector<rational_step_t> candidate = steps;
+        if (!m[1][0].c.empty())
+        {
+            /* [K1 z^a 0; Ge K2 z^b] = diag(K1 z^a, K2 z^b) [1 0; P 1] */
+            laurent_t p = m[1][0];
+            p.low -= m[1][1].low;
+            for (rational_t& t : p.c) { t = t / detail; }
+            candidate.push_back({false, p});
+        }
+
+        bool dyadic = is_dyadic(scaling) && is_dyadic(detail);
+        int taps = 0;
+        double magnitude = 0.0;
+        for (const rational_step_t& step : candidate)
+        {
+            taps += (int) step.q.c.size();
+            for (const rational_t& t : step.q.c)
+            {
+                dyadic = dyadic && is_dyadic(t);
+                magnitude = fmax(magnitude, fabs(to_double(t)));
+            }
+        }
+
+        /* dyadic first, then the fewest taps, steps, the smallest numbers and shifts */
+        const int spread = abs(offset) + abs(m[0][0].low) + abs(m[1][1].low);
+        const bool better = !found
+            || (dyadic != best_dyadic ? dyadic
+               : taps != best_taps ? taps < best_taps
+               : candidate.size() != best_count ? candidate.size() < best_count
+               : magnitude != best_magnitude ? magnitude < best_magnitude
+               : spread < best_spread);
+        if (!better) { return; }
+
+        found = true;
+        best_steps = candidate;
+        best_scaling = scaling;
+        best_detail = detail;
+        best_a = m[0][0].low;
+        best_b = m[1][1].low;
+        best_parity = parity;
+        best_offset = offset;
+        best_dyadic = dyadic;
+        best_taps = taps;
+        best_count = candidate.size();
+        best_magnitude = magnitude;
+        best_spread = spread;
+    }
+};
+
+
+/*
+ * @param filter analysis filter
+ * @param even, odd its polyphase components, c[k] = sum even_j x[2(k+j)] + odd_j x[2(k+j)+1]
+ * @return false if a tap is not rational
+ */
+static bool analysis_polyphase(const filter_t& filter, laurent_t& even, laurent_t& odd)
+{
+    const int n = (int) filter.taps.size();
+    const int low = (filter.first >= 0) ? filter.first / 2 : -((1 - filter.first) / 2);
+    const int high = (filter.first + n - 1 >= 0) ? (filter.first + n - 1) / 2 : -((2 - filter.first - n) / 2);
+    even = {low, vector<rational_t>(high - low + 1, rational_t{0, 1})};
+    odd = even;
+
+    const rational_t half = {1, 2};
+    for (int i = 0; i < n; i++)
+    {
+        rational_t tap;
+        if (!to_rational(filter.taps[i], tap)) { return false; }
+        const int r = filter.first + i;
+        const int j = (r >= 0) ? r / 2 : -((1 - r) / 2);
+        ((r - 2*j == 0) ? even : odd).c[j - low] = tap * half;
+    }
+    even = trimmed(even);
+    odd = trimmed(odd);
+
+    return true;
+}
+
+
+bool factor_lifting(const filter_bank_t& bank, lifting_t& lifting)
+{
+    LiftingSearch search;
+    try
+    {
+        laurent_t he, ho, ge, go;
+        if (!analysis_polyphase(bank.dual_lowpass, he, ho) || !analysis_polyphase(bank.dual_highpass, ge, go))
+        {
+            return false;
+        }
+
+        /* s from the even or the odd samples, d shifted by -1, 0, 1 */
+        for (int parity = 0; parity <= 1; parity++)
+        {
+            for (int offset = -1; offset <= 1; offset++)
+            {
+                laurent_t m[2][2] = {{parity ? ho : he, parity ? he : ho}, {parity ? go : ge, parity ? ge : go}};
+                m[0][1].low += offset;
+                m[1][1].low += offset;
+                search.run(m, parity, offset);
+            }
+        }
+    }
+    catch (const overflow_error&)
+    {
+        return false;
+    }
+    if (!search.found) { return false; }
+
+    lifting.parity = search.best_parity;
+    lifting.offset = search.best_offset;
+    lifting.steps.clear();
+    lifting.dyadic = is_dyadic(search.best_scaling) && is_dyadic(search.best_detail);
+    for (const rational_step_t& step : search.best_steps)
+    {
+        lifting_step_t s = {step.update, step.q.low, vector<double>()};
+        for (const rational_t& t : step.q.c)
+        {
+            s.taps.push_back(to_double(t));
+            lifting.dyadic = lifting.dyadic && is_dyadic(t);
+        }
+        lifting.steps.push_back(s);
+    }
+    lifting.scaling = to_double(search.best_scaling);
+    lifting.detail_scaling = to_double(search.best_detail);
+    lifting.scaling_shift = search.best_a;
+    lifting.detail_shift = search.best_b;
+
+    return true;
+}
+
+
+/*
+ * @return "k", "k+shift" or "k-shift"
+ */
+static string shifted(int shift)
+{
+    return (shift == 0) ? "k" : (shift > 0 ? "k+" : "k-") + to_string(abs(shift));
+}
+
+
+void print_lifting(const lifting_t& lifting, ostream& out)
+{
+    const streamsize precision = out.precision(12);
+    const string pair = (lifting.offset == 0) ? "2k" : "2(" + shifted(-lifting.offset) + ")";
+
+    out << "  s[k] = x[2k" << (lifting.parity ? "+1" : "") << "], d[k] = x[" << pair << (lifting.parity ? "" : "+1") << "]\n";
+    for (const lifting_step_t& step : lifting.steps)
+    {
+        out << "  " << (step.update ? "s[k] += " : "d[k] += ");
+        for (size_t i = 0; i < step.taps.size(); i++)
+        {
+            out << (i > 0 ? (step.taps[i] < 0 ? " - " : " + ") : (step.taps[i] < 0 ? "-" : ""))
+                << fabs(step.taps[i]) << " " << (step.update ? "d[" : "s[") << shifted(step.first + (int) i) << "]";
+        }
+        out << "\n";
+    }
+    out << "  c[k] = " << lifting.scaling << " s[" << shifted(lifting.scaling_shift) << "], d[k] = "
+        << lifting.detail_scaling << " d[" << shifted(lifting.detail_shift) << "]\n";
+    out.precision(precision);
+}
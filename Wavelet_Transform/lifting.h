@@ -0,0 +1,68 @@
+/*
+ * lifting.h
+ * Lifting factorization of the biorthogonal filter banks.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef TRANSFORM_LIFTING_H
+#define TRANSFORM_LIFTING_H
+
+#include <ostream>
+#include <vector>
+#include "filter_banks.h"
+
+
+/*
+ * one lifting step, predict: d[k] += sum_i taps[i] s[k + first + i],
+ * update: s[k] += sum_i taps[i] d[k + first + i]
+ */
+typedef struct {
+    bool update;
+    int first;
+    std::vector<double> taps;
+}lifting_step_t;
+
+/*
+ * Factorization of the analysis of a filter bank into lifting steps:
+ *   s[k] = x[2k + parity], d[k] = x[2(k - offset) + 1 - parity],
+ *   the steps in their order,
+ *   c[k] = scaling * s[k + scaling_shift], d[k] = detail_scaling * d[k + detail_shift].
+ * The synthesis runs the steps backwards with the opposite sign.
+ */
+typedef struct {
+    int parity;
+    int offset;
+    std::vector<lifting_step_t> steps;
+    double scaling, detail_scaling;
+    int scaling_shift, detail_shift;
+    bool dyadic; /* all numbers are dyadic rationals, exact on integer signals */
+}lifting_t;
+
+/* largest number of lifting steps searched for */
+const int max_lifting_steps = 8;
+
+/*
+ * Derive the lifting steps by the Euclidean algorithm on the polyphase
+ * matrix of the analysis filters in exact rational arithmetic. Among the
+ * possible divisions the factorization with dyadic numbers and the fewest
+ * taps is chosen. Masks which are not rational, e.g. Daubechies_2, have no
+ * factorization here.
+ * @param bank filter bank
+ * @param lifting steps and scaling of bank
+ * @return false if the taps are not rational with small denominators or no
+ *         factorization with at most max_lifting_steps steps is found
+ */
+bool factor_lifting(const filter_bank_t& bank, lifting_t& lifting);
+
+/*
+ * @param lifting factorization
+ * @param out stream for one line per step
+ */
+void print_lifting(const lifting_t& lifting, std::ostream& out);
+
+#endif /* TRANSFORM_LIFTING_H */
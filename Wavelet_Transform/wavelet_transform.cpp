@@ -0,0 +1,577 @@
+/*
+ * wavelet_transform.cpp (version 1.0)
+ * Forward and inverse discrete wavelet transform of signals in files.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#define _FILE_OFFSET_BITS 64
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <math.h>
+#include <string>
+#include <vector>
+#include "filter_banks.h"
+#include "dwt.h"
+#include "../common/aligned_buffer.h"
+#include "../common/batch.h"
+#include "../common/timer.h"
+
+using namespace std;
+
+
+/* samples read from the input file per block of the streaming transform */
+static const size_t stream_block = (size_t) 1 << 20;
+
+
+/*
+ * Remove the option name without value from the command line.
+ * @return false if the option is not given
+ */
+static bool take_flag(int& argc, char** argv, const char* name)
+{
+    bool found = false;
+    int kept = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0) { found = true; }
+        else { argv[kept++] = argv[i]; }
+    }
+    argc = kept;
+
+    return found;
+}
+
+
+/*
+ * @param filename raw float64 file
+ * @return number of values or -1 if the file cannot be read
+ */
+static long long value_count(const char* filename)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) { return -1; }
+    const bool seekable = fseeko(file, 0, SEEK_END) == 0;
+    const long long bytes = seekable ? (long long) ftello(file) : -1;
+    fclose(file);
+
+    return (bytes < 0 || bytes % sizeof(double) != 0) ? -1 : bytes / (long long) sizeof(double);
+}
+
+static bool read_values(const char* filename, double* values, size_t n)
+{
+    FILE* file = fopen(filename, "rb");
+    if (file == NULL) { return false; }
+    const bool complete = fread(values, sizeof(double), n, file) == n;
+    fclose(file);
+
+    return complete;
+}
+
+static bool write_values(const char* filename, const double* values, size_t n)
+{
+    FILE* file = fopen(filename, "wb");
+    if (file == NULL) { return false; }
+    const bool complete = fwrite(values, sizeof(double), n, file) == n;
+
+    return (fclose(file) == 0) && complete;
+}
+
+
+/*
+ * Forward transform of the file in blocks of stream_block samples, the
+ * coefficients are written to their positions in the output file.
+ * @return false if a file cannot be read or written
+ */
+static bool stream_forward(const filter_bank_t& bank, transform_path_t path, const char* input, const char* output, size_t n, int levels)
+{
+    FILE* in = fopen(input, "rb");
+    FILE* out = fopen(output, "wb");
+    bool valid = (in != NULL) && (out != NULL);
+
+    StreamingTransform transform(bank);
+    transform.select_path(path);
+    const coefficient_consumer_t consumer =
+        [&](int level, bool detail, size_t first, const double* values, size_t count)
+        {
+            const level_layout_t& layout = transform.layout()[level - 1];
+            const size_t position = (detail ? layout.detail_offset : 0) + first;
+            return fseeko(out, (off_t) (position * sizeof(double)), SEEK_SET) == 0
+                && fwrite(values, sizeof(double), count, out) == count;
+        };
+
+    valid = valid && transform.start(n, levels, consumer);
+    vector<double> block(stream_block);
+    for (size_t done = 0; valid && done < n; )
+    {
+        const size_t count = min(stream_block, n - done);
+        valid = fread(block.data(), sizeof(double), count, in) == count && transform.push(block.data(), count);
+        done += count;
+    }
+    valid = valid && transform.finish();
+
+    if (in != NULL) { fclose(in); }
+    if (out != NULL) { valid = (fclose(out) == 0) && valid; }
+
+    return valid;
+}
+
+
+/*
+ * Direct evaluation of c[k] = 1/2 sum x[n] h~[n-2k], d[k] = 1/2 sum x[n] g~[n-2k]
+ * on every level, with the products in the order of the kernels.
+ */
+static vector<double> reference_forward(const WaveletTransform& T, const vector<double>& x, int levels)
+{
+    vector<level_layout_t> layout;
+    T.plan(x.size(), levels, layout);
+    vector<double> result(T.coefficient_count(x.size(), levels)), signal = x;
+
+    const analysis_filter_t filters[2] = {analysis_filter(T.filter_bank().dual_lowpass),
+                                          analysis_filter(T.filter_bank().dual_highpass)};
+    for (int j = 0; j < levels; j++)
+    {
+        const int64_t n = (int64_t) signal.size();
+        const auto sample = [&](int64_t u)
+        {
+            u %= (T.boundary() == boundary_periodic) ? n : 2*n;
+            if (u < 0) { u += (T.boundary() == boundary_periodic) ? n : 2*n; }
+            return signal[(u < n) ? u : 2*n - 1 - u];
+        };
+
+        vector<double> bands[2];
+        for (int b = 0; b < 2; b++)
+        {
+            const analysis_filter_t& f = filters[b];
+            for (size_t i = 0; i < layout[j].band_length; i++)
+            {
+                const int64_t k = layout[j].first + (int64_t) i;
+                double value = 0.0;
+                for (size_t t = 0; t < f.even.size(); t++)
+                {
+                    value += f.even[t] * sample(2*(k + f.shift + (int64_t) t));
+                }
+                for (size_t t = 0; t < f.odd.size(); t++)
+                {
+                    value += f.odd[t] * sample(2*(k + f.shift + (int64_t) t) + 1);
+                }
+                bands[b].push_back(0.5 * value);
+            }
+        }
+
+        copy(bands[1].begin(), bands[1].end(), result.begin() + layout[j].detail_offset);
+        signal = bands[0];
+    }
+    copy(signal.begin(), signal.end(), result.begin());
+
+    return result;
+}
+
+
+/*
+ * Check the transforms of one filter bank on random signals of many lengths:
+ * forward equals the direct evaluation bit for bit for every instruction
+ * set and the streaming transform, inverse reconstructs the signal.
+ * @return true if all checks pass
+ */
+static bool verify_transform(const filter_bank_t& bank)
+{
+    const size_t lengths[] = {1, 2, 3, 4, 5, 7, 8, 12, 16, 17, 31, 32, 48, 64, 100, 128, 1000, 1024, 4099, 12288, 20000};
+    const isa_t supported = detect_isa();
+    size_t cases = 0, failures = 0;
+    double max_error = 0.0;
+
+    srand(4711);
+    for (int boundary = boundary_periodic; boundary <= boundary_symmetric; boundary++)
+    {
+        const WaveletTransform T(bank, (boundary_t) boundary);
+        for (size_t n : lengths)
+        {
+            for (int levels = 1; levels <= 5; levels++)
+            {
+                const size_t count = T.coefficient_count(n, levels);
+                if (count == 0) { continue; }
+
+                vector<double> x(n);
+                for (size_t i = 0; i < n; i++) { x[i] = 2.0 * rand() / (double) RAND_MAX - 1.0; }
+                const vector<double> expected = reference_forward(T, x, levels);
+                bool valid = true;
+
+                for (int isa = isa_scalar; isa <= supported; isa++)
+                {
+                    select_isa((isa_t) isa);
+                    vector<double> data(count);
+                    copy(x.begin(), x.end(), data.begin());
+                    T.forward(data.data(), n, levels);
+                    valid = valid && memcmp(data.data(), expected.data(), count * sizeof(double)) == 0;
+
+                    T.inverse(data.data(), n, levels);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        max_error = fmax(max_error, fabs(data[i] - x[i]));
+                        valid = valid && fabs(data[i] - x[i]) <= 1e-12;
+                    }
+                }
+                select_isa(supported);
+
+                if (boundary == boundary_symmetric)
+                {
+                    vector<double> streamed(count, NAN);
+                    StreamingTransform S(bank);
+                    const coefficient_consumer_t consumer =
+                        [&](int level, bool detail, size_t first, const double* values, size_t m)
+                        {
+                            const level_layout_t& layout = S.layout()[level - 1];
+                            copy(values, values + m, streamed.begin() + (detail ? layout.detail_offset : 0) + first);
+                            return true;
+                        };
+                    bool streams = S.start(n, levels, consumer);
+                    for (size_t done = 0; streams && done < n; )
+                    {
+                        const size_t piece = min(n - done, (size_t) (1 + rand() % 700));
+                        streams = S.push(x.data() + done, piece);
+                        done += piece;
+                    }
+                    valid = valid && streams && S.finish()
+                        && memcmp(streamed.data(), expected.data(), count * sizeof(double)) == 0;
+                }
+
+                cases++;
+                if (!valid) { failures++; }
+            }
+        }
+    }
+
+    cout << "  " << cases << " transforms, reconstruction error " << max_error
+         << (failures == 0 ? "" : "  FAILED") << endl;
+
+    return failures == 0;
+}
+
+
+/*
+ * Check the lifting paths of one filter bank: on integer signals the
+ * lifting coefficients of up to max_exact_levels levels equal those of the
+ * convolution bit for bit if the factorization is dyadic (deeper levels
+ * exceed the 53 bits of the products), on real signals they agree to
+ * rounding. Every instruction set and the streaming transform give the
+ * lifting coefficients bit for bit, the integer lifting reconstructs
+ * integer signals exactly. Prints the throughput of both paths for a
+ * signal in the cache.
+ * @return true if all checks pass
+ */
+static bool verify_lifting(const filter_bank_t& bank)
+{
+    const size_t lengths[] = {1, 2, 3, 4, 5, 7, 8, 12, 16, 17, 31, 32, 48, 64, 100, 128, 1000, 1024, 4099, 12288, 20000};
+    const int max_exact_levels = 2;
+    const isa_t supported = detect_isa();
+
+    WaveletTransform probe(bank, boundary_symmetric);
+    if (!probe.has_lifting())
+    {
+        cout << "  no lifting factorization" << endl;
+        return true;
+    }
+    const lifting_t& lifting = probe.lifting();
+    print_lifting(lifting, cout);
+
+    size_t cases = 0, failures = 0;
+    double max_difference = 0.0, max_error = 0.0;
+
+    srand(815);
+    for (int boundary = boundary_periodic; boundary <= boundary_symmetric; boundary++)
+    {
+        WaveletTransform C(bank, (boundary_t) boundary), L(bank, (boundary_t) boundary), I(bank, (boundary_t) boundary);
+        L.select_path(path_lifting);
+        const bool integer = I.select_path(path_integer_lifting);
+        for (size_t n : lengths)
+        {
+            for (int levels = 1; levels <= 5; levels++)
+            {
+                const size_t count = C.coefficient_count(n, levels);
+                if (count == 0) { continue; }
+                bool valid = true;
+
+                /* integer signal: lifting against convolution, integer round trip */
+                vector<double> x(n), a(count), b(count);
+                for (size_t i = 0; i < n; i++) { x[i] = a[i] = b[i] = (double) (rand() % 512 - 256); }
+                C.forward(a.data(), n, levels);
+                L.forward(b.data(), n, levels);
+                if (lifting.dyadic && levels <= max_exact_levels)
+                {
+                    valid = valid && memcmp(a.data(), b.data(), count * sizeof(double)) == 0;
+                }
+                if (integer)
+                {
+                    copy(x.begin(), x.end(), b.begin());
+                    I.forward(b.data(), n, levels);
+                    for (size_t i = 0; i < count; i++) { valid = valid && b[i] == floor(b[i]); }
+                    I.inverse(b.data(), n, levels);
+                    valid = valid && equal(x.begin(), x.end(), b.begin());
+                }
+
+                /* real signal: agreement and reconstruction */
+                for (size_t i = 0; i < n; i++) { x[i] = a[i] = b[i] = 2.0 * rand() / (double) RAND_MAX - 1.0; }
+                C.forward(a.data(), n, levels);
+                L.forward(b.data(), n, levels);
+                for (int isa = isa_scalar; isa <= supported; isa++)
+                {
+                    select_isa((isa_t) isa);
+                    vector<double> data(count);
+                    copy(x.begin(), x.end(), data.begin());
+                    L.forward(data.data(), n, levels);
+                    valid = valid && memcmp(data.data(), b.data(), count * sizeof(double)) == 0;
+                }
+                select_isa(supported);
+                for (size_t i = 0; i < count; i++)
+                {
+                    max_difference = fmax(max_difference, fabs(a[i] - b[i]));
+                    valid = valid && fabs(a[i] - b[i]) <= 1e-12;
+                }
+
+                if (boundary == boundary_symmetric)
+                {
+                    vector<double> streamed(count, NAN);
+                    StreamingTransform S(bank);
+                    S.select_path(path_lifting);
+                    const coefficient_consumer_t consumer =
+                        [&](int level, bool detail, size_t first, const double* values, size_t m)
+                        {
+                            const level_layout_t& layout = S.layout()[level - 1];
+                            copy(values, values + m, streamed.begin() + (detail ? layout.detail_offset : 0) + first);
+                            return true;
+                        };
+                    bool streams = S.start(n, levels, consumer);
+                    for (size_t done = 0; streams && done < n; )
+                    {
+                        const size_t piece = min(n - done, (size_t) (1 + rand() % 700));
+                        streams = S.push(x.data() + done, piece);
+                        done += piece;
+                    }
+                    valid = valid && streams && S.finish()
+                        && memcmp(streamed.data(), b.data(), count * sizeof(double)) == 0;
+                }
+
+                L.inverse(b.data(), n, levels);
+                for (size_t i = 0; i < n; i++)
+                {
+                    max_error = fmax(max_error, fabs(b[i] - x[i]));
+                    valid = valid && fabs(b[i] - x[i]) <= 1e-12;
+                }
+
+                cases++;
+                if (!valid) { failures++; }
+            }
+        }
+    }
+
+    /* throughput of the forward transform over 5 levels, best of 20 runs */
+    const size_t n = (size_t) 1 << 16;
+    const WaveletTransform C(bank, boundary_symmetric);
+    WaveletTransform L(bank, boundary_symmetric);
+    L.select_path(path_lifting);
+    vector<double> data(C.coefficient_count(n, 5));
+    double rates[2] = {0.0, 0.0};
+    for (int run = 0; run < 40; run++)
+    {
+        const int path = run / 20;
+        for (size_t i = 0; i < n; i++) { data[i] = sin(0.001 * i); }
+        Timer timer;
+        (path == 0 ? C : L).forward(data.data(), n, 5);
+        rates[path] = fmax(rates[path], n / fmax(timer.seconds(), 1e-9) / 1e6);
+    }
+
+    cout << "  " << cases << " lifting transforms, " << (lifting.dyadic ? "dyadic" : "not dyadic")
+         << ", difference " << max_difference << ", reconstruction error " << max_error
+         << (failures == 0 ? "" : "  FAILED") << endl
+         << "  convolution " << rates[0] << " Msamples/s, lifting " << rates[1] << " Msamples/s" << endl;
+
+    return failures == 0;
+}
+
+
+/*
+ * Usage: wavelet_transform <filter bank> <levels> <input> <output>
+ *        wavelet_transform --filters
+ *        wavelet_transform --verify
+ *
+ * Input and output are raw little endian float64 files, the coefficients
+ * in the order [c_L, d_L, d_{L-1}, ..., d_1].
+ * --boundary {periodic, symmetric} selects the extension (default symmetric).
+ * --inverse reconstructs the signal of length --length n (default: the
+ * number of coefficients, which fits the periodic extension).
+ * --stream transforms the input in blocks without holding it in memory
+ * (forward transform with symmetric extension).
+ * --lifting computes the transform by the lifting steps of the filter bank,
+ * --integer by integer lifting steps (integer signals, periodic extension).
+ */
+int main(int argc, char** argv)
+{
+    const verbosity_t verbosity = take_verbosity(argc, argv);
+    const bool inverse = take_flag(argc, argv, "--inverse");
+    const bool stream = take_flag(argc, argv, "--stream");
+    const bool lifting = take_flag(argc, argv, "--lifting");
+    const bool integer = take_flag(argc, argv, "--integer");
+
+    cout << "Discrete wavelet transform." << endl;
+
+    string boundary_value = "symmetric";
+    boundary_t boundary = boundary_symmetric;
+    take_option(argc, argv, "--boundary", boundary_value);
+    if (!parse_boundary(boundary_value, boundary))
+    {
+        cout << "\nBoundary has to be periodic or symmetric.\nProgram end." << endl;
+        return 1;
+    }
+
+    string length_value;
+    const bool length_given = take_option(argc, argv, "--length", length_value);
+
+    if (argc == 2 && string(argv[1]) == "--filters")
+    {
+        cout << "\nFilter banks (CDF_m_mt for every m + mt even):" << endl;
+        for (int i = 0; i < builtin_filter_bank_count; i++)
+        {
+            cout << "  " << builtin_filter_banks[i] << endl;
+        }
+        cout << "\nProgram end." << endl;
+        return 0;
+    }
+
+    /* biorthogonality of the filter banks and exactness of the transforms */
+    if (argc == 2 && string(argv[1]) == "--verify")
+    {
+        bool all_valid = true;
+        cout << "\nInstruction set: " << isa_name(detect_isa()) << "\n" << endl;
+        for (int i = 0; i < builtin_filter_bank_count; i++)
+        {
+            filter_bank_t bank;
+            if (!select_filter_bank(builtin_filter_banks[i], bank))
+            {
+                cout << builtin_filter_banks[i] << ": no filter bank  FAILED" << endl;
+                all_valid = false;
+                continue;
+            }
+            all_valid = verify_filter_bank(bank, &cout) && all_valid;
+            all_valid = verify_transform(bank) && all_valid;
+            all_valid = verify_lifting(bank) && all_valid;
+        }
+        cout << (all_valid ? "\nAll transforms are exact." : "\nWarning: Transforms failed.") << endl;
+        return all_valid ? 0 : 1;
+    }
+
+    if (argc != 5)
+    {
+        cout << "\nUsage: wavelet_transform <filter bank> <levels> <input> <output> [--boundary periodic|symmetric]"
+             << "\n       [--inverse [--length n]] [--stream] [--lifting | --integer]"
+             << "\n       wavelet_transform --filters | --verify.\nProgram end." << endl;
+        return 1;
+    }
+
+    filter_bank_t bank;
+    if (!select_filter_bank(argv[1], bank))
+    {
+        cout << "\nNo filter bank '" << argv[1] << "', see --filters.\nProgram end." << endl;
+        return 1;
+    }
+    const int levels = atoi(argv[2]);
+    const char* input = argv[3];
+    const char* output = argv[4];
+
+    const long long values = value_count(input);
+    if (values <= 0)
+    {
+        cout << "\nCannot read input file '" << input << "'.\nProgram end." << endl;
+        return 1;
+    }
+
+    WaveletTransform T(bank, boundary);
+    const transform_path_t path = integer ? path_integer_lifting : (lifting ? path_lifting : path_convolution);
+    if (!T.select_path(path))
+    {
+        if (!T.has_lifting()) { cout << "\nFilter bank " << bank.name << " has no lifting factorization."; }
+        else                  { cout << "\nInteger lifting needs periodic extension."; }
+        cout << "\nProgram end." << endl;
+        return 1;
+    }
+    const size_t n = inverse ? (length_given ? (size_t) atoll(length_value.c_str()) : (size_t) values) : (size_t) values;
+    const size_t count = T.coefficient_count(n, levels);
+    if (count == 0 || (inverse && count != (size_t) values))
+    {
+        cout << "\nNo transform of " << n << " samples over " << levels << " levels with "
+             << boundary_name(boundary) << " extension" << (inverse ? " matches the input" : "")
+             << ".\nProgram end." << endl;
+        return 1;
+    }
+    if (stream && (inverse || boundary != boundary_symmetric))
+    {
+        cout << "\nThe streaming transform is forward with symmetric extension.\nProgram end." << endl;
+        return 1;
+    }
+
+    Timer timer;
+    if (stream)
+    {
+        if (!stream_forward(bank, path, input, output, n, levels))
+        {
+            cout << "\nCannot transform '" << input << "' to '" << output << "'.\nProgram end." << endl;
+            return 1;
+        }
+    }
+    else
+    {
+        AlignedBuffer<double> data(max(count, n));
+        if (!read_values(input, data.data(), (size_t) values))
+        {
+            cout << "\nCannot read input file '" << input << "'.\nProgram end." << endl;
+            return 1;
+        }
+        if (inverse) { T.inverse(data.data(), n, levels); }
+        else         { T.forward(data.data(), n, levels); }
+
+        if (!write_values(output, data.data(), inverse ? n : count))
+        {
+            cout << "\nCannot write output file '" << output << "'.\nProgram end." << endl;
+            return 1;
+        }
+    }
+    const double seconds = timer.seconds();
+
+    if (verbosity >= verbosity_summary)
+    {
+        vector<level_layout_t> layout;
+        T.plan(n, levels, layout);
+        cout << "\nFilter bank: " << bank.name << " (" << bank.lowpass.taps.size() << "/"
+             << bank.dual_lowpass.taps.size() << " taps), " << boundary_name(boundary) << " extension, "
+             << path_name(path) << endl
+             << "Level | signal length | band length | first shift\n"
+             << "---------------------------------------------------\n";
+        for (int j = 0; j < levels; j++)
+        {
+            cout << setw(5) << j + 1 << " | " << setw(13) << layout[j].signal_length << " | "
+                 << setw(11) << layout[j].band_length << " | " << setw(11) << (long long) layout[j].first << "\n";
+        }
+        if (path != path_convolution && verbosity >= verbosity_trace)
+        {
+            cout << "\nLifting steps:" << endl;
+            print_lifting(T.lifting(), cout);
+        }
+        cout << "\n" << (inverse ? "Inverse" : "Forward") << " transform" << (stream ? " (streamed)" : "")
+             << ": " << seconds << " s, " << n / fmax(seconds, 1e-9) / 1e6 << " Msamples/s" << endl;
+    }
+
+    cout << "\nOutput written to: " << endl
+         << output << endl
+         << "\nProgram end." << endl;
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * aligned_buffer.h
+ * Heap storage with cache line alignment for the numerical engines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_ALIGNED_BUFFER_H
+#define MISC_ALIGNED_BUFFER_H
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+const size_t cache_line_size = 64; /* alignment of every buffer in bytes */
+
+
+/*
+ * Zero initialized array of T on the heap, aligned to cache_line_size.
+ * The buffer owns its memory and can be moved but not copied.
+ */
+template <typename T>
+class AlignedBuffer
+{
+public:
+    AlignedBuffer() : ptr(NULL), count(0) {}
+
+    explicit AlignedBuffer(size_t n) : ptr(NULL), count(0) { resize(n); }
+
+    AlignedBuffer(AlignedBuffer&& other) : ptr(other.ptr), count(other.count)
+    {
+        other.ptr = NULL;
+        other.count = 0;
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other)
+    {
+        if (this != &other)
+        {
+            std::free(ptr);
+            ptr = other.ptr;
+            count = other.count;
+            other.ptr = NULL;
+            other.count = 0;
+        }
+        return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    ~AlignedBuffer() { std::free(ptr); }
+
+    /*
+     * @param n number of elements, previous contents are discarded
+     */
+    void resize(size_t n)
+    {
+        std::free(ptr);
+        ptr = NULL;
+        count = 0;
+        if (n == 0) { return; }
+
+        /* round up to whole cache lines, required by aligned_alloc */
+        size_t bytes = ((n * sizeof(T) + cache_line_size - 1) / cache_line_size) * cache_line_size;
+        ptr = static_cast<T*>(std::aligned_alloc(cache_line_size, bytes));
+        if (ptr == NULL) { throw std::bad_alloc(); }
+        std::memset(static_cast<void*>(ptr), 0, bytes);
+        count = n;
+    }
+
+    void fill_zero() { if (count > 0) { std::memset(static_cast<void*>(ptr), 0, count * sizeof(T)); } }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+
+private:
+    T* ptr;
+    size_t count;
+};
+
+#endif /* MISC_ALIGNED_BUFFER_H */
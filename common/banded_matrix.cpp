@@ -0,0 +1,86 @@
+/*
+ * banded_matrix.cpp
+ * Banded Toeplitz matrices of inner products of shifted functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <stdint.h>
+#include <algorithm>
+#include <iomanip>
+#include "banded_matrix.h"
+
+using namespace std;
+
+
+double band_value(const band_t& band, int k)
+{
+    const int i = k - band.first;
+
+    return (i >= 0 && i < (int) band.entry.size()) ? band.entry[i] : 0.0;
+}
+
+
+int band_lower(const band_t& band)
+{
+    return max(0, -band.first);
+}
+
+
+int band_upper(const band_t& band)
+{
+    return max(0, band.first + (int) band.entry.size() - 1);
+}
+
+
+void band_storage(const band_t& band, size_t n, vector<double>& ab)
+{
+    const int lower = band_lower(band), upper = band_upper(band);
+    const size_t ldab = lower + upper + 1;
+    ab.assign(ldab * n, 0.0);
+
+    for (size_t j = 0; j < n; j++)
+    {
+        /* rows i = j - upper .. j + lower, A[i][j] = b(j - i) */
+        for (int d = -upper; d <= lower; d++)
+        {
+            const int64_t i = (int64_t) j + d;
+            if (i < 0 || i >= (int64_t) n) { continue; }
+            ab[(upper + d) + j * ldab] = band_value(band, -d);
+        }
+    }
+}
+
+
+void band_multiply(const band_t& band, const double* x, double* y, size_t n)
+{
+    const int last = band.first + (int) band.entry.size() - 1;
+
+    for (size_t i = 0; i < n; i++)
+    {
+        /* y[i] = sum_k b(k) x[i + k] */
+        const int64_t low = max((int64_t) band.first, -(int64_t) i);
+        const int64_t high = min((int64_t) last, (int64_t) (n - 1 - i));
+        double value = 0.0;
+        for (int64_t k = low; k <= high; k++)
+        {
+            value += band.entry[k - band.first] * x[i + k];
+        }
+        y[i] = value;
+    }
+}
+
+
+void print_band(const band_t& band, ostream& out)
+{
+    const streamsize precision = out.precision(17);
+    for (size_t i = 0; i < band.entry.size(); i++)
+    {
+        out << setw(4) << band.first + (int) i << "  " << band.entry[i] << "\n";
+    }
+    out.precision(precision);
+}
@@ -0,0 +1,58 @@
+/*
+ * banded_matrix.h
+ * Banded Toeplitz matrices of inner products of shifted functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_BANDED_MATRIX_H
+#define MISC_BANDED_MATRIX_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+
+
+/*
+ * Inner products b(k) = <f, g(. - k)> of compactly supported functions for
+ * the shifts first <= k < first + entry.size(), zero for all other k. The
+ * Gram matrix of the shifts, A[i][j] = <f(. - i), g(. - j)> = b(j - i), is
+ * banded Toeplitz, so entry is its compact format.
+ */
+typedef struct {
+    int first;
+    std::vector<double> entry;
+}band_t;
+
+/* @return b(k) */
+double band_value(const band_t& band, int k);
+
+/* @return number of diagonals below (lower) and above (upper) the main diagonal */
+int band_lower(const band_t& band);
+int band_upper(const band_t& band);
+
+/*
+ * Section A[i][j], 0 <= i, j < n, in the general band storage of LAPACK
+ * (dgbmv, dgbsv with ldab = lower + upper + 1): column major,
+ * ab[(upper + i - j) + j * ldab] = A[i][j].
+ * @param band Toeplitz band
+ * @param n order of the section
+ * @param ab (lower + upper + 1) * n values
+ */
+void band_storage(const band_t& band, size_t n, std::vector<double>& ab);
+
+/*
+ * y = A x with the section of order n
+ */
+void band_multiply(const band_t& band, const double* x, double* y, size_t n);
+
+/*
+ * one line "k b(k)" per shift with 17 significant digits
+ */
+void print_band(const band_t& band, std::ostream& out);
+
+#endif /* MISC_BANDED_MATRIX_H */
@@ -0,0 +1,131 @@
+/*
+ * batch.cpp
+ * Command line and job file parsing of the batch modes.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include "batch.h"
+
+using namespace std;
+
+
+bool parse_int_list(const char* text, vector<int>& values)
+{
+    if (text == NULL || *text == '\0') { return false; }
+
+    const char* p = text;
+    while (*p != '\0')
+    {
+        char* end = NULL;
+        const long value = strtol(p, &end, 10);
+        if (end == p) { return false; }
+        values.push_back((int) value);
+
+        p = end;
+        if (*p == ',') { p++; }
+        else if (*p != '\0') { return false; }
+    }
+
+    return true;
+}
+
+
+bool read_job_file(const char* filename, int min_fields, int max_fields,
+                   vector<job_t>& jobs, string& error)
+{
+    ifstream ifs(filename);
+    if (!ifs)
+    {
+        error = string("Cannot read job file '") + filename + "'";
+        return false;
+    }
+
+    string line;
+    int line_number = 0;
+    while (getline(ifs, line))
+    {
+        line_number++;
+
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#') { continue; }
+
+        istringstream fields(line);
+        job_t job;
+        int value;
+        while (fields >> value) { job.push_back(value); }
+
+        if (!fields.eof() || (int) job.size() < min_fields || (int) job.size() > max_fields)
+        {
+            ostringstream message;
+            message << filename << ":" << line_number << ": expected " << min_fields;
+            if (max_fields > min_fields) { message << " to " << max_fields; }
+            message << " integers";
+            error = message.str();
+            return false;
+        }
+        jobs.push_back(job);
+    }
+
+    return true;
+}
+
+
+verbosity_t take_verbosity(int& argc, char** argv)
+{
+    verbosity_t verbosity = verbosity_summary;
+    int kept = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const string option = argv[i];
+
+        if (option == "-q")      { verbosity = verbosity_quiet; }
+        else if (option == "-v") { verbosity = verbosity_trace; }
+        else if (option == "--verbosity" && i + 1 < argc)
+        {
+            const int level = atoi(argv[++i]);
+            verbosity = (level <= 0) ? verbosity_quiet : (level == 1) ? verbosity_summary : verbosity_trace;
+        }
+        else { argv[kept++] = argv[i]; }
+    }
+    argc = kept;
+
+    return verbosity;
+}
+
+
+bool take_option(int& argc, char** argv, const char* name, string& value)
+{
+    bool found = false;
+    int kept = 1;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (name == string(argv[i]) && i + 1 < argc)
+        {
+            value = argv[++i];
+            found = true;
+        }
+        else { argv[kept++] = argv[i]; }
+    }
+    argc = kept;
+
+    return found;
+}
+
+
+string output_path(const string& dir, const string& filename)
+{
+    if (dir.empty()) { return filename; }
+    if (dir[dir.size() - 1] == '/') { return dir + filename; }
+
+    return dir + "/" + filename;
+}
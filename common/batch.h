@@ -0,0 +1,79 @@
+/*
+ * batch.h
+ * Command line and job file parsing of the batch modes.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_BATCH_H
+#define MISC_BATCH_H
+
+#include <string>
+#include <vector>
+
+
+/*
+ * one line of a job file, e.g. "13 20" for mask 13 and 20 subdivision steps
+ */
+typedef std::vector<int> job_t;
+
+/*
+ * @param text comma separated integers, e.g. "2,3,13"
+ * @param values parsed integers are appended
+ * @return false if text contains anything but integers and commas
+ */
+bool parse_int_list(const char* text, std::vector<int>& values);
+
+/*
+ * Read a job file with one job per line. Empty lines and lines starting
+ * with '#' are skipped.
+ * @param filename job file
+ * @param min_fields minimal number of integers per line
+ * @param max_fields maximal number of integers per line
+ * @param jobs parsed lines are appended
+ * @param error description of the first error
+ * @return false if the file cannot be read or a line is malformed
+ */
+bool read_job_file(const char* filename, int min_fields, int max_fields,
+                   std::vector<job_t>& jobs, std::string& error);
+
+/*
+ * console output of the programs
+ */
+typedef enum {
+    verbosity_quiet = 0,   /* results and errors only */
+    verbosity_summary = 1, /* level sizes, ranges and timings (default) */
+    verbosity_trace = 2    /* additionally every computed sample */
+}verbosity_t;
+
+/*
+ * Remove the options -q (quiet), -v (trace) and --verbosity {0,1,2} from
+ * the command line.
+ * @param argc number of arguments, reduced by the removed ones
+ * @param argv arguments, the remaining ones are moved to the front
+ * @return selected verbosity, verbosity_summary if none is given
+ */
+verbosity_t take_verbosity(int& argc, char** argv);
+
+/*
+ * Remove the option "name value" from the command line.
+ * @param argc number of arguments, reduced by the removed ones
+ * @param argv arguments, the remaining ones are moved to the front
+ * @param name option, e.g. "--format"
+ * @param value value of the last occurrence of the option
+ * @return false if the option is not given or has no value
+ */
+bool take_option(int& argc, char** argv, const char* name, std::string& value);
+
+/*
+ * @param dir output directory, may be empty
+ * @param filename name of the output file
+ * @return dir/filename
+ */
+std::string output_path(const std::string& dir, const std::string& filename);
+
+#endif /* MISC_BATCH_H */
@@ -0,0 +1,236 @@
+/*
+ * output_writer.cpp
+ * Buffered output of sample tables as MATLAB script, NumPy array or raw
+ * little endian binary data.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <charconv>
+#include <cstring>
+#include <stdint.h>
+#include "output_writer.h"
+
+using namespace std;
+
+
+bool parse_output_format(const string& name, output_format_t& format)
+{
+    if (name == "m")        { format = format_matlab; }
+    else if (name == "npy") { format = format_npy; }
+    else if (name == "f64") { format = format_f64; }
+    else if (name == "f32") { format = format_f32; }
+    else { return false; }
+
+    return true;
+}
+
+
+const char* format_extension(output_format_t format)
+{
+    switch (format)
+    {
+        case format_npy: return ".npy";
+        case format_f64: return ".f64";
+        case format_f32: return ".f32";
+        default:         return ".m";
+    }
+}
+
+
+BufferedWriter::BufferedWriter(size_t buffer_size)
+    : file(NULL), buffer(buffer_size > 0 ? buffer_size : 1), used(0), error(false)
+{
+}
+
+
+BufferedWriter::~BufferedWriter()
+{
+    close();
+}
+
+
+bool BufferedWriter::open(const char* filename)
+{
+    close();
+    error = false;
+
+    file = fopen(filename, "wb");
+    if (file == NULL)
+    {
+        error = true;
+        return false;
+    }
+    setvbuf(file, NULL, _IONBF, 0); /* the buffer of this class is sufficient */
+
+    return true;
+}
+
+
+bool BufferedWriter::close()
+{
+    if (file == NULL) { return !error; }
+
+    flush();
+    if (fclose(file) != 0) { error = true; }
+    file = NULL;
+
+    return !error;
+}
+
+
+void BufferedWriter::flush()
+{
+    if (used > 0 && file != NULL)
+    {
+        if (fwrite(buffer.data(), 1, used, file) != used) { error = true; }
+    }
+    used = 0;
+}
+
+
+void BufferedWriter::write(const void* data, size_t bytes)
+{
+    if (file == NULL) { error = true; return; }
+
+    if (used + bytes <= buffer.size())
+    {
+        memcpy(buffer.data() + used, data, bytes);
+        used += bytes;
+        return;
+    }
+
+    /* large blocks bypass the buffer */
+    flush();
+    if (bytes >= buffer.size())
+    {
+        if (fwrite(data, 1, bytes, file) != bytes) { error = true; }
+    }
+    else
+    {
+        memcpy(buffer.data(), data, bytes);
+        used = bytes;
+    }
+}
+
+
+void BufferedWriter::write_values(const double* values, size_t n, output_format_t format)
+{
+    const bool little_endian = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+    if (format != format_f32 && little_endian)
+    {
+        write(values, n * sizeof(double));
+        return;
+    }
+
+    /* convert in blocks */
+    const size_t block = 4096;
+    unsigned char converted[block * sizeof(double)];
+    for (size_t begin = 0; begin < n; begin += block)
+    {
+        const size_t count = (n - begin < block) ? n - begin : block;
+        size_t bytes = 0;
+
+        for (size_t i = begin; i < begin + count; i++)
+        {
+            if (format == format_f32)
+            {
+                const float value = (float) values[i];
+                uint32_t bits;
+                memcpy(&bits, &value, sizeof(bits));
+                for (int b = 0; b < 4; b++) { converted[bytes++] = (unsigned char) (bits >> (8*b)); }
+            }
+            else
+            {
+                uint64_t bits;
+                memcpy(&bits, &values[i], sizeof(bits));
+                for (int b = 0; b < 8; b++) { converted[bytes++] = (unsigned char) (bits >> (8*b)); }
+            }
+        }
+        write(converted, bytes);
+    }
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(const char* text)
+{
+    write(text, strlen(text));
+    return *this;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(const string& text)
+{
+    write(text.data(), text.size());
+    return *this;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(char c)
+{
+    write(&c, 1);
+    return *this;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(int value)
+{
+    return *this << (long) value;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(long value)
+{
+    char text[32];
+    const to_chars_result result = to_chars(text, text + sizeof(text), value);
+    write(text, result.ptr - text);
+    return *this;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(unsigned long value)
+{
+    char text[32];
+    const to_chars_result result = to_chars(text, text + sizeof(text), value);
+    write(text, result.ptr - text);
+    return *this;
+}
+
+
+BufferedWriter& BufferedWriter::operator<<(double value)
+{
+    /* shortest representation that reads back to the same double */
+    char text[64];
+    const to_chars_result result = to_chars(text, text + sizeof(text), value);
+    write(text, result.ptr - text);
+    return *this;
+}
+
+
+void write_npy_header(BufferedWriter& out, const vector<size_t>& shape)
+{
+    string header = "{'descr': '<f8', 'fortran_order': False, 'shape': (";
+    for (size_t i = 0; i < shape.size(); i++)
+    {
+        header += to_string(shape[i]);
+        if (shape.size() == 1 || i + 1 < shape.size()) { header += ","; }
+        if (i + 1 < shape.size()) { header += " "; }
+    }
+    header += "), }";
+
+    /* magic (6) + version (2) + header length (2) + header + '\n' is a multiple of 64 */
+    const size_t unpadded = 10 + header.size() + 1;
+    header.append((64 - unpadded % 64) % 64, ' ');
+    header += '\n';
+
+    const unsigned char preamble[10] = {0x93, 'N', 'U', 'M', 'P', 'Y', 1, 0,
+                                        (unsigned char) (header.size() & 0xff),
+                                        (unsigned char) (header.size() >> 8)};
+    out.write(preamble, sizeof(preamble));
+    out << header;
+}
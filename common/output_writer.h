@@ -0,0 +1,106 @@
+/*
+ * output_writer.h
+ * Buffered output of sample tables as MATLAB script, NumPy array or raw
+ * little endian binary data.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_OUTPUT_WRITER_H
+#define MISC_OUTPUT_WRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/*
+ * supported output formats
+ */
+typedef enum {
+    format_matlab = 0, /* MATLAB script with plot commands (.m) */
+    format_npy,        /* NumPy array, float64 (.npy) */
+    format_f64,        /* raw little endian float64 (.f64) */
+    format_f32         /* raw little endian float32 (.f32) */
+}output_format_t;
+
+/*
+ * @param name "m", "npy", "f64" or "f32"
+ * @param format parsed format
+ * @return false if name is no supported format
+ */
+bool parse_output_format(const std::string& name, output_format_t& format);
+
+/* file name extension including the dot, e.g. ".npy" */
+const char* format_extension(output_format_t format);
+
+
+/*
+ * File writer with a large buffer of its own. Blocks larger than the buffer
+ * are passed to the operating system directly, so big tables are written
+ * at disk bandwidth. Numbers written as text use the shortest decimal
+ * representation which reads back to the same double.
+ */
+class BufferedWriter
+{
+public:
+    /*
+     * @param buffer_size bytes collected before a write to the file
+     */
+    explicit BufferedWriter(size_t buffer_size = ((size_t) 1 << 22));
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    bool open(const char* filename);
+
+    /* flush and close, false if any write failed */
+    bool close();
+
+    bool is_open() const { return file != NULL; }
+    bool failed() const { return error; }
+
+    void write(const void* data, size_t bytes);
+
+    /*
+     * @param values samples, written as little endian float64 or float32
+     * @param n number of samples
+     * @param format format_f32 converts to float32, every other format
+     *        writes float64
+     */
+    void write_values(const double* values, size_t n, output_format_t format = format_f64);
+
+    BufferedWriter& operator<<(const char* text);
+    BufferedWriter& operator<<(const std::string& text);
+    BufferedWriter& operator<<(char c);
+    BufferedWriter& operator<<(int value);
+    BufferedWriter& operator<<(long value);
+    BufferedWriter& operator<<(unsigned long value);
+    BufferedWriter& operator<<(double value);
+
+private:
+    void flush();
+
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t used;
+    bool error;
+};
+
+
+/*
+ * Write the header of a NumPy .npy file (format version 1.0) for a C-order
+ * float64 array. The header is padded so that the data starts at a multiple
+ * of 64 bytes and can be memory mapped.
+ * @param out writer positioned at the start of the file
+ * @param shape dimensions of the array
+ */
+void write_npy_header(BufferedWriter& out, const std::vector<size_t>& shape);
+
+#endif /* MISC_OUTPUT_WRITER_H */
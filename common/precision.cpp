@@ -0,0 +1,50 @@
+/*
+ * precision.cpp
+ * Scalar types of the precision templated engines: float, double, long
+ * double and the double-double type dd_real.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include "precision.h"
+
+using namespace std;
+
+static const char* const precision_names[] = {"float", "double", "long_double", "double_double"};
+
+
+bool parse_precision(const string& name, precision_t& precision)
+{
+    for (int p = precision_float; p <= precision_double_double; p++)
+    {
+        if (name == precision_names[p])
+        {
+            precision = (precision_t) p;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+const char* precision_name(precision_t precision)
+{
+    return precision_names[precision];
+}
+
+
+double unit_roundoff(precision_t precision)
+{
+    switch (precision)
+    {
+        case precision_float:         return ldexp(1.0, -24);
+        case precision_long_double:   return ldexp(1.0, -64);
+        case precision_double_double: return ldexp(1.0, -106);
+        default:                      return ldexp(1.0, -53);
+    }
+}
@@ -0,0 +1,187 @@
+/*
+ * precision.h
+ * Scalar types of the precision templated engines: float, double, long
+ * double and the double-double type dd_real.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_PRECISION_H
+#define MISC_PRECISION_H
+
+#include <cmath>
+#include <string>
+
+
+/*
+ * scalar types of the engines
+ */
+typedef enum {
+    precision_float = 0,     /* 24 bit mantissa, twice the SIMD lanes of double */
+    precision_double,        /* 53 bit mantissa */
+    precision_long_double,   /* 64 bit mantissa of the x87 format on x86 */
+    precision_double_double  /* about 106 bit mantissa, dd_real */
+}precision_t;
+
+/*
+ * @param name "float", "double", "long_double" or "double_double"
+ * @param precision parsed precision
+ * @return false if name is no supported precision
+ */
+bool parse_precision(const std::string& name, precision_t& precision);
+
+const char* precision_name(precision_t precision);
+
+/* unit roundoff of the precision, e.g. 2^-53 for double */
+double unit_roundoff(precision_t precision);
+
+/*
+ * one row of a precision report: the time of a computation in one
+ * precision and the largest absolute difference of its result to the
+ * double-double one, 0 for double-double itself
+ */
+typedef struct {
+    double seconds;
+    double difference;
+}precision_run_t;
+
+
+/*
+ * Double-double number hi + lo with |lo| <= ulp(hi) / 2, the sum and the
+ * product are computed by the error-free transformations TwoSum and
+ * TwoProd (by fused multiply-add). The transformations need IEEE double
+ * arithmetic without contraction or excess precision, which the build
+ * flags -ffp-contract=off and SSE2 doubles provide.
+ */
+struct dd_real
+{
+    double hi;
+    double lo;
+
+    dd_real() = default;
+    constexpr dd_real(double value) : hi(value), lo(0.0) {}
+    constexpr dd_real(int value) : hi(value), lo(0.0) {}
+    constexpr dd_real(double high, double low) : hi(high), lo(low) {}
+    explicit dd_real(long double value)
+        : hi((double) value), lo((double) (value - (long double) (double) value)) {}
+
+    explicit operator double() const { return hi + lo; }
+    explicit operator float() const { return (float) (hi + lo); }
+    explicit operator long double() const { return (long double) hi + (long double) lo; }
+
+    dd_real& operator+=(const dd_real& b);
+    dd_real& operator-=(const dd_real& b);
+    dd_real& operator*=(const dd_real& b);
+    dd_real& operator/=(const dd_real& b);
+};
+
+
+/* s + e = a + b exactly */
+inline dd_real two_sum(double a, double b)
+{
+    const double s = a + b;
+    const double v = s - a;
+    return dd_real(s, (a - (s - v)) + (b - v));
+}
+
+/* s + e = a + b exactly for |a| >= |b| */
+inline dd_real quick_two_sum(double a, double b)
+{
+    const double s = a + b;
+    return dd_real(s, b - (s - a));
+}
+
+/* p + e = a b exactly */
+inline dd_real two_prod(double a, double b)
+{
+    const double p = a * b;
+    return dd_real(p, std::fma(a, b, -p));
+}
+
+
+inline dd_real operator-(const dd_real& a)
+{
+    return dd_real(-a.hi, -a.lo);
+}
+
+inline dd_real operator+(const dd_real& a, const dd_real& b)
+{
+    dd_real s = two_sum(a.hi, b.hi);
+    const dd_real t = two_sum(a.lo, b.lo);
+    s = quick_two_sum(s.hi, s.lo + t.hi);
+    return quick_two_sum(s.hi, s.lo + t.lo);
+}
+
+inline dd_real operator-(const dd_real& a, const dd_real& b)
+{
+    return a + (-b);
+}
+
+inline dd_real operator*(const dd_real& a, const dd_real& b)
+{
+    const dd_real p = two_prod(a.hi, b.hi);
+    return quick_two_sum(p.hi, p.lo + (a.hi * b.lo + a.lo * b.hi));
+}
+
+inline dd_real operator/(const dd_real& a, const dd_real& b)
+{
+    /* three quotient digits of double precision, each from the remainder */
+    const double q1 = a.hi / b.hi;
+    dd_real r = a - q1 * b;
+    const double q2 = r.hi / b.hi;
+    r = r - q2 * b;
+    const double q3 = r.hi / b.hi;
+    return quick_two_sum(q1, q2) + dd_real(q3);
+}
+
+inline dd_real& dd_real::operator+=(const dd_real& b) { return *this = *this + b; }
+inline dd_real& dd_real::operator-=(const dd_real& b) { return *this = *this - b; }
+inline dd_real& dd_real::operator*=(const dd_real& b) { return *this = *this * b; }
+inline dd_real& dd_real::operator/=(const dd_real& b) { return *this = *this / b; }
+
+inline bool operator==(const dd_real& a, const dd_real& b) { return a.hi == b.hi && a.lo == b.lo; }
+inline bool operator!=(const dd_real& a, const dd_real& b) { return !(a == b); }
+inline bool operator<(const dd_real& a, const dd_real& b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+inline bool operator>(const dd_real& a, const dd_real& b) { return b < a; }
+inline bool operator<=(const dd_real& a, const dd_real& b) { return !(b < a); }
+inline bool operator>=(const dd_real& a, const dd_real& b) { return !(a < b); }
+
+inline dd_real fabs(const dd_real& a)
+{
+    return (a.hi < 0.0) ? -a : a;
+}
+
+inline dd_real floor(const dd_real& a)
+{
+    const double high = std::floor(a.hi);
+    if (high != a.hi) { return dd_real(high); }
+
+    /* hi is an integer, the fraction is in lo */
+    return quick_two_sum(high, std::floor(a.lo));
+}
+
+inline dd_real ldexp(const dd_real& a, int e)
+{
+    return dd_real(std::ldexp(a.hi, e), std::ldexp(a.lo, e));
+}
+
+inline bool isfinite(const dd_real& a)
+{
+    return std::isfinite(a.hi);
+}
+
+
+/*
+ * nearest double of a value of any precision, for output and reports
+ */
+template <typename T>
+inline double to_double(T value)
+{
+    return (double) value;
+}
+
+#endif /* MISC_PRECISION_H */
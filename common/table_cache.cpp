@@ -0,0 +1,467 @@
+/*
+ * table_cache.cpp
+ * On-disk cache of precomputed sample tables, shared by processes.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <ctime>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "table_cache.h"
+#include "thread_pool.h"
+
+using namespace std;
+
+/*
+ * header of a table file, the values follow at offset 64
+ */
+typedef struct {
+    char magic[8];
+    uint64_t key;
+    uint64_t count;
+    uint64_t reserved[5];
+}table_header_t;
+
+static const char table_magic[8] = {'M', 'I', 'S', 'C', 'T', 'B', 'L', '1'};
+
+/* temporary files older than this belong to generators which did not finish */
+static const time_t stale_seconds = 3600;
+
+
+TableKey& TableKey::add(const void* data, size_t bytes)
+{
+    const unsigned char* byte = (const unsigned char*) data;
+    for (size_t i = 0; i < bytes; i++)
+    {
+        hash = (hash ^ byte[i]) * 1099511628211ULL;
+    }
+
+    return *this;
+}
+
+
+TableKey& TableKey::add(const string& text)
+{
+    add((long long) text.size());
+    return add(text.data(), text.size());
+}
+
+
+
+MappedTable::MappedTable(MappedTable&& other)
+    : address(other.address), bytes(other.bytes), count(other.count)
+{
+    other.address = NULL;
+    other.bytes = 0;
+    other.count = 0;
+}
+
+
+MappedTable& MappedTable::operator=(MappedTable&& other)
+{
+    if (this != &other)
+    {
+        unmap();
+        swap(address, other.address);
+        swap(bytes, other.bytes);
+        swap(count, other.count);
+    }
+
+    return *this;
+}
+
+
+const double* MappedTable::data() const
+{
+    return (address == NULL) ? NULL : (const double*) ((const char*) address + sizeof(table_header_t));
+}
+
+
+bool MappedTable::map(int file, uint64_t key, size_t values)
+{
+    unmap();
+
+    struct stat status;
+    if (fstat(file, &status) != 0 || (size_t) status.st_size != sizeof(table_header_t) + values * sizeof(double))
+    {
+        return false;
+    }
+
+    void* mapped = mmap(NULL, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+    if (mapped == MAP_FAILED) { return false; }
+
+    const table_header_t* header = (const table_header_t*) mapped;
+    if (memcmp(header->magic, table_magic, sizeof(table_magic)) != 0 || header->key != key || header->count != values)
+    {
+        munmap(mapped, status.st_size);
+        return false;
+    }
+
+    address = mapped;
+    bytes = status.st_size;
+    count = values;
+    return true;
+}
+
+
+void MappedTable::unmap()
+{
+    if (address != NULL) { munmap(address, bytes); }
+    address = NULL;
+    bytes = 0;
+    count = 0;
+}
+
+
+
+TableCache::TableCache(const string& directory, unsigned long long capacity)
+    : directory(directory), capacity(capacity), created(false)
+{
+    if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST) { return; }
+
+    const int file = open((directory + "/lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (file >= 0) { close(file); }
+    created = (file >= 0);
+}
+
+
+string TableCache::table_path(uint64_t key) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.tbl", (unsigned long long) key);
+    return directory + name;
+}
+
+
+int TableCache::lock(long long offset) const
+{
+    /*
+     * open file description locks belong to the description, a new one per
+     * call excludes the threads sharing this instance like other processes
+     */
+    const int file = open((directory + "/lock").c_str(), O_RDWR | O_CLOEXEC);
+    if (file < 0) { return -1; }
+
+    struct flock range;
+    memset(&range, 0, sizeof(range));
+    range.l_type = F_WRLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = offset;
+    range.l_len = 1;
+
+    while (fcntl(file, F_OFD_SETLKW, &range) != 0)
+    {
+        if (errno != EINTR)
+        {
+            close(file);
+            return -1;
+        }
+    }
+
+    return file;
+}
+
+
+void TableCache::unlock(int file) const
+{
+    /* closing the only descriptor of the description releases its lock */
+    close(file);
+}
+
+
+bool TableCache::find(uint64_t key, size_t count, MappedTable& table) const
+{
+    const int file = open(table_path(key).c_str(), O_RDONLY | O_CLOEXEC);
+    if (file < 0) { return false; }
+
+    const bool mapped = table.map(file, key, count);
+    if (mapped)
+    {
+        /* the modification time orders the tables for the eviction */
+        futimens(file, NULL);
+    }
+    close(file);
+
+    return mapped;
+}
+
+
+bool TableCache::fetch(uint64_t key, size_t count, const table_generator_t& generate, MappedTable& table,
+                       bool* generated)
+{
+    if (generated != NULL) { *generated = false; }
+    if (!valid()) { return false; }
+    if (find(key, count, table)) { return true; }
+
+    const int key_lock = lock(1 + (long long) (key & 0x3FFFFFFF));
+    if (key_lock < 0) { return false; }
+
+    /* another process or thread may have generated the table while we waited */
+    if (find(key, count, table))
+    {
+        unlock(key_lock);
+        return true;
+    }
+
+    /* unique name, distinct keys sharing a lock byte are generated at the same time */
+    vector<char> temporary(table_path(key).size() + 12);
+    snprintf(temporary.data(), temporary.size(), "%s.XXXXXX.tmp", table_path(key).c_str());
+    const size_t bytes = sizeof(table_header_t) + count * sizeof(double);
+
+    bool stored = false;
+    const int file = mkostemps(temporary.data(), 4, O_CLOEXEC);
+    if (file >= 0)
+    {
+        fchmod(file, 0644);
+        void* mapped = (ftruncate(file, bytes) == 0)
+                       ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) : MAP_FAILED;
+        if (mapped != MAP_FAILED)
+        {
+            /* the values are generated straight into the file */
+            if (generated != NULL) { *generated = true; }
+            if (generate((double*) ((char*) mapped + sizeof(table_header_t)), count))
+            {
+                table_header_t* header = (table_header_t*) mapped;
+                memcpy(header->magic, table_magic, sizeof(table_magic));
+                header->key = key;
+                header->count = count;
+                stored = true;
+            }
+            munmap(mapped, bytes);
+        }
+
+        /* the data reaches the disk before the table gets its name */
+        stored = stored && fsync(file) == 0 && rename(temporary.data(), table_path(key).c_str()) == 0;
+        close(file);
+        if (!stored) { unlink(temporary.data()); }
+    }
+
+    stored = stored && find(key, count, table);
+    unlock(key_lock);
+
+    if (stored) { evict(key); }
+    return stored;
+}
+
+
+/*
+ * file of the cache directory
+ */
+typedef struct {
+    string name;
+    unsigned long long bytes;
+    struct timespec modified;
+}cache_entry_t;
+
+static bool ends_with(const string& text, const char* suffix)
+{
+    const size_t n = strlen(suffix);
+    return text.size() >= n && text.compare(text.size() - n, n, suffix) == 0;
+}
+
+/*
+ * @param directory cache directory
+ * @param suffix ".tbl" or ".tmp"
+ * @return the files with this suffix
+ */
+static vector<cache_entry_t> list_files(const string& directory, const char* suffix)
+{
+    vector<cache_entry_t> entries;
+    DIR* listing = opendir(directory.c_str());
+    if (listing == NULL) { return entries; }
+
+    while (const struct dirent* file = readdir(listing))
+    {
+        const string name = file->d_name;
+        struct stat status;
+        if (!ends_with(name, suffix) || stat((directory + "/" + name).c_str(), &status) != 0) { continue; }
+
+        entries.push_back({name, (unsigned long long) status.st_size, status.st_mtim});
+    }
+    closedir(listing);
+
+    return entries;
+}
+
+
+unsigned long long TableCache::evict(uint64_t keep)
+{
+    const int eviction_lock = valid() ? lock(0) : -1;
+    if (eviction_lock < 0) { return 0; }
+
+    unsigned long long removed = 0;
+    const time_t now = time(NULL);
+    for (const cache_entry_t& entry : list_files(directory, ".tmp"))
+    {
+        if (now - entry.modified.tv_sec > stale_seconds && unlink((directory + "/" + entry.name).c_str()) == 0)
+        {
+            removed += entry.bytes;
+        }
+    }
+
+    vector<cache_entry_t> tables = list_files(directory, ".tbl");
+    unsigned long long total = 0;
+    for (const cache_entry_t& entry : tables) { total += entry.bytes; }
+
+    /* least recently used first */
+    sort(tables.begin(), tables.end(), [] (const cache_entry_t& a, const cache_entry_t& b) {
+        return a.modified.tv_sec < b.modified.tv_sec
+               || (a.modified.tv_sec == b.modified.tv_sec && a.modified.tv_nsec < b.modified.tv_nsec);
+    });
+
+    const string kept = table_path(keep).substr(directory.size() + 1);
+    for (size_t i = 0; i < tables.size() && total > capacity; i++)
+    {
+        if (tables[i].name == kept) { continue; }
+
+        /* processes which mapped the table keep their mapping */
+        if (unlink((directory + "/" + tables[i].name).c_str()) == 0)
+        {
+            total -= tables[i].bytes;
+            removed += tables[i].bytes;
+        }
+    }
+
+    unlock(eviction_lock);
+    return removed;
+}
+
+
+void TableCache::clear()
+{
+    const int eviction_lock = valid() ? lock(0) : -1;
+    if (eviction_lock < 0) { return; }
+
+    for (const cache_entry_t& entry : list_files(directory, ".tbl"))
+    {
+        unlink((directory + "/" + entry.name).c_str());
+    }
+
+    unlock(eviction_lock);
+}
+
+
+unsigned long long TableCache::size() const
+{
+    unsigned long long total = 0;
+    for (const cache_entry_t& entry : list_files(directory, ".tbl")) { total += entry.bytes; }
+
+    return total;
+}
+
+
+
+bool verify_table_cache(ostream* log)
+{
+    char directory[] = "/tmp/table_cache_XXXXXX";
+    if (mkdtemp(directory) == NULL) { return false; }
+
+    const size_t count = 10000;
+    const unsigned long long table_bytes = sizeof(table_header_t) + count * sizeof(double);
+    const auto generate = [] (int seed) {
+        return [seed] (double* values, size_t n) {
+            for (size_t k = 0; k < n; k++) { values[k] = sin(seed + 0.001 * k); }
+            return true;
+        };
+    };
+
+    bool valid;
+    {
+        TableCache cache(directory, 2 * table_bytes);
+        vector<double> direct(count);
+        valid = cache.valid() && generate(1)(direct.data(), count);
+
+        /* miss and hit of one table */
+        const uint64_t a = TableKey().add(string("first")).value();
+        MappedTable first, second;
+        bool generated_first, generated_second;
+        valid = valid && cache.fetch(a, count, generate(1), first, &generated_first)
+                && cache.fetch(a, count, generate(1), second, &generated_second)
+                && generated_first && !generated_second
+                && memcmp(first.data(), direct.data(), count * sizeof(double)) == 0
+                && memcmp(second.data(), direct.data(), count * sizeof(double)) == 0;
+
+        /* a table of another length is no hit */
+        MappedTable other;
+        valid = valid && !cache.find(a, count + 1, other);
+
+        /* nor is a table stored under the name of another key */
+        const uint64_t renamed = TableKey().add(string("renamed")).value();
+        valid = valid && link(cache.table_path(a).c_str(), cache.table_path(renamed).c_str()) == 0
+                && !cache.find(renamed, count, other);
+        unlink(cache.table_path(renamed).c_str());
+
+        /* two processes generate one table */
+        const uint64_t b = TableKey().add(string("processes")).value();
+        const string marks = string(directory) + "/generated";
+        const auto mark = [&] (double* values, size_t n) {
+            FILE* file = fopen(marks.c_str(), "a");
+            if (file == NULL) { return false; }
+            fputs("x", file);
+            fclose(file);
+            usleep(100000);
+            for (size_t k = 0; k < n; k++) { values[k] = (double) k; }
+            return true;
+        };
+        if (log != NULL) { log->flush(); }
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            TableCache shared(directory, 2 * table_bytes);
+            MappedTable table;
+            _exit(shared.fetch(b, 1000, mark, table) && table.data()[999] == 999.0 ? 0 : 1);
+        }
+        MappedTable parent;
+        int status = 1;
+        valid = valid && child > 0 && cache.fetch(b, 1000, mark, parent) && parent.data()[999] == 999.0
+                && waitpid(child, &status, 0) == child && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+        struct stat marked;
+        valid = valid && stat(marks.c_str(), &marked) == 0 && marked.st_size == 1;
+        unlink(marks.c_str());
+
+        /* two threads sharing the instance generate one table */
+        const uint64_t d = TableKey().add(string("threads")).value();
+        ThreadPool workers(2);
+        MappedTable fetched[2];
+        bool found[2] = {false, false};
+        workers.run(2, [&] (size_t i) {
+            found[i] = cache.fetch(d, 1000, mark, fetched[i]) && fetched[i].data()[999] == 999.0;
+        });
+        valid = valid && found[0] && found[1] && stat(marks.c_str(), &marked) == 0 && marked.st_size == 1;
+        unlink(marks.c_str());
+
+        /* a, b, d, then c: b and d are the least recently used after the hit of a */
+        usleep(10000);
+        const uint64_t c = TableKey().add(string("third")).value();
+        MappedTable hit, third;
+        valid = valid && cache.find(a, count, hit) && cache.fetch(c, count - 1, generate(3), third)
+                && cache.find(a, count, hit) && !cache.find(b, 1000, other)
+                && cache.size() <= 2 * table_bytes + 8 * 64;
+
+        cache.clear();
+        valid = valid && cache.size() == 0;
+    }
+    unlink((string(directory) + "/lock").c_str());
+    valid = (rmdir(directory) == 0) && valid;
+
+    if (log != NULL)
+    {
+        *log << "Table cache: " << (valid ? "miss, hit, two processes, two threads and eviction agree" : "FAILED") << "\n";
+    }
+    return valid;
+}
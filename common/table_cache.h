@@ -0,0 +1,167 @@
+/*
+ * table_cache.h
+ * On-disk cache of precomputed sample tables, shared by processes.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_TABLE_CACHE_H
+#define MISC_TABLE_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+
+
+/*
+ * 64 bit FNV-1a hash of everything that determines a table, e.g. the
+ * mask coefficients, the depth and the precision, fed field by field
+ */
+class TableKey
+{
+public:
+    TableKey() : hash(14695981039346656037ULL) {}
+
+    TableKey& add(const void* data, size_t bytes);
+    TableKey& add(const std::string& text);
+    TableKey& add(long long value) { return add(&value, sizeof(value)); }
+    TableKey& add(int value) { return add((long long) value); }
+    TableKey& add(double value) { return add(&value, sizeof(value)); }
+
+    uint64_t value() const { return hash; }
+
+private:
+    uint64_t hash;
+};
+
+
+/*
+ * Read-only mapping of a cached table, valid until destroyed even if the
+ * file is evicted meanwhile.
+ */
+class MappedTable
+{
+public:
+    MappedTable() : address(NULL), bytes(0), count(0) {}
+    ~MappedTable() { unmap(); }
+
+    MappedTable(MappedTable&& other);
+    MappedTable& operator=(MappedTable&& other);
+    MappedTable(const MappedTable&) = delete;
+    MappedTable& operator=(const MappedTable&) = delete;
+
+    bool valid() const { return address != NULL; }
+
+    /* count doubles, 64 byte aligned */
+    const double* data() const;
+    size_t size() const { return count; }
+
+    /* maps the whole file, false if it is no complete table of key with count values */
+    bool map(int file, uint64_t key, size_t count);
+    void unmap();
+
+private:
+    void* address;
+    size_t bytes;
+    size_t count;
+};
+
+
+/*
+ * fills values[0..count-1], false if the table cannot be computed
+ */
+typedef std::function<bool (double* values, size_t count)> table_generator_t;
+
+/*
+ * Directory of tables <key>.tbl: a 64 byte header (magic, key, count)
+ * followed by count doubles in native byte order, so a table is used by
+ * mapping the file. A missing table is generated into a uniquely named
+ * temporary file in the directory and renamed to its name, readers never
+ * see partial tables. Open file description locks on the file "lock"
+ * serialize the generation of each key and the eviction over all processes
+ * and threads, so every table is generated once even if several of them
+ * miss it at the same time. Hits update the modification time, evict()
+ * removes the least recently used tables until the directory is below its
+ * capacity. One instance may be shared by threads.
+ */
+class TableCache
+{
+public:
+    /*
+     * @param directory created if it does not exist
+     * @param capacity bytes of all tables, exceeded at most by the table
+     *        generated last
+     */
+    TableCache(const std::string& directory, unsigned long long capacity);
+
+    TableCache(const TableCache&) = delete;
+    TableCache& operator=(const TableCache&) = delete;
+
+    /* false if the directory or its lock file cannot be created */
+    bool valid() const { return created; }
+
+    /*
+     * @param key hash of the table
+     * @param count number of values the table must have
+     * @param table mapping of the table
+     * @return false if the table is not cached
+     */
+    bool find(uint64_t key, size_t count, MappedTable& table) const;
+
+    /*
+     * The cached table, or the table generated on a miss and stored.
+     * @param generate computes the table, called at most once
+     * @param generated set to true if generate was called, may be NULL
+     * @return false if the generator failed or the table cannot be stored
+     */
+    bool fetch(uint64_t key, size_t count, const table_generator_t& generate, MappedTable& table,
+               bool* generated = NULL);
+
+    /*
+     * removes the least recently used tables until at most capacity bytes
+     * remain, and temporary files of processes which did not finish
+     * @param keep key of a table which is not removed
+     * @return bytes removed
+     */
+    unsigned long long evict(uint64_t keep = 0);
+
+    /* removes every table */
+    void clear();
+
+    /* bytes of all tables in the directory */
+    unsigned long long size() const;
+
+    std::string table_path(uint64_t key) const;
+
+private:
+    /*
+     * byte 0 of the lock file guards the eviction, byte 1 + key mod 2^30 the generation
+     * @return descriptor holding the lock, -1 on failure
+     */
+    int lock(long long offset) const;
+    void unlock(int file) const;
+
+    std::string directory;
+    unsigned long long capacity;
+    bool created;
+};
+
+
+/*
+ * Table cache in a fresh directory below /tmp: a miss generates the table,
+ * a hit maps the same bytes, a table of another length or key is no hit,
+ * two processes or two threads missing the same key at the same time
+ * generate it once, and the eviction removes the least recently used
+ * tables.
+ * @param log receives a summary line, may be NULL
+ * @return true if all checks pass
+ */
+bool verify_table_cache(std::ostream* log);
+
+#endif /* MISC_TABLE_CACHE_H */
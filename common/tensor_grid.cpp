@@ -0,0 +1,148 @@
+/*
+ * tensor_grid.cpp
+ * Tensor products of sampled univariate functions on large 2D grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <new>
+#include "aligned_buffer.h"
+#include "tensor_grid.h"
+
+using namespace std;
+
+/* columns of a tile, 8 KB of every row stay in the first level cache */
+static const size_t tile_columns = 1024;
+
+/* values of a strip, 2 MB fit into the second level cache of most cpus */
+static const size_t strip_values = (size_t) 1 << 18;
+
+
+/*
+ * rows [begin, end) of the grid into strip, tile by tile: the tile of f is
+ * read from the cache for every row
+ */
+static void tensor_strip(const double* f, size_t columns, const double* g, size_t begin, size_t end, double* strip)
+{
+    for (size_t c0 = 0; c0 < columns; c0 += tile_columns)
+    {
+        const size_t c1 = min(columns, c0 + tile_columns);
+        for (size_t i = begin; i < end; i++)
+        {
+            const double gi = g[i];
+            double* row = strip + (i - begin) * columns;
+            for (size_t j = c0; j < c1; j++) { row[j] = gi * f[j]; }
+        }
+    }
+}
+
+
+bool stream_tensor_product(const double* f, size_t columns, const double* g, size_t rows,
+                           ThreadPool* pool, const strip_consumer_t& consumer)
+{
+    if (rows == 0 || columns == 0) { return true; }
+
+    const size_t strip = max((size_t) 1, min(rows, strip_values / columns));
+    const size_t parallel = (pool == NULL) ? 1 : (size_t) pool->size();
+
+    AlignedBuffer<double> buffer;
+    try
+    {
+        buffer.resize(parallel * strip * columns);
+    }
+    catch (const bad_alloc&)
+    {
+        return false;
+    }
+
+    for (size_t first = 0; first < rows; first += parallel * strip)
+    {
+        /* up to one strip per thread */
+        const size_t strips = min(parallel, (rows - first + strip - 1) / strip);
+        const auto compute = [&] (size_t s) {
+            const size_t begin = first + s * strip;
+            tensor_strip(f, columns, g, begin, min(rows, begin + strip), buffer.data() + s * strip * columns);
+        };
+
+        if (strips > 1) { pool->run(strips, compute); }
+        else { compute(0); }
+
+        for (size_t s = 0; s < strips; s++)
+        {
+            const size_t begin = first + s * strip;
+            if (!consumer(begin, buffer.data() + s * strip * columns, min(strip, rows - begin)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool write_tensor_product(const char* filename, output_format_t format, const string& title,
+                          const double* x, const double* f, size_t columns,
+                          const double* y, const double* g, size_t rows,
+                          ThreadPool* pool, double& min_value, double& max_value)
+{
+    BufferedWriter ofs;
+    if (filename != NULL)
+    {
+        if (!ofs.open(filename)) { return false; }
+
+        if (format == format_npy) { write_npy_header(ofs, vector<size_t>{rows, columns}); }
+        if (format == format_matlab)
+        {
+            ofs << "X = [";
+            for (size_t j = 0; j < columns; j++) { ofs << x[j] << " "; }
+            ofs << "];\nY = [";
+            for (size_t i = 0; i < rows; i++) { ofs << y[i] << " "; }
+            ofs << "];\n\nZ = [";
+        }
+    }
+
+    min_value = HUGE_VAL;
+    max_value = -HUGE_VAL;
+
+    const bool streamed = stream_tensor_product(f, columns, g, rows, pool, [&] (size_t first, const double* values, size_t count) {
+        for (size_t k = 0; k < count * columns; k++)
+        {
+            min_value = min(min_value, values[k]);
+            max_value = max(max_value, values[k]);
+        }
+
+        if (filename == NULL) { return true; }
+        if (format == format_matlab)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t j = 0; j < columns; j++) { ofs << values[i * columns + j] << " "; }
+                ofs << ((first + i + 1 < rows) ? ";\n" : "");
+            }
+        }
+        else
+        {
+            ofs.write_values(values, count * columns, format);
+        }
+
+        return !ofs.failed();
+    });
+
+    if (filename == NULL) { return streamed; }
+
+    if (format == format_matlab)
+    {
+        ofs << "];\n\nfigure;\nsurf(X, Y, Z, 'EdgeColor', 'none');\n"
+            << "axis tight;\nset(gca, 'FontSize', 20);\n"
+            << "title('" << title << "');\n";
+    }
+
+    return ofs.close() && streamed;
+}
@@ -0,0 +1,63 @@
+/*
+ * tensor_grid.h
+ * Tensor products of sampled univariate functions on large 2D grids.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_TENSOR_GRID_H
+#define MISC_TENSOR_GRID_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include "thread_pool.h"
+#include "output_writer.h"
+
+
+/*
+ * Receives the rows first, ..., first + count - 1 of a grid in increasing
+ * order, row major with one value per column. The array is only valid
+ * during the call.
+ * @return false to stop the streaming
+ */
+typedef std::function<bool (size_t first, const double* values, size_t count)> strip_consumer_t;
+
+/*
+ * F[i][j] = g[i] * f[j] for rows i < rows and columns j < columns, the
+ * separable part is done: f and g are the samples of the univariate factors
+ * along the x axis (row pass) and the y axis (column pass), so the grid
+ * costs rows + columns univariate evaluations and one multiplication per
+ * point. The grid is produced in strips of rows, one strip per thread at a
+ * time, and every strip in tiles of columns which stay in the first level
+ * cache while the rows of the strip are written. Memory is bounded by the
+ * strip size times the number of threads for any grid.
+ * @param f values of the factor along the columns
+ * @param g values of the factor along the rows
+ * @param pool threads, NULL computes serially
+ * @param consumer receives the strips in order from the calling thread
+ * @return false if memory is exhausted or the consumer stopped
+ */
+bool stream_tensor_product(const double* f, size_t columns, const double* g, size_t rows,
+                           ThreadPool* pool, const strip_consumer_t& consumer);
+
+/*
+ * Writes the grid F[i][j] = g[i] * f[j] at the points (x[j], y[i]):
+ * format_matlab writes the axes X, Y, the matrix Z and a surface plot, the
+ * binary formats write Z row by row (NumPy with the shape rows x columns).
+ * @param filename output file, NULL only computes the range
+ * @param title title of the MATLAB plot
+ * @param min_value smallest value of the grid
+ * @param max_value largest value of the grid
+ * @return false if the file cannot be written or memory is exhausted
+ */
+bool write_tensor_product(const char* filename, output_format_t format, const std::string& title,
+                          const double* x, const double* f, size_t columns,
+                          const double* y, const double* g, size_t rows,
+                          ThreadPool* pool, double& min_value, double& max_value);
+
+#endif /* MISC_TENSOR_GRID_H */
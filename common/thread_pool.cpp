@@ -0,0 +1,141 @@
+/*
+ * thread_pool.cpp
+ * Fixed size pool of worker threads for the numerical engines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include "thread_pool.h"
+
+using namespace std;
+
+
+int ThreadPool::hardware_threads()
+{
+    const int n = (int) thread::hardware_concurrency();
+
+    return (n > 0) ? n : 1;
+}
+
+
+ThreadPool::ThreadPool(int threads)
+    : job(NULL), job_tasks(0), next_task(0), generation(0), busy(0), stop(false)
+{
+    if (threads <= 0) { threads = hardware_threads(); }
+
+    for (int i = 1; i < threads; i++)
+    {
+        workers.push_back(thread(&ThreadPool::work, this));
+    }
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        unique_lock<mutex> guard(lock);
+        stop = true;
+    }
+    wake.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+
+/*
+ * take task indices until none is left
+ */
+void ThreadPool::execute()
+{
+    for (size_t i = next_task++; i < job_tasks; i = next_task++)
+    {
+        (*job)(i);
+    }
+}
+
+
+void ThreadPool::work()
+{
+    size_t seen = 0;
+
+    for (;;)
+    {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stop || generation != seen; });
+            if (stop) { return; }
+            seen = generation;
+        }
+
+        execute();
+
+        {
+            unique_lock<mutex> guard(lock);
+            if (--busy == 0) { done.notify_one(); }
+        }
+    }
+}
+
+
+void ThreadPool::run(size_t tasks, const function<void (size_t)>& task)
+{
+    if (tasks == 0) { return; }
+
+    if (workers.empty() || tasks == 1)
+    {
+        for (size_t i = 0; i < tasks; i++) { task(i); }
+        return;
+    }
+
+    {
+        unique_lock<mutex> guard(lock);
+        job = &task;
+        job_tasks = tasks;
+        next_task = 0;
+        busy = (int) workers.size();
+        generation++;
+    }
+    wake.notify_all();
+
+    execute();
+
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [&] { return busy == 0; });
+    job = NULL;
+}
+
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t alignment, size_t min_chunk,
+                              const function<void (size_t, size_t)>& body)
+{
+    if (end <= begin) { return; }
+    if (alignment == 0) { alignment = 1; }
+    if (min_chunk == 0) { min_chunk = 1; }
+
+    const size_t length = end - begin;
+    size_t chunks = (size_t) size();
+    if (length / min_chunk < chunks) { chunks = length / min_chunk; }
+    if (chunks <= 1)
+    {
+        body(begin, end);
+        return;
+    }
+
+    /* chunk length rounded up to a multiple of alignment */
+    size_t chunk = (length + chunks - 1) / chunks;
+    chunk = ((chunk + alignment - 1) / alignment) * alignment;
+    chunks = (length + chunk - 1) / chunk;
+
+    run(chunks, [&] (size_t c) {
+        const size_t chunk_begin = begin + c * chunk;
+        const size_t chunk_end = (chunk_begin + chunk < end) ? chunk_begin + chunk : end;
+        body(chunk_begin, chunk_end);
+    });
+}
@@ -0,0 +1,80 @@
+/*
+ * thread_pool.h
+ * Fixed size pool of worker threads for the numerical engines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_THREAD_POOL_H
+#define MISC_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/*
+ * The calling thread takes part in the work, so a pool of size 1 starts no
+ * thread at all and runs everything serially. Only one run() or
+ * parallel_for() may be active at a time.
+ */
+class ThreadPool
+{
+public:
+    /*
+     * @param threads number of threads including the calling one,
+     *        0 uses all hardware threads
+     */
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return (int) workers.size() + 1; }
+
+    /*
+     * Call task(i) for i = 0, ..., tasks-1, each index is handed to the
+     * next free thread. Returns when all tasks are done.
+     */
+    void run(size_t tasks, const std::function<void (size_t)>& task);
+
+    /*
+     * Static chunking: [begin, end) is split into at most size() contiguous
+     * chunks whose inner bounds are multiples of alignment (relative to
+     * begin), and
+     * body(chunk_begin, chunk_end) is called once per chunk. Ranges shorter
+     * than min_chunk per thread use fewer chunks.
+     */
+    void parallel_for(size_t begin, size_t end, size_t alignment, size_t min_chunk,
+                      const std::function<void (size_t, size_t)>& body);
+
+    /* number of hardware threads, at least 1 */
+    static int hardware_threads();
+
+private:
+    void work();
+    void execute();
+
+    std::vector<std::thread> workers;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    const std::function<void (size_t)>* job;
+    size_t job_tasks;
+    std::atomic<size_t> next_task;
+    size_t generation;   /* counts the calls of run() */
+    int busy;            /* workers still executing the current job */
+    bool stop;
+};
+
+#endif /* MISC_THREAD_POOL_H */
@@ -0,0 +1,35 @@
+/*
+ * timer.h
+ * Wall clock time measurement for the summaries of the programs.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_TIMER_H
+#define MISC_TIMER_H
+
+#include <chrono>
+
+
+class Timer
+{
+public:
+    Timer() : start(std::chrono::steady_clock::now()) {}
+
+    void restart() { start = std::chrono::steady_clock::now(); }
+
+    /* seconds since construction or the last restart() */
+    double seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+#endif /* MISC_TIMER_H */
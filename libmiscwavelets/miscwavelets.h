@@ -0,0 +1,54 @@
+/*
+ * miscwavelets.h
+ * C++ interface of libmiscwavelets: the refinement masks, the subdivision
+ * cascades and the B-spline and spline wavelet evaluators.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_MISCWAVELETS_H
+#define MISC_MISCWAVELETS_H
+
+/*
+ * Link with libmiscwavelets.a or libmiscwavelets.so and -pthread. The
+ * engines are used in-process, e.g.
+ *
+ *   Subdivision S(*select_mask(13));
+ *   S.run(20);                        // S.values()[k] ~ phi(k / 2^20)
+ *
+ *   WaveletEvaluator psi(*select_psi(4, 4));
+ *   psi.evaluate(x, y, n);            // y[i] = psi(x[i])
+ *
+ * Programs in C use the handles of miscwavelets_c.h instead.
+ */
+
+/* refinement masks and the cascade of refinable functions */
+#include "../subdivision/masks.h"
+#include "../subdivision/kernels.h"
+#include "../subdivision/cascade.h"
+#include "../subdivision/point_evaluation.h"
+#include "../subdivision/gram.h"
+#include "../subdivision/tensor_cascade.h"
+#include "../subdivision/lattice_cascade.h"
+
+/* B-splines and spline wavelets */
+#include "../Visualize_Spline_Wavelets/bspline.h"
+#include "../Visualize_Spline_Wavelets/spline_wavelets.h"
+#include "../Visualize_Spline_Wavelets/wavelet_evaluator.h"
+#include "../Visualize_Spline_Wavelets/wavelet_sampler.h"
+#include "../Visualize_Spline_Wavelets/multilevel_synthesis.h"
+#include "../Visualize_Spline_Wavelets/spline_gram.h"
+#include "../Visualize_Spline_Wavelets/tensor_sampler.h"
+
+/* threads, precisions, output and the table cache */
+#include "../common/thread_pool.h"
+#include "../common/precision.h"
+#include "../common/output_writer.h"
+#include "../common/tensor_grid.h"
+#include "../common/table_cache.h"
+
+#endif /* MISC_MISCWAVELETS_H */
@@ -0,0 +1,279 @@
+/*
+ * miscwavelets_c.cpp
+ * C interface of libmiscwavelets: refinable functions by subdivision,
+ * B-splines and spline wavelets through opaque handles.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+#include "miscwavelets.h"
+#include "miscwavelets_c.h"
+
+using namespace std;
+
+static_assert((int) mw_float == (int) precision_float && (int) mw_double_double == (int) precision_double_double,
+              "mw_precision_t has to follow precision_t");
+static_assert(mw_max_steps == Subdivision::max_depth, "mw_max_steps has to follow the depth of the cascade");
+
+
+struct mw_refinable
+{
+    const mask_t* mask;
+    int derivative;
+    precision_t precision;
+    unique_ptr<ThreadPool> pool;
+    vector<double> values;
+};
+
+struct mw_wavelet
+{
+    const psi_t* psi;
+    unique_ptr<WaveletSampler> sampler;
+    unique_ptr<ThreadPool> pool;
+};
+
+
+/*
+ * last level of the cascade in the type T, rounded to double
+ * @return false if memory is exhausted
+ */
+template <typename T>
+static bool run_cascade(mw_refinable_t* phi, int steps)
+{
+    BasicSubdivision<T> S(*phi->mask, phi->derivative);
+    if (phi->pool->size() > 1) { S.set_thread_pool(phi->pool.get()); }
+    if (!S.run(steps)) { return false; }
+
+    const size_t count = S.level_size(steps);
+    phi->values.resize(count);
+    for (size_t k = 0; k < count; k++) { phi->values[k] = to_double(S.values()[k]); }
+    return true;
+}
+
+
+int mw_mask_count(void)
+{
+    return builtin_mask_count;
+}
+
+
+const char* mw_mask_name(int number)
+{
+    try
+    {
+        const mask_t* mask = select_mask(number);
+        return (mask == NULL) ? NULL : mask->name.c_str();
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+
+mw_refinable_t* mw_refinable_create(int mask, int derivative, mw_precision_t precision, int threads)
+{
+    try
+    {
+        const mask_t* selected = select_mask(mask);
+        if (selected == NULL || derivative < 0 || precision < mw_float || precision > mw_double_double
+            || threads < 0 || !Subdivision(*selected, derivative).valid())
+        {
+            return NULL;
+        }
+
+        unique_ptr<mw_refinable_t> phi(new mw_refinable_t);
+        phi->mask = selected;
+        phi->derivative = derivative;
+        phi->precision = (precision_t) precision;
+        phi->pool.reset(new ThreadPool(threads));
+        return phi.release();
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+
+void mw_refinable_destroy(mw_refinable_t* phi)
+{
+    delete phi;
+}
+
+
+mw_status_t mw_refinable_run(mw_refinable_t* phi, int steps)
+{
+    if (phi == NULL || steps < 0 || steps > mw_max_steps) { return mw_invalid_argument; }
+
+    try
+    {
+        phi->values.clear();
+        bool computed;
+        switch (phi->precision)
+        {
+            case precision_float:         computed = run_cascade<float>(phi, steps); break;
+            case precision_long_double:   computed = run_cascade<long double>(phi, steps); break;
+            case precision_double_double: computed = run_cascade<dd_real>(phi, steps); break;
+            default:                      computed = run_cascade<double>(phi, steps);
+        }
+        if (!computed) { phi->values.clear(); }
+        return computed ? mw_ok : mw_out_of_memory;
+    }
+    catch (const bad_alloc&)
+    {
+        phi->values.clear();
+        return mw_out_of_memory;
+    }
+    catch (...)
+    {
+        phi->values.clear();
+        return mw_internal_error;
+    }
+}
+
+
+size_t mw_refinable_size(const mw_refinable_t* phi)
+{
+    return (phi == NULL) ? 0 : phi->values.size();
+}
+
+
+const double* mw_refinable_values(const mw_refinable_t* phi)
+{
+    return (phi == NULL || phi->values.empty()) ? NULL : phi->values.data();
+}
+
+
+mw_wavelet_t* mw_wavelet_create(int spline_order, int vanishing_moments, int derivative, int threads)
+{
+    if (spline_order < 1 || spline_order > max_spline_order || vanishing_moments < 1
+        || vanishing_moments > max_vanishing_moments || derivative < 0 || threads < 0)
+    {
+        return NULL;
+    }
+
+    try
+    {
+        const psi_t* psi = select_psi(spline_order, vanishing_moments);
+        if (psi == NULL) { return NULL; }
+
+        unique_ptr<mw_wavelet_t> wavelet(new mw_wavelet_t);
+        wavelet->psi = psi;
+        wavelet->sampler.reset(new WaveletSampler(*psi, derivative));
+        if (!wavelet->sampler->valid()) { return NULL; }
+
+        wavelet->pool.reset(new ThreadPool(threads));
+        if (wavelet->pool->size() > 1) { wavelet->sampler->set_thread_pool(wavelet->pool.get()); }
+        return wavelet.release();
+    }
+    catch (...)
+    {
+        return NULL;
+    }
+}
+
+
+void mw_wavelet_destroy(mw_wavelet_t* psi)
+{
+    delete psi;
+}
+
+
+mw_status_t mw_wavelet_support(const mw_wavelet_t* psi, double* start, double* end)
+{
+    if (psi == NULL || start == NULL || end == NULL) { return mw_invalid_argument; }
+
+    *start = psi->psi->output_start;
+    *end = psi->psi->output_end;
+    return mw_ok;
+}
+
+
+mw_status_t mw_wavelet_evaluate(const mw_wavelet_t* psi, const double* x, double* y, size_t n)
+{
+    if (psi == NULL || (n > 0 && (x == NULL || y == NULL))) { return mw_invalid_argument; }
+
+    try
+    {
+        return psi->sampler->evaluate(x, y, n) ? mw_ok : mw_invalid_argument;
+    }
+    catch (const bad_alloc&)
+    {
+        return mw_out_of_memory;
+    }
+    catch (...)
+    {
+        return mw_internal_error;
+    }
+}
+
+
+size_t mw_wavelet_samples(const mw_wavelet_t* psi, size_t R)
+{
+    try
+    {
+        return (psi == NULL || R == 0) ? 0 : psi->sampler->samples(R);
+    }
+    catch (...)
+    {
+        return 0;
+    }
+}
+
+
+mw_status_t mw_wavelet_sample(const mw_wavelet_t* psi, size_t R, double* x, double* y, size_t count)
+{
+    if (psi == NULL || R == 0 || y == NULL || count < psi->sampler->samples(R)) { return mw_invalid_argument; }
+
+    try
+    {
+        const bool sampled = psi->sampler->stream(R, [&] (size_t first, const double* grid, const double* values, size_t n) {
+            if (x != NULL) { memcpy(x + first, grid, n * sizeof(double)); }
+            memcpy(y + first, values, n * sizeof(double));
+            return true;
+        });
+        return sampled ? mw_ok : mw_out_of_memory;
+    }
+    catch (const bad_alloc&)
+    {
+        return mw_out_of_memory;
+    }
+    catch (...)
+    {
+        return mw_internal_error;
+    }
+}
+
+
+mw_status_t mw_bspline_evaluate(int spline_order, const double* x, double* y, size_t n)
+{
+    if (spline_order < 1 || spline_order > max_spline_order || (n > 0 && (x == NULL || y == NULL)))
+    {
+        return mw_invalid_argument;
+    }
+
+    try
+    {
+        const double one = 1.0;
+        const WaveletEvaluator bspline(spline_order, &one, 0, 1, 1.0);
+        bspline.evaluate(x, y, n);
+        return mw_ok;
+    }
+    catch (const bad_alloc&)
+    {
+        return mw_out_of_memory;
+    }
+    catch (...)
+    {
+        return mw_internal_error;
+    }
+}
@@ -0,0 +1,130 @@
+/*
+ * miscwavelets_c.h
+ * C interface of libmiscwavelets: refinable functions by subdivision,
+ * B-splines and spline wavelets through opaque handles.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_MISCWAVELETS_C_H
+#define MISC_MISCWAVELETS_C_H
+
+#include <stddef.h>
+
+/*
+ * C programs link libmiscwavelets.so, or libmiscwavelets.a together with
+ * -lstdc++ -lm -pthread.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * results of the functions, no C++ exception leaves the library: functions
+ * returning a handle, a name or a size return NULL or 0 instead
+ */
+typedef enum {
+    mw_ok = 0,
+    mw_invalid_argument,   /* NULL handle, parameter out of range or array too small */
+    mw_out_of_memory,
+    mw_internal_error      /* any other exception of the engines */
+}mw_status_t;
+
+/*
+ * scalar type of the cascade, see precision.h, values are returned as double
+ */
+typedef enum {
+    mw_float = 0,
+    mw_double,
+    mw_long_double,
+    mw_double_double
+}mw_precision_t;
+
+/* largest number of subdivision steps of mw_refinable_run */
+enum { mw_max_steps = 40 };
+
+typedef struct mw_refinable mw_refinable_t;
+typedef struct mw_wavelet mw_wavelet_t;
+
+
+/* number of built-in refinement masks, numbered 1..mw_mask_count() */
+int mw_mask_count(void);
+
+/* name of mask number, e.g. "CDF_4_6_dual", NULL if there is no such mask */
+const char* mw_mask_name(int number);
+
+
+/*
+ * Refinable function phi, or its derivative phi^(r), of a built-in mask.
+ * @param mask mask number 1..mw_mask_count()
+ * @param derivative order r, 0 gives phi
+ * @param precision scalar type of the cascade
+ * @param threads threads of the cascade, 0 uses all hardware threads
+ * @return handle or NULL if the mask or the derivative does not exist
+ */
+mw_refinable_t* mw_refinable_create(int mask, int derivative, mw_precision_t precision, int threads);
+void mw_refinable_destroy(mw_refinable_t* phi);
+
+/*
+ * runs the cascade, sample k of the result approximates phi(k / 2^steps)
+ * @param steps subdivision steps 0..mw_max_steps
+ */
+mw_status_t mw_refinable_run(mw_refinable_t* phi, int steps);
+
+/* number of samples of the last run, 0 before the first run */
+size_t mw_refinable_size(const mw_refinable_t* phi);
+
+/*
+ * samples of the last run, valid until the next run or destroy
+ * @return NULL before the first run
+ */
+const double* mw_refinable_values(const mw_refinable_t* phi);
+
+
+/*
+ * spline wavelet psi of the biorthogonal CDF pair, or psi^(r)
+ * @param spline_order m
+ * @param vanishing_moments mt, m + mt even outside the built-in table
+ * @param derivative order r below m
+ * @param threads threads of mw_wavelet_evaluate and mw_wavelet_sample,
+ *        0 uses all hardware threads
+ * @return handle or NULL if the combination is not implemented
+ */
+mw_wavelet_t* mw_wavelet_create(int spline_order, int vanishing_moments, int derivative, int threads);
+void mw_wavelet_destroy(mw_wavelet_t* psi);
+
+/* support [start, end] of psi */
+mw_status_t mw_wavelet_support(const mw_wavelet_t* psi, double* start, double* end);
+
+/* y[i] = psi(x[i]) for i < n */
+mw_status_t mw_wavelet_evaluate(const mw_wavelet_t* psi, const double* x, double* y, size_t n);
+
+/* number of grid points of resolution R, see mw_wavelet_sample */
+size_t mw_wavelet_samples(const mw_wavelet_t* psi, size_t R);
+
+/*
+ * psi on the grid of resolution R of visualize_spline_wavelets, x_0 is
+ * the start of the support, i < mw_wavelet_samples(psi, R)
+ * @param x grid points, may be NULL
+ * @param y samples
+ * @param count length of x and y, at least mw_wavelet_samples(psi, R)
+ */
+mw_status_t mw_wavelet_sample(const mw_wavelet_t* psi, size_t R, double* x, double* y, size_t count);
+
+
+/*
+ * y[i] = N_m(x[i]) of the cardinal B-spline with support [0, m]
+ * @param spline_order m, 1..8
+ */
+mw_status_t mw_bspline_evaluate(int spline_order, const double* x, double* y, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MISC_MISCWAVELETS_C_H */
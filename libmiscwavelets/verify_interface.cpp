@@ -0,0 +1,85 @@
+/*
+ * verify_interface.cpp
+ * Checks of the C interface of libmiscwavelets against the engines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstring>
+#include <vector>
+#include "miscwavelets.h"
+#include "miscwavelets_c.h"
+#include "verify_interface.h"
+
+using namespace std;
+
+
+bool verify_c_refinable(ostream* log)
+{
+    const mask_t& mask = *select_mask(13);
+    const int steps = 10;
+    bool valid = mw_mask_count() == builtin_mask_count && mw_mask_name(13) == mask.name
+                 && mw_mask_name(0) == NULL && mw_refinable_create(0, 0, mw_double, 1) == NULL
+                 && mw_refinable_run(NULL, steps) == mw_invalid_argument;
+
+    ThreadPool pool(1);
+    for (int p = mw_float; valid && p <= mw_double_double; p++)
+    {
+        mw_refinable_t* phi = mw_refinable_create(13, 1, (mw_precision_t) p, 2);
+        const size_t count = Subdivision(mask, 1).level_size(steps);
+        vector<double> direct(count);
+        valid = phi != NULL && mw_refinable_values(phi) == NULL && mw_refinable_run(phi, steps) == mw_ok
+                && mw_refinable_size(phi) == count
+                && final_level(mask, (precision_t) p, 1, steps, pool, direct.data(), count)
+                && memcmp(mw_refinable_values(phi), direct.data(), count * sizeof(double)) == 0
+                && mw_refinable_run(phi, mw_max_steps + 1) == mw_invalid_argument;
+        mw_refinable_destroy(phi);
+    }
+
+    const double x[] = {0.5, 2.0, 4.0};
+    double y[3];
+    valid = valid && mw_bspline_evaluate(4, x, y, 3) == mw_ok && y[0] == 1.0 / 48.0 && y[1] == 2.0 / 3.0 && y[2] == 0.0
+            && mw_bspline_evaluate(0, x, y, 3) == mw_invalid_argument;
+
+    if (log != NULL)
+    {
+        *log << "C interface: " << (valid ? "levels of all precisions and B-splines agree" : "FAILED") << "\n";
+    }
+    return valid;
+}
+
+
+bool verify_c_wavelets(ostream* log)
+{
+    bool valid = mw_wavelet_create(9, 2, 0, 1) == NULL && mw_wavelet_evaluate(NULL, NULL, NULL, 0) == mw_invalid_argument;
+    for (int p = 0; valid && p < builtin_psi_count; p++)
+    {
+        const psi_t& psi = builtin_psi[p];
+        const WaveletSampler sampler(psi, 1);
+        const size_t R = 1 << 18, n = sampler.samples(R); /* several chunks for the threads */
+
+        mw_wavelet_t* wavelet = mw_wavelet_create(psi.spline_order, psi.vanishing_moments, 1, 2);
+        vector<double> x(n), y(n), direct(n), shifted(n);
+        double start, end;
+        valid = wavelet != NULL && mw_wavelet_samples(wavelet, R) == n
+                && mw_wavelet_sample(wavelet, R, x.data(), y.data(), n) == mw_ok
+                && mw_wavelet_sample(wavelet, R, NULL, y.data(), n - 1) == mw_invalid_argument
+                && mw_wavelet_support(wavelet, &start, &end) == mw_ok
+                && start == psi.output_start && end == psi.output_end && x[0] == psi.output_start;
+        for (size_t i = 0; valid && i < n; i++) { x[i] += 0.25 * sampler.step_size(R); }
+        valid = valid && sampler.evaluate(x.data(), direct.data(), n)
+                && mw_wavelet_evaluate(wavelet, x.data(), shifted.data(), n) == mw_ok
+                && memcmp(direct.data(), shifted.data(), n * sizeof(double)) == 0;
+        mw_wavelet_destroy(wavelet);
+    }
+
+    if (log != NULL)
+    {
+        *log << "\nC interface: " << (valid ? "samples and evaluation of all wavelets agree" : "FAILED") << "\n";
+    }
+    return valid;
+}
@@ -0,0 +1,36 @@
+/*
+ * verify_interface.h
+ * Checks of the C interface of libmiscwavelets against the engines.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef MISC_VERIFY_INTERFACE_H
+#define MISC_VERIFY_INTERFACE_H
+
+#include <ostream>
+
+
+/*
+ * Compare the refinable functions of the C interface with the cascade: the
+ * levels of every precision bit for bit, the B-splines, and the rejection
+ * of invalid arguments.
+ * @param log receives a summary line, may be NULL
+ * @return true if all checks pass
+ */
+bool verify_c_refinable(std::ostream* log);
+
+/*
+ * Compare the spline wavelets of the C interface with the sampler: every
+ * spline wavelet at the grid and around its support, bit for bit, over
+ * several chunks of the threads.
+ * @param log receives a summary line, may be NULL
+ * @return true if all checks pass
+ */
+bool verify_c_wavelets(std::ostream* log);
+
+#endif /* MISC_VERIFY_INTERFACE_H */
@@ -0,0 +1,497 @@
+/*
+ * cascade.cpp
+ * Subdivision (cascade algorithm) for refinable functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstring>
+#include <math.h>
+#include <algorithm>
+#include <new>
+#include <string>
+#include "cascade.h"
+#include "../common/table_cache.h"
+#include "../common/timer.h"
+
+using namespace std;
+
+/* i = 0, 4, 8, ... start the cache lines of the fine level, for doubles */
+template <typename T>
+static const size_t pairs_per_line = cache_line_size / (2 * sizeof(T));
+
+/* smaller levels are not worth waking up the threads */
+static const size_t min_pairs_per_thread = 16384;
+
+
+template <typename T>
+BasicSubdivision<T>::BasicSubdivision(const mask_t& mask)
+    : BasicSubdivision(mask, 0)
+{
+}
+
+
+template <typename T>
+BasicSubdivision<T>::BasicSubdivision(const mask_t& mask, int derivative)
+    : refinement_mask(mask), derivative_order(derivative), steps(-1), final_buffer(0), keep_all(false), threads(NULL)
+{
+    vector<double> factored;
+    const bool factorized = derivative_mask(mask, derivative, factored);
+    const mask_t cascade_mask = {factored.data(), (int) factored.size(), mask.name};
+
+    filter = convert_polyphase<T>(polyphase(cascade_mask));
+    cascade_length = cascade_mask.length;
+    M = factorized ? cascade_length - 1 : -1;
+
+    const size_t per_line = cache_line_size / sizeof(T);
+    offset = ((filter.padding + per_line - 1) / per_line) * per_line;
+}
+
+
+template <typename T>
+void BasicSubdivision<T>::retain_level(int j)
+{
+    if (j < 0) { return; }
+    if ((size_t) j >= keep.size()) { keep.resize(j + 1, false); }
+    keep[j] = true;
+}
+
+
+template <typename T>
+void BasicSubdivision<T>::retain_all_levels()
+{
+    keep_all = true;
+}
+
+
+template <typename T>
+size_t BasicSubdivision<T>::level_size(int j) const
+{
+    return ((size_t) (M + derivative_order) << j) + 1;
+}
+
+
+template <typename T>
+const T* BasicSubdivision<T>::level(int j) const
+{
+    if (j < 0 || j > steps) { return NULL; }
+    if (j == steps) { return (derivative_order > 0) ? derived.data() : buffer_data(final_buffer); }
+    if ((size_t) j < kept.size() && !kept[j].empty()) { return kept[j].data(); }
+
+    return NULL;
+}
+
+
+/*
+ * sup norm of the fine level minus the linear interpolation of the coarse
+ * level, NaN if any sample is not finite
+ */
+template <typename T>
+static double interpolation_difference(const T* coarse, size_t coarse_size, const T* fine,
+                                       size_t begin, size_t end)
+{
+    double d = 0.0;
+    for (size_t i = begin; i < end; i++)
+    {
+        double e = to_double(fabs(fine[2*i] - coarse[i]));
+        if (!(e <= d)) { d = e; }
+
+        if (i + 1 < coarse_size)
+        {
+            e = to_double(fabs(fine[2*i+1] - T(0.5) * (coarse[i] + coarse[i+1])));
+            if (!(e <= d)) { d = e; }
+        }
+    }
+
+    return d;
+}
+
+
+template <typename T>
+double BasicSubdivision<T>::difference(const T* coarse, size_t coarse_size, const T* fine) const
+{
+    if (threads == NULL || coarse_size < 2 * min_pairs_per_thread)
+    {
+        return interpolation_difference(coarse, coarse_size, fine, 0, coarse_size);
+    }
+
+    const size_t tasks = threads->size();
+    vector<double> chunk(tasks, 0.0);
+    threads->run(tasks, [&] (size_t t) {
+        chunk[t] = interpolation_difference(coarse, coarse_size, fine,
+                                            coarse_size * t / tasks, coarse_size * (t + 1) / tasks);
+    });
+
+    double d = 0.0;
+    for (size_t t = 0; t < tasks; t++)
+    {
+        if (!(chunk[t] <= d)) { d = chunk[t]; }
+    }
+
+    return d;
+}
+
+
+/*
+ * derived[k] = sum_i (-1)^i binom(r, i) samples[k - i step] for
+ * begin <= k < end, samples has n entries
+ */
+template <typename T>
+static void difference_samples(const T* samples, size_t n, int r, size_t step,
+                               size_t begin, size_t end, T* derived)
+{
+    for (size_t k = begin; k < end; k++) { derived[k] = 0.0; }
+
+    double binomial = 1.0;
+    for (int i = 0; i <= r; i++)
+    {
+        const T c = (i % 2 == 0) ? binomial : -binomial;
+        const size_t shift = i * step;
+        const size_t low = max(begin, shift), high = min(end, shift + n);
+        for (size_t k = low; k < high; k++)
+        {
+            derived[k] += c * samples[k - shift];
+        }
+        binomial = binomial * (r - i) / (i + 1);
+    }
+}
+
+
+/*
+ * level j of phi^(r) from level j of phi_c, one chunk per thread
+ */
+template <typename T>
+void BasicSubdivision<T>::differentiate(const T* samples, int j, T* derived) const
+{
+    const size_t n = cascade_size(j), step = (size_t) 1 << j;
+    if (threads == NULL)
+    {
+        difference_samples(samples, n, derivative_order, step, 0, level_size(j), derived);
+    }
+    else
+    {
+        threads->parallel_for(0, level_size(j), 2 * pairs_per_line<T>, 2 * min_pairs_per_thread,
+                              [&] (size_t begin, size_t end) { difference_samples(samples, n, derivative_order, step, begin, end, derived); });
+    }
+}
+
+
+template <typename T>
+bool BasicSubdivision<T>::run(int depth)
+{
+    return cascade(depth, 0.0, NULL);
+}
+
+
+template <typename T>
+bool BasicSubdivision<T>::run_adaptive(double tolerance, int depth_limit, convergence_t& result)
+{
+    return cascade(depth_limit, tolerance, &result);
+}
+
+
+/*
+ * levels of the differences without decay until the cascade counts as
+ * divergent
+ */
+static const int stall_levels = 3;
+
+
+/*
+ * common loop of run() and run_adaptive(), result == NULL refines up to
+ * depth_limit without convergence checks
+ */
+template <typename T>
+bool BasicSubdivision<T>::cascade(int depth_limit, double tolerance, convergence_t* result)
+{
+    if (depth_limit < 0 || depth_limit > max_depth || M < 0) { return false; }
+
+    steps = -1;
+    kept.clear();
+    derived.resize(0);
+    if (result != NULL)
+    {
+        result->depth = 0;
+        result->converged = false;
+        result->diverged = false;
+        result->rate = 0.0;
+        result->error = HUGE_VAL;
+        result->difference.assign(1, 0.0);
+    }
+
+    int depth = 0;
+    try
+    {
+        /*
+         * The kernel writes one sample behind the end of the fine level.
+         * A plain run allocates the final size at once, an adaptive run
+         * grows the buffers with the levels.
+         */
+        const auto capacity = [&] (int j) { return offset + cascade_size(j) + 1; };
+        const int initial = (result == NULL) ? depth_limit : 0;
+
+        buffer[0].resize(capacity(initial));
+        buffer[1].resize(depth_limit > 0 ? capacity(initial) : 0);
+        kept.resize(depth_limit);
+
+        /* kernel unrolled for the length of the mask, selected once per run */
+        const basic_refine_kernel<T> kernel = refine_kernel<T>(selected_isa(), cascade_length);
+        const double amplification = ldexp(1.0, derivative_order);
+
+        /* level 0: delta sequence */
+        int current = 0;
+        buffer_data(current)[0] = 1.0;
+        int stalled = 0;
+
+        for (int j = 1; j <= depth_limit; j++) /* subdivision steps */
+        {
+            if (keep_all || ((size_t) (j-1) < keep.size() && keep[j-1]))
+            {
+                kept[j-1].resize(level_size(j-1));
+                if (derivative_order > 0) { differentiate(buffer_data(current), j-1, kept[j-1].data()); }
+                else { memcpy(static_cast<void*>(kept[j-1].data()), buffer_data(current), level_size(j-1) * sizeof(T)); }
+            }
+
+            if (buffer[1-current].size() < capacity(j))
+            {
+                buffer[1-current].resize(capacity(j));
+            }
+
+            /* fine level has 2 * coarse - 1 samples, the bounds are those of the coarse level */
+            const T* coarse = buffer_data(current);
+            T* fine = buffer_data(1-current);
+            if (threads == NULL)
+            {
+                kernel(filter, coarse, 0, cascade_size(j-1), fine);
+            }
+            else
+            {
+                threads->parallel_for(0, cascade_size(j-1), pairs_per_line<T>, min_pairs_per_thread,
+                                      [&] (size_t begin, size_t end) { kernel(filter, coarse, begin, end, fine); });
+            }
+            current = 1 - current;
+            depth = j;
+
+            if (result == NULL) { continue; }
+
+            /* convergence check */
+            const double d = amplification * difference(coarse, cascade_size(j-1), fine);
+            const double previous = result->difference.back();
+            result->difference.push_back(d);
+            result->depth = j;
+
+            if (!isfinite(d))
+            {
+                result->diverged = true;
+                break;
+            }
+            if (j < 2) { continue; }
+
+            result->rate = (previous > 0.0) ? d / previous : 0.0;
+            result->error = (result->rate < 1.0) ? d * result->rate / (1.0 - result->rate) : HUGE_VAL;
+
+            stalled = (result->rate >= 1.0) ? stalled + 1 : 0;
+            if (stalled >= stall_levels)
+            {
+                result->diverged = true;
+                break;
+            }
+            if (result->error <= tolerance)
+            {
+                result->converged = true;
+                break;
+            }
+        }
+
+        final_buffer = current;
+        if (derivative_order > 0)
+        {
+            derived.resize(level_size(depth));
+            differentiate(buffer_data(current), depth, derived.data());
+        }
+    }
+    catch (const bad_alloc&)
+    {
+        buffer[0].resize(0);
+        buffer[1].resize(0);
+        derived.resize(0);
+        kept.clear();
+        return false;
+    }
+
+    steps = depth;
+    return true;
+}
+
+
+template class BasicSubdivision<float>;
+template class BasicSubdivision<double>;
+template class BasicSubdivision<long double>;
+template class BasicSubdivision<dd_real>;
+
+
+
+/*
+ * largest absolute value of the final level of b
+ */
+static double largest_value(const BasicSubdivision<dd_real>& b)
+{
+    double scale = 0.0;
+    for (size_t k = 0; k < b.level_size(b.depth()); k++)
+    {
+        scale = max(scale, to_double(fabs(b.values()[k])));
+    }
+
+    return scale;
+}
+
+/*
+ * largest difference of the final levels of a and b, computed in
+ * double-double
+ */
+template <typename T>
+static double largest_difference(const BasicSubdivision<T>& a, const BasicSubdivision<dd_real>& b)
+{
+    double difference = 0.0;
+    for (size_t k = 0; k < b.level_size(b.depth()); k++)
+    {
+        const dd_real value = dd_real((long double) a.values()[k]);
+        difference = max(difference, to_double(fabs(value - b.values()[k])));
+    }
+
+    return difference;
+}
+
+/*
+ * largest difference of the final levels of a and b relative to the
+ * largest sample of b
+ */
+template <typename T>
+static double relative_difference(const BasicSubdivision<T>& a, const BasicSubdivision<dd_real>& b)
+{
+    return largest_difference(a, b) / largest_value(b);
+}
+
+
+bool verify_precisions(ostream* log)
+{
+    /* double-double arithmetic */
+    const dd_real third = dd_real(1.0) / dd_real(3.0);
+    bool valid = to_double(fabs(third * 3.0 - 1.0)) <= ldexp(1.0, -104)
+                 && (dd_real(1.0) + ldexp(1.0, -80)).lo == ldexp(1.0, -80);
+
+    /* the levels of N_4 are dyadic with few digits and exact in every type */
+    {
+        const mask_t& mask = *select_mask(4);
+        const int depth = 5;
+        BasicSubdivision<float> f(mask);
+        BasicSubdivision<double> d(mask);
+        BasicSubdivision<long double> l(mask);
+        BasicSubdivision<dd_real> q(mask);
+        valid = valid && f.run(depth) && d.run(depth) && l.run(depth) && q.run(depth);
+        for (size_t k = 0; valid && k < d.level_size(depth); k++)
+        {
+            const double value = d.values()[k];
+            valid = (double) f.values()[k] == value && (double) l.values()[k] == value
+                    && q.values()[k].hi == value && q.values()[k].lo == 0.0;
+        }
+    }
+
+    /* CDF_4_6_dual accumulates rounding errors with the depth */
+    const mask_t& mask = *select_mask(13);
+    const int depth = 12;
+    BasicSubdivision<float> f(mask);
+    BasicSubdivision<double> d(mask);
+    BasicSubdivision<long double> l(mask);
+    BasicSubdivision<dd_real> q(mask);
+    valid = valid && f.run(depth) && d.run(depth) && l.run(depth) && q.run(depth);
+
+    const double error[] = {relative_difference(f, q), relative_difference(d, q), relative_difference(l, q)};
+    valid = valid && error[0] <= 1e3 * unit_roundoff(precision_float)
+            && error[1] <= 1e3 * unit_roundoff(precision_double)
+            && error[2] <= 1e3 * unit_roundoff(precision_long_double);
+
+    if (log != NULL)
+    {
+        *log << "Precisions: " << mask.name << " at depth " << depth << " relative to double-double: float "
+             << error[0] << ", double " << error[1] << ", long double " << error[2]
+             << (valid ? "" : "  FAILED") << "\n";
+    }
+
+    return valid;
+}
+
+
+
+template <typename T>
+static bool final_level(const mask_t& mask, int derivative, int steps, ThreadPool& pool, double* values, size_t count)
+{
+    BasicSubdivision<T> S(mask, derivative);
+    if (pool.size() > 1) { S.set_thread_pool(&pool); }
+    if (!S.run(steps) || S.level_size(steps) != count) { return false; }
+
+    for (size_t k = 0; k < count; k++) { values[k] = to_double(S.values()[k]); }
+    return true;
+}
+
+
+bool final_level(const mask_t& mask, precision_t precision, int derivative, int steps, ThreadPool& pool,
+                 double* values, size_t count)
+{
+    switch (precision)
+    {
+        case precision_float:         return final_level<float>(mask, derivative, steps, pool, values, count);
+        case precision_long_double:   return final_level<long double>(mask, derivative, steps, pool, values, count);
+        case precision_double_double: return final_level<dd_real>(mask, derivative, steps, pool, values, count);
+        default:                      return final_level<double>(mask, derivative, steps, pool, values, count);
+    }
+}
+
+
+uint64_t final_level_key(const mask_t& mask, precision_t precision, int derivative, int steps)
+{
+    return TableKey().add(string("subdivision")).add(mask.entry, mask.length * sizeof(double))
+                     .add(derivative).add(steps).add((int) precision).value();
+}
+
+
+
+/*
+ * the cascade in the type T, timed and compared with the reference
+ * @return false if memory is exhausted
+ */
+template <typename T>
+static bool precision_run(const mask_t& mask, int steps, ThreadPool& pool, const BasicSubdivision<dd_real>& reference,
+                          precision_run_t& run)
+{
+    BasicSubdivision<T> S(mask);
+    if (pool.size() > 1) { S.set_thread_pool(&pool); }
+
+    Timer timer;
+    if (!S.run(steps)) { return false; }
+    run.seconds = timer.seconds();
+    run.difference = largest_difference(S, reference);
+
+    return true;
+}
+
+
+bool compare_precisions(const mask_t& mask, int steps, ThreadPool& pool, vector<precision_run_t>& runs, double& scale)
+{
+    runs.assign(precision_double_double + 1, precision_run_t{0.0, 0.0});
+
+    BasicSubdivision<dd_real> reference(mask);
+    if (pool.size() > 1) { reference.set_thread_pool(&pool); }
+    Timer timer;
+    if (!reference.run(steps)) { return false; }
+    runs[precision_double_double].seconds = timer.seconds();
+    scale = largest_value(reference);
+
+    return precision_run<float>(mask, steps, pool, reference, runs[precision_float])
+           && precision_run<double>(mask, steps, pool, reference, runs[precision_double])
+           && precision_run<long double>(mask, steps, pool, reference, runs[precision_long_double]);
+}
@@ -0,0 +1,206 @@
+/*
+ * cascade.h
+ * Subdivision (cascade algorithm) for refinable functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_CASCADE_H
+#define SUBDIVISION_CASCADE_H
+
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+#include "masks.h"
+#include "kernels.h"
+#include "../common/aligned_buffer.h"
+#include "../common/thread_pool.h"
+#include "../common/precision.h"
+
+
+/*
+ * Result of Subdivision::run_adaptive(). difference[j], j >= 1, is the sup
+ * norm of S_j minus the piecewise linear interpolation of S_{j-1} on the
+ * grid of level j. If the differences decay geometrically with the rate
+ * rho < 1, the remaining distance to the limit is about
+ * difference[depth] * rho / (1 - rho).
+ */
+typedef struct
+{
+    int depth;                      /* level reached */
+    bool converged;                 /* estimated error below the tolerance */
+    bool diverged;                  /* non-finite samples or no decay */
+    double rate;                    /* difference[depth] / difference[depth-1] */
+    double error;                   /* estimated sup norm error of the final level */
+    std::vector<double> difference;
+}convergence_t;
+
+
+/*
+ * Cascade algorithm S_j[k] = sum_m a[k-2m] S_{j-1}[m], starting from the
+ * delta sequence S_0 = (1, 0, 0, ...).
+ *
+ * Level j holds the samples k = 0, ..., (length-1) * 2^j which approximate
+ * phi(k / 2^j) on the support [0, length-1] of the refinable function.
+ * Only the current and the next level are kept in two aligned heap buffers,
+ * so memory is proportional to the size of the final level. Intermediate
+ * levels are copied only if they were requested by retain_level().
+ * Each step is computed by the polyphase kernel of kernels.h for the
+ * selected instruction set and the length of the mask.
+ *
+ * With a thread pool the samples of every level are split into one chunk
+ * per thread. The chunks start at cache line boundaries of the fine level
+ * and every sample is computed by the same kernel arithmetic, so the result
+ * is identical to the serial one for any number of threads.
+ *
+ * The samples have the scalar type T: float, double, long double or dd_real
+ * of precision.h. float kernels process twice the samples per vector for
+ * outputs of plotting accuracy, long double and dd_real give reference
+ * levels for masks whose cascade accumulates rounding errors. The mask is
+ * rounded from double to T, which is exact for the dyadic masks.
+ */
+template <typename T>
+class BasicSubdivision
+{
+public:
+    /*
+     * @param mask refinement mask, the coefficients are not copied
+     */
+    explicit BasicSubdivision(const mask_t& mask);
+
+    /*
+     * Levels of phi^(r) instead of phi: the cascade runs on the derivative
+     * mask of derivative_mask() with the same kernels, and every level of
+     * phi_c is turned into phi^(r) by r-th differences with the step 2^j.
+     * Differences and error estimates of run_adaptive() are multiplied by
+     * 2^r, the bound of the differencing.
+     * @param mask refinement mask
+     * @param derivative order r, 0 gives phi
+     */
+    BasicSubdivision(const mask_t& mask, int derivative);
+
+    /* false if the derivative mask does not exist */
+    bool valid() const { return M >= 0; }
+
+    /* order of the derivative in the levels */
+    int derivative() const { return derivative_order; }
+
+    /*
+     * @param j level that should stay available after run()
+     */
+    void retain_level(int j);
+    void retain_all_levels();
+
+    /*
+     * @param pool threads used by run(), NULL (default) computes serially
+     */
+    void set_thread_pool(ThreadPool* pool) { threads = pool; }
+
+    /*
+     * @param depth number of subdivision steps
+     * @return false if depth is out of range or memory is exhausted
+     */
+    bool run(int depth);
+
+    /*
+     * Refines until the estimated error of the final level is below
+     * tolerance, until the differences of successive levels stop decaying
+     * for several levels (divergence), or until depth_limit is reached.
+     * The buffers grow with the levels, so nothing is allocated for levels
+     * that are not computed.
+     * @param tolerance bound for the estimated sup norm error
+     * @param depth_limit largest number of subdivision steps
+     * @param result reached level, differences and error estimate
+     * @return false if depth_limit is out of range or memory is exhausted
+     */
+    bool run_adaptive(double tolerance, int depth_limit, convergence_t& result);
+
+    /* number of subdivision steps of the last run */
+    int depth() const { return steps; }
+
+    /* number of samples of level j */
+    size_t level_size(int j) const;
+
+    /* samples of level j, NULL if level j was neither retained nor final */
+    const T* level(int j) const;
+
+    /* samples of the final level */
+    const T* values() const { return level(steps); }
+
+    const mask_t& mask() const { return refinement_mask; }
+
+    /* largest depth supported, bounded by the size of the address space */
+    static const int max_depth = 40;
+
+private:
+    bool cascade(int depth_limit, double tolerance, convergence_t* result);
+    double difference(const T* coarse, size_t coarse_size, const T* fine) const;
+    void differentiate(const T* samples, int j, T* derived) const;
+
+    /* number of samples of phi_c on level j */
+    size_t cascade_size(int j) const { return ((size_t) M << j) + 1; }
+
+    T* buffer_data(int b) { return buffer[b].data() + offset; }
+    const T* buffer_data(int b) const { return buffer[b].data() + offset; }
+
+    mask_t refinement_mask;
+    basic_polyphase<T> filter;
+    int derivative_order;
+    int cascade_length; /* length of the mask of the cascade */
+    int M;            /* length of the mask of the cascade -1, -1 if invalid */
+    int steps;        /* depth of the last run, -1 before the first run */
+    int final_buffer; /* index of the buffer holding the final level */
+    size_t offset;    /* zeros in front of each level, whole cache lines */
+
+    AlignedBuffer<T> buffer[2];            /* ping-pong buffers */
+    AlignedBuffer<T> derived;              /* final level of phi^(r) */
+    std::vector<bool> keep;                /* requested levels */
+    std::vector<AlignedBuffer<T> > kept;   /* retained copies */
+    bool keep_all;
+    ThreadPool* threads;
+};
+
+typedef BasicSubdivision<double> Subdivision;
+
+
+/*
+ * final level of the cascade of phi^(r) computed in precision, rounded to
+ * double
+ * @param values count samples, count has to be the size of the level
+ * @return false if memory is exhausted or count does not fit
+ */
+bool final_level(const mask_t& mask, precision_t precision, int derivative, int steps, ThreadPool& pool,
+                 double* values, size_t count);
+
+/*
+ * key of final_level() in the table cache: the mask coefficients, the
+ * derivative order, the subdivision steps and the precision
+ */
+uint64_t final_level_key(const mask_t& mask, precision_t precision, int derivative, int steps);
+
+/*
+ * Runs the cascade of mask in every precision and compares the last
+ * levels with double-double.
+ * @param runs one entry per precision_t
+ * @param scale largest absolute value of the double-double level
+ * @return false if memory is exhausted
+ */
+bool compare_precisions(const mask_t& mask, int steps, ThreadPool& pool, std::vector<precision_run_t>& runs,
+                        double& scale);
+
+
+/*
+ * Cascades of N_4 in all precisions, which are exact for a few levels,
+ * and of CDF_4_6_dual, where float, double and long double are compared
+ * with double-double.
+ * @param log receives a summary line, may be NULL
+ * @return true if the exact levels agree bit for bit and the errors are
+ *         within the bounds of their precisions
+ */
+bool verify_precisions(std::ostream* log);
+
+#endif /* SUBDIVISION_CASCADE_H */
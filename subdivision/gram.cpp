@@ -0,0 +1,249 @@
+/*
+ * gram.cpp
+ * Exact inner products of shifted refinable functions and their derivatives.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "gram.h"
+#include "point_evaluation.h"
+
+using namespace std;
+
+
+int sum_rule_order(const mask_t& mask)
+{
+    const int M = mask.length - 1;
+    double scale = 0.0;
+    for (int m = 0; m <= M; m++) { scale += fabs(mask.entry[m]); }
+
+    for (int p = 0; p <= M; p++)
+    {
+        /* sum_m (-1)^m m^p a[m], relative to the size of the terms */
+        double moment = 0.0, size = 0.0;
+        for (int m = 0; m <= M; m++)
+        {
+            const double term = pow((double) m, p) * mask.entry[m];
+            moment += (m % 2 == 0) ? term : -term;
+            size += fabs(term);
+        }
+        if (fabs(moment) > 1e-12 * max(size, scale)) { return p; }
+    }
+
+    return M + 1;
+}
+
+
+bool refinable_gram(const mask_t& a, const mask_t& b, int r, band_t& band)
+{
+    const int Ma = a.length - 1, Mb = b.length - 1;
+    const int first = -Mb + 1, K = Ma + Mb - 1; /* G(first), ..., G(first + K - 1) */
+    band.first = first;
+    band.entry.assign(max(K, 0), 0.0);
+    if (r < 0 || r > max_gram_derivative || K < 1) { return false; }
+    if (sum_rule_order(a) + sum_rule_order(b) < 2*r + 1) { return false; }
+
+    /* T[k][n] = 4^r / 2 sum_l a[2k + l - n] b[l] */
+    const double factor = ldexp(1.0, 2*r - 1);
+    vector<double> T(K * K, 0.0);
+    for (int i = 0; i < K; i++)
+    {
+        for (int j = 0; j < K; j++)
+        {
+            const int shift = 2*(first + i) - (first + j);
+            double value = 0.0;
+            for (int l = 0; l <= Mb; l++)
+            {
+                const int m = shift + l;
+                if (0 <= m && m <= Ma) { value += a.entry[m] * b.entry[l]; }
+            }
+            T[i*K + j] = factor * value;
+        }
+    }
+
+    /* normalization sum_k k^2r G(k) = (-1)^r (2r)! */
+    vector<double> moments(K);
+    double normalization = (r % 2 == 0) ? 1.0 : -1.0;
+    for (int i = 2; i <= 2*r; i++) { normalization *= i; }
+    for (int j = 0; j < K; j++) { moments[j] = pow((double) (first + j), 2*r); }
+
+    /*
+     * (T - I) G = 0 has rank K - 1 for a simple eigenvalue, one of its rows
+     * is replaced by the normalization. Under the sum rules with r = 0 the
+     * columns of T sum to 1 and the last row can go, otherwise the rows are
+     * tried from the last one until the solution meets all equations.
+     */
+    double scale = 0.0;
+    for (int i = 0; i < K*K; i++) { scale = max(scale, fabs(T[i])); }
+    for (int dropped = K - 1; dropped >= 0; dropped--)
+    {
+        vector<double> A(K * K), x(K, 0.0);
+        for (int i = 0; i < K; i++)
+        {
+            for (int j = 0; j < K; j++)
+            {
+                A[i*K + j] = (i == dropped) ? moments[j] : T[i*K + j] - ((i == j) ? 1.0 : 0.0);
+            }
+        }
+        x[dropped] = normalization;
+        if (!solve_linear_system(A, x, K)) { continue; }
+
+        /* all eigenvalue equations, including the dropped one */
+        double residual = 0.0, size = 0.0;
+        for (int i = 0; i < K; i++)
+        {
+            double Tx = 0.0;
+            for (int j = 0; j < K; j++) { Tx += T[i*K + j] * x[j]; }
+            residual = max(residual, fabs(Tx - x[i]));
+            size = max(size, fabs(x[i]));
+        }
+        if (residual <= 1e-9 * max(1.0, scale) * max(1.0, size))
+        {
+            /* for a = b, G(-k) = G(k) also in floating point */
+            if (Ma == Mb && equal(a.entry, a.entry + a.length, b.entry))
+            {
+                for (int i = 0; i < K / 2; i++) { x[i] = x[K-1-i] = 0.5 * (x[i] + x[K-1-i]); }
+            }
+            band.entry = x;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static unordered_map<string, unique_ptr<band_t> > gram_cache;
+static mutex gram_cache_lock;
+
+/*
+ * key of the coefficients of both masks, bit for bit, and r
+ */
+static string gram_key(const mask_t& a, const mask_t& b, int r)
+{
+    string key((const char*) &r, sizeof(r));
+    key.append((const char*) &a.length, sizeof(a.length));
+    key.append((const char*) a.entry, a.length * sizeof(double));
+    key.append((const char*) &b.length, sizeof(b.length));
+    key.append((const char*) b.entry, b.length * sizeof(double));
+
+    return key;
+}
+
+
+const band_t* select_gram(const mask_t& a, const mask_t& b, int r)
+{
+    const string key = gram_key(a, b, r);
+
+    lock_guard<mutex> guard(gram_cache_lock);
+
+    const auto found = gram_cache.find(key);
+    if (found != gram_cache.end()) { return found->second.get(); }
+
+    unique_ptr<band_t> band(new band_t);
+    if (!refinable_gram(a, b, r, *band)) { return NULL; }
+
+    return (gram_cache[key] = move(band)).get();
+}
+
+
+/*
+ * mask binom(m, i) / 2^(m-1) of the B-spline N_m
+ */
+static vector<double> bspline_mask(int m)
+{
+    vector<double> mask(m + 1, 0.0);
+    mask[0] = 1.0;
+    for (int i = 1; i <= m; i++)
+    {
+        for (int j = i; j > 0; j--) { mask[j] += mask[j-1]; }
+    }
+    for (int i = 0; i <= m; i++) { mask[i] = ldexp(mask[i], 1 - m); }
+
+    return mask;
+}
+
+
+bool verify_gram(ostream* log)
+{
+    bool valid = true;
+    double max_error = 0.0;
+
+    /*
+     * int N_m^(r)(x) N_m^(r)(x - k) dx = (-1)^r N_2m^(2r)(m + k)
+     *   = (-1)^r sum_j (-1)^j binom(2r, j) N_{2m-2r}(m + k - j)
+     */
+    int cases = 0;
+    for (int m = 2; m <= 6; m++)
+    {
+        const vector<double> coefficients = bspline_mask(m);
+        const mask_t N = {coefficients.data(), m + 1, "N_" + to_string(m)};
+        for (int r = 0; r < m && r <= max_gram_derivative; r++)
+        {
+            const vector<double> lower_coefficients = bspline_mask(2*m - 2*r);
+            const mask_t lower = {lower_coefficients.data(), 2*m - 2*r + 1, ""};
+            vector<double> values;
+            band_t band;
+            if (!integer_values(lower, values) || !refinable_gram(N, N, r, band))
+            {
+                if (log != NULL) { *log << N.name << ", r = " << r << ": no inner products  FAILED\n"; }
+                valid = false;
+                continue;
+            }
+
+            for (size_t i = 0; i < band.entry.size(); i++)
+            {
+                const int k = band.first + (int) i;
+                double expected = 0.0, binomial = 1.0;
+                for (int j = 0; j <= 2*r; j++)
+                {
+                    const int u = m + k - j;
+                    if (u >= 0 && u < (int) values.size()) { expected += ((j % 2 == 0) ? binomial : -binomial) * values[u]; }
+                    binomial = binomial * (2*r - j) / (j + 1);
+                }
+                if (r % 2 == 1) { expected = -expected; }
+                max_error = max(max_error, fabs(band.entry[i] - expected));
+                valid = valid && fabs(band.entry[i] - expected) <= 1e-11 * max(1.0, fabs(expected));
+                valid = valid && band.entry[i] == band.entry[band.entry.size() - 1 - i];
+            }
+            cases++;
+        }
+    }
+
+    /* biorthogonality, int N_m(x) phi~(x - k) dx = 1 for one k and 0 otherwise */
+    const int pairs[][2] = {{1, 10}, {2, 11}, {3, 12}, {4, 13}};
+    for (const auto& pair : pairs)
+    {
+        const mask_t& a = *select_mask(pair[0]);
+        const mask_t& b = *select_mask(pair[1]);
+        const band_t* band = select_gram(a, b, 0);
+        int ones = 0;
+        for (size_t i = 0; band != NULL && i < band->entry.size(); i++)
+        {
+            const double target = (fabs(band->entry[i] - 1.0) < 0.5) ? 1.0 : 0.0;
+            ones += (target == 1.0);
+            max_error = max(max_error, fabs(band->entry[i] - target));
+            valid = valid && fabs(band->entry[i] - target) <= 1e-12;
+        }
+        valid = valid && ones == 1 && select_gram(a, b, 0) == band;
+        cases++;
+    }
+
+    if (log != NULL)
+    {
+        *log << "Gram matrices: " << cases << " cases, error " << max_error << (valid ? "" : "  FAILED") << "\n";
+    }
+
+    return valid;
+}
@@ -0,0 +1,66 @@
+/*
+ * gram.h
+ * Exact inner products of shifted refinable functions and their derivatives.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_GRAM_H
+#define SUBDIVISION_GRAM_H
+
+#include <ostream>
+#include "masks.h"
+#include "../common/banded_matrix.h"
+
+
+/* largest derivative order of the inner products */
+const int max_gram_derivative = 4;
+
+/*
+ * Inner products G(k) = int phi_a^(r)(x) phi_b^(r)(x - k) dx of the
+ * refinable functions of the masks a and b, with support [0, M_a] and
+ * [0, M_b]: r = 0 gives the mass matrix, r = 1 the stiffness matrix.
+ * The refinement equations give
+ *   G(k) = 4^r / 2 sum_{m,l} a[m] b[l] G(2k + l - m),
+ * so G(-M_b+1), ..., G(M_a-1) is an eigenvector of a finite matrix for the
+ * eigenvalue 1. It is normalized by sum_k k^2r G(k) = (-1)^r (2r)!, which
+ * holds if the shifts of the autocorrelation reproduce polynomials of
+ * degree 2r, i.e. the sum rule orders of a and b add up to 2r + 1 or more.
+ * No sampling is involved, the entries are exact up to rounding.
+ * @param a, b refinement masks with sum 2, a = b for the Gram matrix of phi
+ * @param r derivative order, 0..max_gram_derivative, phi^(r) has to be
+ *        square integrable
+ * @param band G(k) for k = -M_b+1, ..., M_a-1
+ * @return false if the sum rules do not suffice or the eigenvector is not
+ *         unique, band is undefined then
+ */
+bool refinable_gram(const mask_t& a, const mask_t& b, int r, band_t& band);
+
+/*
+ * refinable_gram() computed once per coefficients of a and b and r, and
+ * kept in a cache. Entries are never removed, so the pointer stays valid.
+ * Safe to call from several threads.
+ * @return band or NULL if refinable_gram() fails
+ */
+const band_t* select_gram(const mask_t& a, const mask_t& b, int r);
+
+/*
+ * @param mask refinement mask
+ * @return largest p with sum_m (-1)^m m^j a[m] = 0 for j < p
+ */
+int sum_rule_order(const mask_t& mask);
+
+/*
+ * Compare the inner products of the B-splines N_2, ..., N_6 and their
+ * derivatives with values of N_2m at the integers, and check the
+ * biorthogonality of N_m and the CDF dual masks.
+ * @param log receives a summary line, may be NULL
+ * @return true if all agree
+ */
+bool verify_gram(std::ostream* log);
+
+#endif /* SUBDIVISION_GRAM_H */
@@ -0,0 +1,208 @@
+/*
+ * kernels.cpp
+ * Refinement kernels of the cascade algorithm.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+#include "kernels.h"
+#include "../common/aligned_buffer.h"
+
+using namespace std;
+
+
+polyphase_t polyphase(const mask_t& mask)
+{
+    polyphase_t filter;
+
+    for (int l = 0; l < mask.length; l++)
+    {
+        if (l % 2 == 0) { filter.even.push_back(mask.entry[l]); }
+        else            { filter.odd.push_back(mask.entry[l]); }
+    }
+    filter.padding = (int) max(filter.even.size(), filter.odd.size());
+    if (filter.padding > 0) { filter.padding--; }
+
+    return filter;
+}
+
+
+void refine_scalar(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine)
+{
+    const double* even = filter.even.data();
+    const double* odd = filter.odd.data();
+    const int n_even = (int) filter.even.size();
+    const int n_odd = (int) filter.odd.size();
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const double* c = coarse + i; /* c[-t] = coarse[i-t] */
+        double value_even = 0.0;
+        double value_odd = 0.0;
+
+        for (int t = 0; t < n_even; t++)
+        {
+            value_even += even[t] * c[-t];
+        }
+        for (int t = 0; t < n_odd; t++)
+        {
+            value_odd += odd[t] * c[-t];
+        }
+
+        fine[2*i] = value_even;
+        fine[2*i+1] = value_odd;
+    }
+}
+
+
+/*
+ * runtime dispatch, read by the pool threads of the cascades
+ */
+static atomic<isa_t> active_isa(detect_isa());
+
+
+isa_t detect_isa()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) { return isa_avx512; }
+    if (__builtin_cpu_supports("avx2"))    { return isa_avx2; }
+    if (__builtin_cpu_supports("sse2"))    { return isa_sse2; }
+#endif
+    return isa_scalar;
+}
+
+
+template <typename T>
+basic_refine_kernel<T> refine_kernel(isa_t isa, int length)
+{
+    const isa_t supported = detect_isa();
+
+    return unrolled_kernel<T>((isa > supported) ? supported : isa, length);
+}
+
+template basic_refine_kernel<float> refine_kernel<float>(isa_t isa, int length);
+template basic_refine_kernel<double> refine_kernel<double>(isa_t isa, int length);
+template basic_refine_kernel<long double> refine_kernel<long double>(isa_t isa, int length);
+template basic_refine_kernel<dd_real> refine_kernel<dd_real>(isa_t isa, int length);
+
+
+isa_t select_isa(isa_t isa)
+{
+    const isa_t supported = detect_isa();
+    const isa_t selected = (isa > supported) ? supported : isa;
+    active_isa.store(selected);
+
+    return selected;
+}
+
+
+isa_t selected_isa()
+{
+    return active_isa.load();
+}
+
+
+const char* isa_name(isa_t isa)
+{
+    switch (isa)
+    {
+        case isa_sse2:   return "SSE2";
+        case isa_avx2:   return "AVX2";
+        case isa_avx512: return "AVX-512";
+        default:         return "scalar";
+    }
+}
+
+
+void refine(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine)
+{
+    const int length = (int) (filter.even.size() + filter.odd.size());
+
+    unrolled_kernel(active_isa.load(), length)(filter, coarse, begin, end, fine);
+}
+
+
+/*
+ * all kernels of the scalar type T against the scalar generic kernel of T
+ */
+template <typename T>
+static bool compare_kernels(const mask_t& mask, const char* type, ostream* log)
+{
+    const basic_polyphase<T> filter = convert_polyphase<T>(polyphase(mask));
+    const size_t n = 1003; /* odd size exercises the remainder loops */
+    const size_t offset = 16;
+    AlignedBuffer<T> coarse(offset + n), expected(2*n), result(2*n);
+
+    srand(4711);
+    for (size_t i = 0; i < n; i++)
+    {
+        coarse[offset + i] = (T) (2.0 * rand() / (double) RAND_MAX - 1.0);
+    }
+    unrolled_kernel<T>(isa_scalar, 0)(filter, coarse.data() + offset, 0, n, expected.data());
+
+    bool all_equal = true;
+    for (int isa = isa_scalar; isa <= detect_isa(); isa++)
+    {
+        for (int unrolled = 0; unrolled <= 1; unrolled++)
+        {
+            const basic_refine_kernel<T> kernel = refine_kernel<T>((isa_t) isa, unrolled ? mask.length : 0);
+
+            /* full range */
+            result.fill_zero();
+            kernel(filter, coarse.data() + offset, 0, n, result.data());
+            bool equal = (memcmp(expected.data(), result.data(), 2*n * sizeof(T)) == 0);
+
+            /* a range with unaligned bounds writes exactly fine[6], ..., fine[1033] */
+            const size_t begin = 3, end = 517;
+            result.fill_zero();
+            kernel(filter, coarse.data() + offset, begin, end, result.data());
+            equal = equal && memcmp(expected.data() + 2*begin, result.data() + 2*begin, 2*(end - begin) * sizeof(T)) == 0;
+            for (size_t i = 0; i < 2*n; i++)
+            {
+                equal = equal && (result[i] == T(0) || (2*begin <= i && i < 2*end));
+            }
+            all_equal = all_equal && equal;
+
+            if (log != NULL)
+            {
+                *log << mask.name << ": " << isa_name((isa_t) isa) << " " << type
+                     << (unrolled && mask.length <= max_fixed_length ? " unrolled" : " generic") << " kernel "
+                     << (equal ? "agrees with" : "DIFFERS from") << " scalar reference\n";
+            }
+        }
+    }
+
+    return all_equal;
+}
+
+
+bool verify_kernels(const mask_t& mask, ostream* log)
+{
+    /* the double kernels also against the plain loop of refine_scalar() */
+    const polyphase_t filter = polyphase(mask);
+    const size_t n = 1003;
+    AlignedBuffer<double> coarse(16 + n), expected(2*n), generic(2*n);
+    srand(4711);
+    for (size_t i = 0; i < n; i++)
+    {
+        coarse[16 + i] = 2.0 * rand() / (double) RAND_MAX - 1.0;
+    }
+    refine_scalar(filter, coarse.data() + 16, 0, n, expected.data());
+    unrolled_kernel(isa_scalar, 0)(filter, coarse.data() + 16, 0, n, generic.data());
+    const bool reference_equal = (memcmp(expected.data(), generic.data(), 2*n * sizeof(double)) == 0);
+
+    const bool double_equal = compare_kernels<double>(mask, "double", log);
+    const bool float_equal = compare_kernels<float>(mask, "float", log);
+
+    return reference_equal && double_equal && float_equal;
+}
@@ -0,0 +1,140 @@
+/*
+ * kernels.h
+ * Refinement kernels of the cascade algorithm.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_KERNELS_H
+#define SUBDIVISION_KERNELS_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "masks.h"
+#include "../common/precision.h"
+
+
+/*
+ * polyphase form of a refinement mask a:
+ * even sub-filter a[0], a[2], a[4], ... and odd sub-filter a[1], a[3], ...
+ * in the scalar type T of the cascade
+ */
+template <typename T>
+struct basic_polyphase {
+    std::vector<T> even;
+    std::vector<T> odd;
+    int padding; /* number of zeros needed in front of the coarse level */
+};
+
+typedef basic_polyphase<double> polyphase_t;
+
+/*
+ * @param mask refinement mask
+ * @return even and odd sub-filters of mask
+ */
+polyphase_t polyphase(const mask_t& mask);
+
+/*
+ * @param filter sub-filters in double
+ * @return sub-filters rounded to T, exact for the dyadic masks
+ */
+template <typename T>
+basic_polyphase<T> convert_polyphase(const polyphase_t& filter)
+{
+    basic_polyphase<T> converted;
+    converted.even.assign(filter.even.begin(), filter.even.end());
+    converted.odd.assign(filter.odd.begin(), filter.odd.end());
+    converted.padding = filter.padding;
+
+    return converted;
+}
+
+
+/*
+ * instruction sets of the refinement kernels
+ */
+typedef enum {
+    isa_scalar = 0,
+    isa_sse2,
+    isa_avx2,
+    isa_avx512
+}isa_t;
+
+/*
+ * One subdivision step S_j[k] = sum_m a[k-2m] S_{j-1}[m] in polyphase form:
+ *   fine[2i]   = sum_t even[t] * coarse[i-t]
+ *   fine[2i+1] = sum_t odd[t]  * coarse[i-t]
+ * for begin <= i < end. coarse[-filter.padding], ..., coarse[-1] have to
+ * be readable and zero, fine has to provide room for 2*end samples.
+ *
+ * All kernels add the products in the same order (t = 0, 1, ...) without
+ * fused multiply-add, so their results agree bit for bit with the scalar
+ * reference refine_scalar().
+ */
+template <typename T>
+using basic_refine_kernel = void (*)(const basic_polyphase<T>& filter, const T* coarse, size_t begin, size_t end, T* fine);
+
+typedef basic_refine_kernel<double> refine_kernel_t;
+
+void refine_scalar(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine);
+void refine_sse2(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine);
+void refine_avx2(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine);
+void refine_avx512(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine);
+
+/*
+ * dispatching kernel, uses the widest instruction set supported by the cpu
+ * unless a narrower one was chosen by select_isa(), and the kernel unrolled
+ * for the length of the mask if there is one
+ */
+void refine(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine);
+
+/* widest instruction set supported by the cpu */
+isa_t detect_isa();
+
+/*
+ * Safe to call while other threads refine, a cascade which already took
+ * its kernel keeps it.
+ * @param isa instruction set used by refine(), at most detect_isa()
+ * @return instruction set actually selected
+ */
+isa_t select_isa(isa_t isa);
+
+/* instruction set currently used by refine() */
+isa_t selected_isa();
+
+const char* isa_name(isa_t isa);
+
+/* masks up to this length have kernels with completely unrolled tap loops */
+const int max_fixed_length = 16;
+
+/*
+ * Kernels exist for T = float, double, long double and dd_real: float and
+ * double have vectorized kernels, float with twice the samples per vector,
+ * the other types use the scalar kernel for every instruction set.
+ * @param isa instruction set, reduced to detect_isa() if not supported
+ * @param length mask length, 0 or a length above max_fixed_length selects
+ *        the generic kernel which takes the number of taps from the filter
+ * @return kernel for isa and masks of this length
+ */
+template <typename T = double>
+basic_refine_kernel<T> refine_kernel(isa_t isa, int length = 0);
+
+/* dispatch table of kernels_simd.cpp, isa has to be supported by the cpu */
+template <typename T = double>
+basic_refine_kernel<T> unrolled_kernel(isa_t isa, int length);
+
+/*
+ * Compare the generic and the unrolled kernels of all supported instruction
+ * sets with refine_scalar on random levels, in double and in float.
+ * @param mask refinement mask
+ * @param log stream for a report per kernel, may be NULL
+ * @return true if all kernels agree bit for bit with the scalar reference
+ */
+bool verify_kernels(const mask_t& mask, std::ostream* log);
+
+#endif /* SUBDIVISION_KERNELS_H */
@@ -0,0 +1,476 @@
+/*
+ * kernels_simd.cpp
+ * Unrolled and vectorized (SSE2, AVX2, AVX-512) refinement kernels of the
+ * cascade algorithm.
+ *
+ * Every kernel computes a block of consecutive even and odd output samples
+ * per iteration: the products of one tap with the coarse samples
+ * coarse[i-t], ..., coarse[i+w-1-t] are added to the accumulators of the
+ * even and the odd phase, afterwards both phases are interleaved and stored
+ * to fine[2i], ..., fine[2i+2w-1]. The remaining samples are handled by
+ * the scalar kernel. The functions are compiled for their instruction set by
+ * target attributes and selected at run time, see kernels.cpp.
+ *
+ * All kernels are templates on the scalar type and the number of even and
+ * odd taps. The vector operations of float and double are collected in one
+ * struct per instruction set, so both share the kernel code; float vectors
+ * hold twice the samples. For every mask length up to max_fixed_length an
+ * unrolled instance is entered in the dispatch table, longer masks use the
+ * generic instance. long double and dd_real have the scalar kernels only.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <array>
+#include <type_traits>
+#include <utility>
+#include "kernels.h"
+
+using namespace std;
+
+
+/*
+ * Scalar kernel with NE even and NO odd taps, NE = NO = -1 takes the number
+ * of taps from the filter. Fixed tap counts let the compiler unroll the tap
+ * loops completely and keep the coefficients in registers.
+ */
+template <typename T, int NE, int NO>
+static void refine_scalar_taps(const basic_polyphase<T>& filter, const T* coarse, size_t begin, size_t end, T* fine)
+{
+    const T* even = filter.even.data();
+    const T* odd = filter.odd.data();
+    const int n_even = (NE < 0) ? (int) filter.even.size() : NE;
+    const int n_odd = (NO < 0) ? (int) filter.odd.size() : NO;
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const T* c = coarse + i; /* c[-t] = coarse[i-t] */
+        T value_even = 0.0;
+        T value_odd = 0.0;
+
+#pragma GCC unroll 16
+        for (int t = 0; t < n_even; t++)
+        {
+            value_even += even[t] * c[-t];
+        }
+#pragma GCC unroll 16
+        for (int t = 0; t < n_odd; t++)
+        {
+            value_odd += odd[t] * c[-t];
+        }
+
+        fine[2*i] = value_even;
+        fine[2*i+1] = value_odd;
+    }
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <immintrin.h>
+
+
+/*
+ * vector operations, interleave(f, e, o) stores e0 o0 e1 o1 ... to f
+ */
+template <typename T> struct sse2_vector;
+
+template <>
+struct sse2_vector<double>
+{
+    typedef __m128d type;
+    static const size_t width = 2;
+    __attribute__((target("sse2"))) static type zero() { return _mm_setzero_pd(); }
+    __attribute__((target("sse2"))) static type set1(double a) { return _mm_set1_pd(a); }
+    __attribute__((target("sse2"))) static type load(const double* p) { return _mm_loadu_pd(p); }
+    __attribute__((target("sse2"))) static type add(type a, type b) { return _mm_add_pd(a, b); }
+    __attribute__((target("sse2"))) static type mul(type a, type b) { return _mm_mul_pd(a, b); }
+
+    /* (e0 e1), (o0 o1) -> (e0 o0), (e1 o1) */
+    __attribute__((target("sse2"))) static void interleave(double* f, type e, type o)
+    {
+        _mm_storeu_pd(f,     _mm_unpacklo_pd(e, o));
+        _mm_storeu_pd(f + 2, _mm_unpackhi_pd(e, o));
+    }
+};
+
+template <>
+struct sse2_vector<float>
+{
+    typedef __m128 type;
+    static const size_t width = 4;
+    __attribute__((target("sse2"))) static type zero() { return _mm_setzero_ps(); }
+    __attribute__((target("sse2"))) static type set1(float a) { return _mm_set1_ps(a); }
+    __attribute__((target("sse2"))) static type load(const float* p) { return _mm_loadu_ps(p); }
+    __attribute__((target("sse2"))) static type add(type a, type b) { return _mm_add_ps(a, b); }
+    __attribute__((target("sse2"))) static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+
+    /* (e0 .. e3), (o0 .. o3) -> (e0 o0 e1 o1), (e2 o2 e3 o3) */
+    __attribute__((target("sse2"))) static void interleave(float* f, type e, type o)
+    {
+        _mm_storeu_ps(f,     _mm_unpacklo_ps(e, o));
+        _mm_storeu_ps(f + 4, _mm_unpackhi_ps(e, o));
+    }
+};
+
+
+template <typename T> struct avx2_vector;
+
+template <>
+struct avx2_vector<double>
+{
+    typedef __m256d type;
+    static const size_t width = 4;
+    __attribute__((target("avx2"))) static type zero() { return _mm256_setzero_pd(); }
+    __attribute__((target("avx2"))) static type set1(double a) { return _mm256_set1_pd(a); }
+    __attribute__((target("avx2"))) static type load(const double* p) { return _mm256_loadu_pd(p); }
+    __attribute__((target("avx2"))) static type add(type a, type b) { return _mm256_add_pd(a, b); }
+    __attribute__((target("avx2"))) static type mul(type a, type b) { return _mm256_mul_pd(a, b); }
+
+    /* (e0 e1 e2 e3), (o0 o1 o2 o3) -> (e0 o0 e2 o2), (e1 o1 e3 o3) -> (e0 o0 e1 o1), (e2 o2 e3 o3) */
+    __attribute__((target("avx2"))) static void interleave(double* f, type e, type o)
+    {
+        const type lo = _mm256_unpacklo_pd(e, o);
+        const type hi = _mm256_unpackhi_pd(e, o);
+        _mm256_storeu_pd(f,     _mm256_permute2f128_pd(lo, hi, 0x20));
+        _mm256_storeu_pd(f + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    }
+};
+
+template <>
+struct avx2_vector<float>
+{
+    typedef __m256 type;
+    static const size_t width = 8;
+    __attribute__((target("avx2"))) static type zero() { return _mm256_setzero_ps(); }
+    __attribute__((target("avx2"))) static type set1(float a) { return _mm256_set1_ps(a); }
+    __attribute__((target("avx2"))) static type load(const float* p) { return _mm256_loadu_ps(p); }
+    __attribute__((target("avx2"))) static type add(type a, type b) { return _mm256_add_ps(a, b); }
+    __attribute__((target("avx2"))) static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+
+    /* unpack within the 128 bit lanes, then the lanes in order as for double */
+    __attribute__((target("avx2"))) static void interleave(float* f, type e, type o)
+    {
+        const type lo = _mm256_unpacklo_ps(e, o);
+        const type hi = _mm256_unpackhi_ps(e, o);
+        _mm256_storeu_ps(f,     _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(f + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+};
+
+
+template <typename T> struct avx512_vector;
+
+template <>
+struct avx512_vector<double>
+{
+    typedef __m512d type;
+    static const size_t width = 8;
+    __attribute__((target("avx512f"))) static type zero() { return _mm512_setzero_pd(); }
+    __attribute__((target("avx512f"))) static type set1(double a) { return _mm512_set1_pd(a); }
+    __attribute__((target("avx512f"))) static type load(const double* p) { return _mm512_loadu_pd(p); }
+    __attribute__((target("avx512f"))) static type add(type a, type b) { return _mm512_add_pd(a, b); }
+    __attribute__((target("avx512f"))) static type mul(type a, type b) { return _mm512_mul_pd(a, b); }
+
+    /* positions of e0 o0 e1 o1 ... in the concatenation (even, odd) */
+    __attribute__((target("avx512f"))) static void interleave(double* f, type e, type o)
+    {
+        const __m512i first = _mm512_set_epi64(11, 3, 10, 2, 9, 1, 8, 0);
+        const __m512i second = _mm512_set_epi64(15, 7, 14, 6, 13, 5, 12, 4);
+        _mm512_storeu_pd(f,     _mm512_permutex2var_pd(e, first, o));
+        _mm512_storeu_pd(f + 8, _mm512_permutex2var_pd(e, second, o));
+    }
+};
+
+template <>
+struct avx512_vector<float>
+{
+    typedef __m512 type;
+    static const size_t width = 16;
+    __attribute__((target("avx512f"))) static type zero() { return _mm512_setzero_ps(); }
+    __attribute__((target("avx512f"))) static type set1(float a) { return _mm512_set1_ps(a); }
+    __attribute__((target("avx512f"))) static type load(const float* p) { return _mm512_loadu_ps(p); }
+    __attribute__((target("avx512f"))) static type add(type a, type b) { return _mm512_add_ps(a, b); }
+    __attribute__((target("avx512f"))) static type mul(type a, type b) { return _mm512_mul_ps(a, b); }
+
+    __attribute__((target("avx512f"))) static void interleave(float* f, type e, type o)
+    {
+        const __m512i first = _mm512_set_epi32(23, 7, 22, 6, 21, 5, 20, 4, 19, 3, 18, 2, 17, 1, 16, 0);
+        const __m512i second = _mm512_set_epi32(31, 15, 30, 14, 29, 13, 28, 12, 27, 11, 26, 10, 25, 9, 24, 8);
+        _mm512_storeu_ps(f,      _mm512_permutex2var_ps(e, first, o));
+        _mm512_storeu_ps(f + 16, _mm512_permutex2var_ps(e, second, o));
+    }
+};
+
+
+/*
+ * 2 (double) or 4 (float) x 2 samples per vector pair, 2 vector pairs per iteration
+ */
+template <typename T, int NE, int NO>
+__attribute__((target("sse2")))
+static void refine_sse2_taps(const basic_polyphase<T>& filter, const T* coarse, size_t begin, size_t end, T* fine)
+{
+    typedef sse2_vector<T> V;
+    typedef typename V::type vector_t;
+    const size_t W = V::width;
+    const T* even = filter.even.data();
+    const T* odd = filter.odd.data();
+    const int n_even = (NE < 0) ? (int) filter.even.size() : NE;
+    const int n_odd = (NO < 0) ? (int) filter.odd.size() : NO;
+    const int n_common = (n_even < n_odd) ? n_even : n_odd;
+
+    size_t i = begin;
+    for (; i + 2*W <= end; i += 2*W)
+    {
+        const T* c = coarse + i;
+        vector_t even0 = V::zero(), even1 = V::zero();
+        vector_t odd0 = V::zero(), odd1 = V::zero();
+        int t = 0;
+
+#pragma GCC unroll 16
+        for (; t < n_common; t++)
+        {
+            const vector_t x0 = V::load(c - t);
+            const vector_t x1 = V::load(c - t + W);
+            const vector_t ae = V::set1(even[t]);
+            const vector_t ao = V::set1(odd[t]);
+            even0 = V::add(even0, V::mul(ae, x0));
+            even1 = V::add(even1, V::mul(ae, x1));
+            odd0 = V::add(odd0, V::mul(ao, x0));
+            odd1 = V::add(odd1, V::mul(ao, x1));
+        }
+#pragma GCC unroll 16
+        for (int te = t; te < n_even; te++)
+        {
+            const vector_t ae = V::set1(even[te]);
+            even0 = V::add(even0, V::mul(ae, V::load(c - te)));
+            even1 = V::add(even1, V::mul(ae, V::load(c - te + W)));
+        }
+#pragma GCC unroll 16
+        for (int to = t; to < n_odd; to++)
+        {
+            const vector_t ao = V::set1(odd[to]);
+            odd0 = V::add(odd0, V::mul(ao, V::load(c - to)));
+            odd1 = V::add(odd1, V::mul(ao, V::load(c - to + W)));
+        }
+
+        T* f = fine + 2*i;
+        V::interleave(f, even0, odd0);
+        V::interleave(f + 2*W, even1, odd1);
+    }
+
+    refine_scalar_taps<T, NE, NO>(filter, coarse, i, end, fine);
+}
+
+
+/*
+ * 4 (double) or 8 (float) x 2 samples per vector pair, 2 vector pairs per iteration
+ */
+template <typename T, int NE, int NO>
+__attribute__((target("avx2")))
+static void refine_avx2_taps(const basic_polyphase<T>& filter, const T* coarse, size_t begin, size_t end, T* fine)
+{
+    typedef avx2_vector<T> V;
+    typedef typename V::type vector_t;
+    const size_t W = V::width;
+    const T* even = filter.even.data();
+    const T* odd = filter.odd.data();
+    const int n_even = (NE < 0) ? (int) filter.even.size() : NE;
+    const int n_odd = (NO < 0) ? (int) filter.odd.size() : NO;
+    const int n_common = (n_even < n_odd) ? n_even : n_odd;
+
+    size_t i = begin;
+    for (; i + 2*W <= end; i += 2*W)
+    {
+        const T* c = coarse + i;
+        vector_t even0 = V::zero(), even1 = V::zero();
+        vector_t odd0 = V::zero(), odd1 = V::zero();
+        int t = 0;
+
+#pragma GCC unroll 16
+        for (; t < n_common; t++)
+        {
+            const vector_t x0 = V::load(c - t);
+            const vector_t x1 = V::load(c - t + W);
+            const vector_t ae = V::set1(even[t]);
+            const vector_t ao = V::set1(odd[t]);
+            even0 = V::add(even0, V::mul(ae, x0));
+            even1 = V::add(even1, V::mul(ae, x1));
+            odd0 = V::add(odd0, V::mul(ao, x0));
+            odd1 = V::add(odd1, V::mul(ao, x1));
+        }
+#pragma GCC unroll 16
+        for (int te = t; te < n_even; te++)
+        {
+            const vector_t ae = V::set1(even[te]);
+            even0 = V::add(even0, V::mul(ae, V::load(c - te)));
+            even1 = V::add(even1, V::mul(ae, V::load(c - te + W)));
+        }
+#pragma GCC unroll 16
+        for (int to = t; to < n_odd; to++)
+        {
+            const vector_t ao = V::set1(odd[to]);
+            odd0 = V::add(odd0, V::mul(ao, V::load(c - to)));
+            odd1 = V::add(odd1, V::mul(ao, V::load(c - to + W)));
+        }
+
+        T* f = fine + 2*i;
+        V::interleave(f, even0, odd0);
+        V::interleave(f + 2*W, even1, odd1);
+    }
+
+    refine_sse2_taps<T, NE, NO>(filter, coarse, i, end, fine);
+}
+
+
+/*
+ * 8 (double) or 16 (float) x 2 samples per vector pair, 2 vector pairs per iteration
+ */
+template <typename T, int NE, int NO>
+__attribute__((target("avx512f")))
+static void refine_avx512_taps(const basic_polyphase<T>& filter, const T* coarse, size_t begin, size_t end, T* fine)
+{
+    typedef avx512_vector<T> V;
+    typedef typename V::type vector_t;
+    const size_t W = V::width;
+    const T* even = filter.even.data();
+    const T* odd = filter.odd.data();
+    const int n_even = (NE < 0) ? (int) filter.even.size() : NE;
+    const int n_odd = (NO < 0) ? (int) filter.odd.size() : NO;
+    const int n_common = (n_even < n_odd) ? n_even : n_odd;
+
+    size_t i = begin;
+    for (; i + 2*W <= end; i += 2*W)
+    {
+        const T* c = coarse + i;
+        vector_t even0 = V::zero(), even1 = V::zero();
+        vector_t odd0 = V::zero(), odd1 = V::zero();
+        int t = 0;
+
+#pragma GCC unroll 16
+        for (; t < n_common; t++)
+        {
+            const vector_t x0 = V::load(c - t);
+            const vector_t x1 = V::load(c - t + W);
+            const vector_t ae = V::set1(even[t]);
+            const vector_t ao = V::set1(odd[t]);
+            even0 = V::add(even0, V::mul(ae, x0));
+            even1 = V::add(even1, V::mul(ae, x1));
+            odd0 = V::add(odd0, V::mul(ao, x0));
+            odd1 = V::add(odd1, V::mul(ao, x1));
+        }
+#pragma GCC unroll 16
+        for (int te = t; te < n_even; te++)
+        {
+            const vector_t ae = V::set1(even[te]);
+            even0 = V::add(even0, V::mul(ae, V::load(c - te)));
+            even1 = V::add(even1, V::mul(ae, V::load(c - te + W)));
+        }
+#pragma GCC unroll 16
+        for (int to = t; to < n_odd; to++)
+        {
+            const vector_t ao = V::set1(odd[to]);
+            odd0 = V::add(odd0, V::mul(ao, V::load(c - to)));
+            odd1 = V::add(odd1, V::mul(ao, V::load(c - to + W)));
+        }
+
+        T* f = fine + 2*i;
+        V::interleave(f, even0, odd0);
+        V::interleave(f + 2*W, even1, odd1);
+    }
+
+    refine_avx2_taps<T, NE, NO>(filter, coarse, i, end, fine);
+}
+
+void refine_sse2(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine)
+{
+    refine_sse2_taps<double, -1, -1>(filter, coarse, begin, end, fine);
+}
+
+
+void refine_avx2(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine)
+{
+    refine_avx2_taps<double, -1, -1>(filter, coarse, begin, end, fine);
+}
+
+
+void refine_avx512(const polyphase_t& filter, const double* coarse, size_t begin, size_t end, double* fine)
+{
+    refine_avx512_taps<double, -1, -1>(filter, coarse, begin, end, fine);
+}
+
+
+/*
+ * kernels unrolled for a mask of length L, L = 0 selects the generic ones
+ */
+template <typename T, int L>
+static constexpr basic_refine_kernel<T> fixed_kernel(isa_t isa)
+{
+    const int NE = (L == 0) ? -1 : (L + 1) / 2;
+    const int NO = (L == 0) ? -1 : L / 2;
+
+    if constexpr (is_same<T, double>::value || is_same<T, float>::value)
+    {
+        switch (isa)
+        {
+            case isa_sse2:
+                return refine_sse2_taps<T, NE, NO>;
+            case isa_avx2:
+                return refine_avx2_taps<T, NE, NO>;
+            case isa_avx512:
+                return refine_avx512_taps<T, NE, NO>;
+            default:
+                return refine_scalar_taps<T, NE, NO>;
+        }
+    }
+    else
+    {
+        return refine_scalar_taps<T, NE, NO>;
+    }
+}
+
+#else /* x86 */
+
+template <typename T, int L>
+static constexpr basic_refine_kernel<T> fixed_kernel(isa_t isa)
+{
+    return refine_scalar_taps<T, (L == 0) ? -1 : (L + 1) / 2, (L == 0) ? -1 : L / 2>;
+}
+
+#endif /* x86 */
+
+
+/*
+ * dispatch table, one row per instruction set and one column per mask length
+ */
+template <typename T, size_t... L>
+static constexpr array<basic_refine_kernel<T>, sizeof...(L)> kernel_row(isa_t isa, index_sequence<L...>)
+{
+    return {{ fixed_kernel<T, (int) L>(isa)... }};
+}
+
+template <typename T>
+static constexpr array<basic_refine_kernel<T>, max_fixed_length + 1> kernel_table[] = {
+    kernel_row<T>(isa_scalar, make_index_sequence<max_fixed_length + 1>()),
+    kernel_row<T>(isa_sse2,   make_index_sequence<max_fixed_length + 1>()),
+    kernel_row<T>(isa_avx2,   make_index_sequence<max_fixed_length + 1>()),
+    kernel_row<T>(isa_avx512, make_index_sequence<max_fixed_length + 1>())
+};
+
+
+template <typename T>
+basic_refine_kernel<T> unrolled_kernel(isa_t isa, int length)
+{
+    if (length < 0 || length > max_fixed_length) { length = 0; }
+
+    return kernel_table<T>[isa][length];
+}
+
+template basic_refine_kernel<float> unrolled_kernel<float>(isa_t isa, int length);
+template basic_refine_kernel<double> unrolled_kernel<double>(isa_t isa, int length);
+template basic_refine_kernel<long double> unrolled_kernel<long double>(isa_t isa, int length);
+template basic_refine_kernel<dd_real> unrolled_kernel<dd_real>(isa_t isa, int length);
@@ -0,0 +1,663 @@
+/*
+ * lattice_cascade.cpp
+ * Subdivision for bivariate refinable functions with general dilation matrices.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstring>
+#include <math.h>
+#include <algorithm>
+#include <new>
+#include "lattice_cascade.h"
+#include "kernels.h"
+#include "tensor_cascade.h"
+
+using namespace std;
+
+/* fine columns of a tile, the sums of all cosets of a tile stay in the first level cache */
+static const size_t tile_columns = 512;
+
+/* values of a strip of the last level, 2 MB fit into the second level cache of most cpus */
+static const size_t strip_values = (size_t) 1 << 18;
+
+/* smaller levels are not worth waking up the threads */
+static const size_t min_rows_per_thread = 16;
+
+
+
+lattice_mask_t box_spline_mask(const vector<int>& directions, const string& name)
+{
+    lattice_mask_t mask = {{{2, 0}, {0, 2}}, {0, 0}, {1, 1}, {4.0}, name};
+
+    /* multiply by (1 + z^xi) / 2 for every direction xi */
+    for (size_t i = 0; i + 1 < directions.size(); i += 2)
+    {
+        const int xi[2] = {directions[i], directions[i+1]};
+        const int first[2] = {mask.first[0] + min(xi[0], 0), mask.first[1] + min(xi[1], 0)};
+        const int size[2] = {mask.size[0] + abs(xi[0]), mask.size[1] + abs(xi[1])};
+
+        vector<double> product((size_t) size[0] * size[1], 0.0);
+        for (int k1 = 0; k1 < mask.size[1]; k1++)
+        {
+            for (int k0 = 0; k0 < mask.size[0]; k0++)
+            {
+                const double half = mask.coefficient[(size_t) k1 * mask.size[0] + k0] / 2.0;
+                const int l0 = k0 + mask.first[0] - first[0], l1 = k1 + mask.first[1] - first[1];
+                product[(size_t) l1 * size[0] + l0] += half;
+                product[(size_t) (l1 + xi[1]) * size[0] + l0 + xi[0]] += half;
+            }
+        }
+
+        mask.first[0] = first[0];
+        mask.first[1] = first[1];
+        mask.size[0] = size[0];
+        mask.size[1] = size[1];
+        mask.coefficient.swap(product);
+    }
+
+    return mask;
+}
+
+
+lattice_mask_t tensor_lattice_mask(const mask_t& a, const mask_t& b)
+{
+    lattice_mask_t mask = {{{2, 0}, {0, 2}}, {0, 0}, {a.length, b.length}, {}, a.name + "x" + b.name};
+    mask.coefficient.resize((size_t) a.length * b.length);
+    for (int k1 = 0; k1 < b.length; k1++)
+    {
+        for (int k0 = 0; k0 < a.length; k0++)
+        {
+            mask.coefficient[(size_t) k1 * a.length + k0] = a.entry[k0] * b.entry[k1];
+        }
+    }
+
+    return mask;
+}
+
+
+/*
+ * builtin masks, built at the first call
+ */
+static const vector<lattice_mask_t>& lattice_masks()
+{
+    static const vector<lattice_mask_t> masks = {
+        box_spline_mask({1, 0, 1, 0, 0, 1, 0, 1}, "bilinear"),
+        box_spline_mask({1, 0, 0, 1, 1, 1}, "Courant"),
+        box_spline_mask({1, 0, 0, 1, 1, 1, 1, -1}, "Zwart_Powell"),
+        box_spline_mask({1, 0, 1, 0, 0, 1, 0, 1, 1, 1, 1, 1}, "Loop"),
+        /* M is the rotation by 45 degrees times sqrt 2, digits 0 and e1 */
+        {{{1, -1}, {1, 1}}, {0, 0}, {2, 1}, {1.0, 1.0}, "twin_dragon"},
+        /* interpolatory, the new points are the means of their four neighbors */
+        {{{1, 1}, {1, -1}}, {-1, -1}, {3, 3}, {0.0, 1.0/4.0, 0.0, 1.0/4.0, 1.0, 1.0/4.0, 0.0, 1.0/4.0, 0.0}, "quincunx"}
+    };
+
+    return masks;
+}
+
+const int lattice_mask_count = 6;
+
+
+const lattice_mask_t* select_lattice_mask(int number)
+{
+    if (number < 1 || number > lattice_mask_count) { return NULL; }
+
+    return &lattice_masks()[number - 1];
+}
+
+
+
+/* r mod d in 0..d-1 for d > 0 */
+static long long positive_mod(long long r, long long d)
+{
+    const long long m = r % d;
+    return (m < 0) ? m + d : m;
+}
+
+
+/* floor(a / b) and ceil(a / b) for b > 0 */
+static long long floor_div(long long a, long long b)
+{
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+static long long ceil_div(long long a, long long b)
+{
+    return -floor_div(-a, b);
+}
+
+
+/*
+ * digit index of the coset of k
+ */
+static int coset_of(const lattice_polyphase_t& P, long long k0, long long k1)
+{
+    const long long d = abs(P.determinant);
+    const long long u0 = positive_mod(P.adjugate[0][0] * k0 + P.adjugate[0][1] * k1, d);
+    const long long u1 = positive_mod(P.adjugate[1][0] * k0 + P.adjugate[1][1] * k1, d);
+
+    return P.coset[u0 * d + u1];
+}
+
+
+bool lattice_polyphase(const lattice_mask_t& mask, lattice_polyphase_t& P)
+{
+    const int (&M)[2][2] = mask.dilation;
+    const int det = M[0][0] * M[1][1] - M[0][1] * M[1][0];
+    const int d = abs(det);
+    if (d < 2) { return false; }
+
+    /* expanding: both eigenvalues outside the unit circle */
+    const double trace = M[0][0] + M[1][1];
+    const double discriminant = trace * trace - 4.0 * det;
+    if (discriminant >= 0.0 && min(fabs(trace - sqrt(discriminant)), fabs(trace + sqrt(discriminant))) <= 2.0)
+    {
+        return false;
+    }
+
+    memcpy(P.dilation, M, sizeof(P.dilation));
+    P.adjugate[0][0] = M[1][1];
+    P.adjugate[0][1] = -M[0][1];
+    P.adjugate[1][0] = -M[1][0];
+    P.adjugate[1][1] = M[0][0];
+    P.determinant = det;
+
+    /* one digit per coset from [0, d)^2, d e_i lies in M Z^2 */
+    P.coset.assign((size_t) d * d, -1);
+    P.digit.clear();
+    for (int k1 = 0; k1 < d; k1++)
+    {
+        for (int k0 = 0; k0 < d; k0++)
+        {
+            const long long key = positive_mod(P.adjugate[0][0] * k0 + P.adjugate[0][1] * k1, d) * d
+                                  + positive_mod(P.adjugate[1][0] * k0 + P.adjugate[1][1] * k1, d);
+            if (P.coset[key] < 0)
+            {
+                P.coset[key] = (int) P.digit.size() / 2;
+                P.digit.push_back(k0);
+                P.digit.push_back(k1);
+            }
+        }
+    }
+
+    P.period = 1;
+    while (coset_of(P, P.period, 0) != coset_of(P, 0, 0)) { P.period++; }
+    P.coarse_step[0] = P.adjugate[0][0] * P.period / det;
+    P.coarse_step[1] = P.adjugate[1][0] * P.period / det;
+
+    /* t = M^-1 (k - e) of every nonzero coefficient */
+    P.taps.assign(d, vector<lattice_tap_t>());
+    for (int k1 = 0; k1 < mask.size[1]; k1++)
+    {
+        for (int k0 = 0; k0 < mask.size[0]; k0++)
+        {
+            const double value = mask.coefficient[(size_t) k1 * mask.size[0] + k0];
+            if (value == 0.0) { continue; }
+
+            const int l0 = k0 + mask.first[0], l1 = k1 + mask.first[1];
+            const int e = coset_of(P, l0, l1);
+            const int r0 = l0 - P.digit[2*e], r1 = l1 - P.digit[2*e+1];
+            const lattice_tap_t tap = {{(P.adjugate[0][0] * r0 + P.adjugate[0][1] * r1) / det,
+                                        (P.adjugate[1][0] * r0 + P.adjugate[1][1] * r1) / det}, value};
+            P.taps[e].push_back(tap);
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * box of M B + supp a
+ */
+static lattice_box_t refined_box(const lattice_polyphase_t& P, const lattice_mask_t& mask, const lattice_box_t& B)
+{
+    long long lo[2] = {0, 0}, hi[2] = {0, 0};
+    for (int corner = 0; corner < 4; corner++)
+    {
+        const long long c0 = B.first[0] + ((corner & 1) ? (long long) B.columns - 1 : 0);
+        const long long c1 = B.first[1] + ((corner & 2) ? (long long) B.rows - 1 : 0);
+        for (int i = 0; i < 2; i++)
+        {
+            const long long x = P.dilation[i][0] * c0 + P.dilation[i][1] * c1;
+            lo[i] = (corner == 0) ? x : min(lo[i], x);
+            hi[i] = (corner == 0) ? x : max(hi[i], x);
+        }
+    }
+
+    lattice_box_t fine;
+    for (int i = 0; i < 2; i++)
+    {
+        fine.first[i] = lo[i] + mask.first[i];
+        hi[i] += mask.first[i] + mask.size[i] - 1;
+    }
+    fine.columns = (size_t) (hi[0] - fine.first[0] + 1);
+    fine.rows = (size_t) (hi[1] - fine.first[1] + 1);
+
+    return fine;
+}
+
+
+/*
+ * narrows [lo, hi) to the s with 0 <= b + s step < size
+ */
+static void clip(long long b, long long step, long long size, long long& lo, long long& hi)
+{
+    if (step == 0)
+    {
+        if (b < 0 || b >= size) { hi = lo; }
+        return;
+    }
+
+    const long long first = (step > 0) ? ceil_div(-b, step) : ceil_div(b - size + 1, -step);
+    const long long last = (step > 0) ? floor_div(size - 1 - b, step) : floor_div(b, -step);
+    lo = max(lo, first);
+    hi = min(hi, last + 1);
+}
+
+
+/*
+ * fine rows [begin, end) of the box fine_box into out: every tile of
+ * columns coset by coset, the points of a coset are p columns apart and
+ * their sums are accumulated contiguously tap by tap
+ */
+static void refine_lattice_rows(const lattice_polyphase_t& P, const double* coarse, const lattice_box_t& coarse_box,
+                                const lattice_box_t& fine_box, size_t begin, size_t end, double* out)
+{
+    const long long p = P.period;
+    const long long step[2] = {P.coarse_step[0], P.coarse_step[1]};
+    const long long columns = (long long) coarse_box.columns, rows = (long long) coarse_box.rows;
+    const ptrdiff_t stride = (ptrdiff_t) (step[1] * columns + step[0]);
+    AlignedBuffer<double> sum(tile_columns / p + 1);
+
+    for (size_t i = begin; i < end; i++)
+    {
+        const long long k1 = fine_box.first[1] + (long long) i;
+        double* row = out + (i - begin) * fine_box.columns;
+
+        for (size_t c0 = 0; c0 < fine_box.columns; c0 += tile_columns)
+        {
+            const size_t c1 = min(fine_box.columns, c0 + tile_columns);
+            for (long long r = 0; r < p && c0 + r < c1; r++)
+            {
+                const size_t c = c0 + r;
+                const long long count = (long long) (c1 - c + p - 1) / p;
+                const long long k0 = fine_box.first[0] + (long long) c;
+
+                /* k = M n + e */
+                const int e = coset_of(P, k0, k1);
+                const long long r0 = k0 - P.digit[2*e], r1 = k1 - P.digit[2*e+1];
+                const long long n0 = (P.adjugate[0][0] * r0 + P.adjugate[0][1] * r1) / P.determinant;
+                const long long n1 = (P.adjugate[1][0] * r0 + P.adjugate[1][1] * r1) / P.determinant;
+
+                double* s_sum = sum.data();
+                for (long long s = 0; s < count; s++) { s_sum[s] = 0.0; }
+
+                for (const lattice_tap_t& tap : P.taps[e])
+                {
+                    /* coarse sample n - t + s step relative to the coarse box */
+                    const long long b0 = n0 - tap.t[0] - coarse_box.first[0];
+                    const long long b1 = n1 - tap.t[1] - coarse_box.first[1];
+                    long long lo = 0, hi = count;
+                    clip(b0, step[0], columns, lo, hi);
+                    clip(b1, step[1], rows, lo, hi);
+                    if (lo >= hi) { continue; }
+
+                    const double value = tap.value;
+                    const double* in = coarse + (b1 + lo * step[1]) * columns + (b0 + lo * step[0]);
+                    double* acc = s_sum + lo;
+                    const long long n = hi - lo;
+                    if (stride == 1)
+                    {
+                        for (long long s = 0; s < n; s++) { acc[s] += value * in[s]; }
+                    }
+                    else
+                    {
+                        for (long long s = 0; s < n; s++) { acc[s] += value * in[s * stride]; }
+                    }
+                }
+
+                for (long long s = 0; s < count; s++) { row[c + s * p] = s_sum[s]; }
+            }
+        }
+    }
+}
+
+
+
+LatticeSubdivision::LatticeSubdivision(const lattice_mask_t& mask)
+    : refinement(mask), levels(-1), threads(NULL)
+{
+    supported = lattice_polyphase(refinement, polyphase);
+    previous = {{0, 0}, 0, 0};
+    last = previous;
+}
+
+
+bool LatticeSubdivision::run(int depth)
+{
+    levels = -1;
+    if (!supported || depth < 0 || depth > max_depth) { return false; }
+
+    try
+    {
+        /* level 0 is the delta sequence */
+        previous = {{0, 0}, 1, 1};
+        values.resize(1);
+        values[0] = 1.0;
+
+        for (int j = 1; j < depth; j++)
+        {
+            const lattice_box_t box = refined_box(polyphase, refinement, previous);
+            AlignedBuffer<double> level(box.columns * box.rows);
+
+            if (threads == NULL)
+            {
+                refine_lattice_rows(polyphase, values.data(), previous, box, 0, box.rows, level.data());
+            }
+            else
+            {
+                threads->parallel_for(0, box.rows, 1, min_rows_per_thread, [&] (size_t begin, size_t end) {
+                    refine_lattice_rows(polyphase, values.data(), previous, box, begin, end,
+                                        level.data() + begin * box.columns);
+                });
+            }
+
+            /* cut to the nonzero samples, rotating dilations would grow the box faster than the support */
+            size_t top = box.rows, bottom = 0, left = box.columns, right = 0;
+            for (size_t i = 0; i < box.rows; i++)
+            {
+                const double* row = level.data() + i * box.columns;
+                for (size_t c = 0; c < box.columns; c++)
+                {
+                    if (row[c] == 0.0) { continue; }
+                    top = min(top, i);
+                    bottom = i + 1;
+                    left = min(left, c);
+                    break;
+                }
+                for (size_t c = box.columns; c > left && bottom == i + 1; c--)
+                {
+                    if (row[c-1] != 0.0)
+                    {
+                        right = max(right, c);
+                        break;
+                    }
+                }
+            }
+            if (top >= bottom) { top = 0; bottom = 1; left = 0; right = 1; }
+
+            previous.first[0] = box.first[0] + (long long) left;
+            previous.first[1] = box.first[1] + (long long) top;
+            previous.columns = right - left;
+            previous.rows = bottom - top;
+            for (size_t i = 0; i < previous.rows; i++)
+            {
+                memmove(level.data() + i * previous.columns, level.data() + (top + i) * box.columns + left,
+                        previous.columns * sizeof(double));
+            }
+            values = move(level);
+        }
+    }
+    catch (const bad_alloc&)
+    {
+        values.resize(0);
+        return false;
+    }
+
+    last = (depth == 0) ? previous : refined_box(polyphase, refinement, previous);
+    levels = depth;
+
+    return true;
+}
+
+
+bool LatticeSubdivision::stream(const strip_consumer_t& consumer) const
+{
+    if (levels < 0) { return false; }
+    if (levels == 0) { return consumer(0, values.data(), 1); }
+
+    const size_t strip = max((size_t) 1, min(last.rows, strip_values / last.columns));
+    const size_t parallel = (threads == NULL) ? 1 : (size_t) threads->size();
+
+    AlignedBuffer<double> buffer;
+    try
+    {
+        buffer.resize(parallel * strip * last.columns);
+    }
+    catch (const bad_alloc&)
+    {
+        return false;
+    }
+
+    for (size_t first = 0; first < last.rows; first += parallel * strip)
+    {
+        /* up to one strip per thread */
+        const size_t strips = min(parallel, (last.rows - first + strip - 1) / strip);
+        const auto compute = [&] (size_t s) {
+            const size_t begin = first + s * strip;
+            refine_lattice_rows(polyphase, values.data(), previous, last, begin, min(last.rows, begin + strip),
+                                buffer.data() + s * strip * last.columns);
+        };
+
+        if (strips > 1) { threads->run(strips, compute); }
+        else { compute(0); }
+
+        for (size_t s = 0; s < strips; s++)
+        {
+            const size_t begin = first + s * strip;
+            if (!consumer(begin, buffer.data() + s * strip * last.columns, min(strip, last.rows - begin)))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+bool LatticeSubdivision::write(const char* filename, output_format_t format, double& min_value, double& max_value) const
+{
+    if (levels < 0) { return false; }
+
+    BufferedWriter ofs;
+    if (!ofs.open(filename)) { return false; }
+
+    const int (&M)[2][2] = refinement.dilation;
+    if (format == format_npy) { write_npy_header(ofs, vector<size_t>{last.rows, last.columns}); }
+    if (format == format_matlab)
+    {
+        ofs << "[K0, K1] = meshgrid(" << (long) last.first[0] << ":" << (long) (last.first[0] + (long long) last.columns - 1)
+            << ", " << (long) last.first[1] << ":" << (long) (last.first[1] + (long long) last.rows - 1) << ");\n"
+            << "T = inv([" << M[0][0] << " " << M[0][1] << "; " << M[1][0] << " " << M[1][1] << "])^" << levels << ";\n"
+            << "X = T(1,1) * K0 + T(1,2) * K1;\nY = T(2,1) * K0 + T(2,2) * K1;\n\nZ = [";
+    }
+
+    min_value = HUGE_VAL;
+    max_value = -HUGE_VAL;
+
+    const size_t columns = last.columns, rows = last.rows;
+    const bool streamed = stream([&] (size_t first, const double* values, size_t count) {
+        for (size_t k = 0; k < count * columns; k++)
+        {
+            min_value = min(min_value, values[k]);
+            max_value = max(max_value, values[k]);
+        }
+
+        if (format == format_matlab)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                for (size_t j = 0; j < columns; j++) { ofs << values[i * columns + j] << " "; }
+                ofs << ((first + i + 1 < rows) ? ";\n" : "");
+            }
+        }
+        else
+        {
+            ofs.write_values(values, count * columns, format);
+        }
+
+        return !ofs.failed();
+    });
+
+    if (format == format_matlab)
+    {
+        ofs << "];\n\nfigure;\nsurf(X, Y, Z, 'EdgeColor', 'none');\n"
+            << "axis tight;\nset(gca, 'FontSize', 20);\n"
+            << "title('" << refinement.name << "');\n";
+    }
+
+    return ofs.close() && streamed;
+}
+
+
+
+/*
+ * the last level of S as array over its box
+ */
+static bool collect(const LatticeSubdivision& S, vector<double>& level)
+{
+    level.clear();
+    return S.stream([&] (size_t, const double* values, size_t count) {
+        level.insert(level.end(), values, values + count * S.box().columns);
+        return true;
+    });
+}
+
+
+/*
+ * Courant element, the piecewise linear hat of the three direction mesh
+ * with the peak at (1, 1)
+ */
+static double courant(double x, double y)
+{
+    const double u = x - 1.0, v = y - 1.0;
+    const double distance = (u * v >= 0.0) ? max(fabs(u), fabs(v)) : fabs(u) + fabs(v);
+
+    return max(0.0, 1.0 - distance);
+}
+
+
+bool verify_lattice(ostream* log)
+{
+    bool valid = true;
+    double max_error = 0.0;
+    int cascades = 0;
+    ThreadPool pool(2);
+
+    /* tensor products against refine_tensor() from the delta sequence */
+    const int numbers[] = {2, 7, 9};
+    const int steps = 4;
+    for (int p : numbers)
+    {
+        for (int q : numbers)
+        {
+            const mask_t& a = *select_mask(p);
+            const mask_t& b = *select_mask(q);
+            const polyphase_t pa = polyphase(a), pb = polyphase(b);
+
+            size_t rows = b.length, columns = a.length;
+            vector<double> level(rows * columns, 0.0);
+            level[0] = 1.0;
+            for (int j = 1; j <= steps; j++)
+            {
+                vector<double> fine((2*rows - 1) * (2*columns - 1));
+                valid = valid && refine_tensor(pa, pb, level.data(), rows, columns, fine.data(), NULL);
+                level.swap(fine);
+                rows = 2*rows - 1;
+                columns = 2*columns - 1;
+            }
+
+            LatticeSubdivision S(tensor_lattice_mask(a, b));
+            vector<double> lattice;
+            valid = valid && S.run(steps) && collect(S, lattice);
+
+            /* the box of S may be larger, the grid of refine_tensor() starts at k = 0 */
+            const lattice_box_t& box = S.box();
+            double error = 0.0;
+            for (size_t i = 0; i < box.rows; i++)
+            {
+                for (size_t c = 0; c < box.columns; c++)
+                {
+                    const long long k0 = box.first[0] + (long long) c, k1 = box.first[1] + (long long) i;
+                    const bool inside = k0 >= 0 && k1 >= 0 && k0 < (long long) columns && k1 < (long long) rows;
+                    const double expected = inside ? level[k1 * columns + k0] : 0.0;
+                    error = max(error, fabs(lattice[i * box.columns + c] - expected));
+                }
+            }
+            max_error = max(max_error, error);
+            valid = valid && error <= 1e-14;
+            cascades++;
+        }
+    }
+
+    /* Courant element, the cascade of the hat is interpolatory: S_j[k] = B(2^-j (k + (1, 1))) */
+    {
+        const int J = 6;
+        LatticeSubdivision S(*select_lattice_mask(2));
+        vector<double> level;
+        valid = valid && S.run(J) && collect(S, level);
+        double error = 0.0;
+        for (size_t i = 0; i < S.box().rows; i++)
+        {
+            for (size_t c = 0; c < S.box().columns; c++)
+            {
+                const double x = ldexp((double) (S.box().first[0] + (long long) c + 1), -J);
+                const double y = ldexp((double) (S.box().first[1] + (long long) i + 1), -J);
+                error = max(error, fabs(level[i * S.box().columns + c] - courant(x, y)));
+            }
+        }
+        max_error = max(max_error, error);
+        valid = valid && error <= 1e-15;
+        cascades++;
+    }
+
+    /* twin dragon, S_j is the characteristic function of D + M D + ... + M^(j-1) D */
+    {
+        const int J = 16;
+        LatticeSubdivision S(*select_lattice_mask(5));
+        vector<double> level;
+        valid = valid && S.run(J) && collect(S, level);
+        size_t ones = 0;
+        for (double value : level)
+        {
+            valid = valid && (value == 0.0 || value == 1.0);
+            ones += (value == 1.0);
+        }
+        valid = valid && ones == ((size_t) 1 << J);
+        cascades++;
+    }
+
+    /* sums |det M|^j of all levels, and threaded levels bit for bit */
+    for (int number = 1; number <= lattice_mask_count; number++)
+    {
+        const lattice_mask_t& mask = *select_lattice_mask(number);
+        const int J = 8;
+        LatticeSubdivision S(mask), threaded(mask);
+        threaded.set_thread_pool(&pool);
+
+        vector<double> level, threaded_level;
+        valid = valid && S.run(J) && threaded.run(J) && collect(S, level) && collect(threaded, threaded_level);
+        valid = valid && level == threaded_level;
+
+        const int det = abs(mask.dilation[0][0] * mask.dilation[1][1] - mask.dilation[0][1] * mask.dilation[1][0]);
+        double sum = 0.0;
+        for (double value : level) { sum += value; }
+        const double expected = pow((double) det, J);
+        max_error = max(max_error, fabs(sum - expected) / expected);
+        valid = valid && fabs(sum - expected) <= 1e-12 * expected;
+        cascades++;
+    }
+
+    if (log != NULL)
+    {
+        *log << "Lattice cascades: " << cascades << " checks, error " << max_error << (valid ? "" : "  FAILED") << "\n";
+    }
+
+    return valid;
+}
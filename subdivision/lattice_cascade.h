@@ -0,0 +1,190 @@
+/*
+ * lattice_cascade.h
+ * Subdivision for bivariate refinable functions with general dilation matrices.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_LATTICE_CASCADE_H
+#define SUBDIVISION_LATTICE_CASCADE_H
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "masks.h"
+#include "../common/aligned_buffer.h"
+#include "../common/thread_pool.h"
+#include "../common/output_writer.h"
+#include "../common/tensor_grid.h"
+
+
+/*
+ * data structure for bivariate refinable mask with dilation matrix M,
+ *   phi(x) = sum_k a[k] phi(M x - k),  sum_k a[k] = |det M|
+ */
+typedef struct {
+    int dilation[2][2];               /* M, integer and expanding */
+    int first[2];                     /* index k of coefficient[0] */
+    int size[2];                      /* extent of the mask along k0 and k1 */
+    std::vector<double> coefficient;  /* a[k] at [(k1 - first[1]) * size[0] + k0 - first[0]] */
+    std::string name;
+}lattice_mask_t;
+
+
+/*
+ * implemented bivariate refinable functions, numbered 1..lattice_mask_count:
+ * the box splines bilinear, Courant, Zwart-Powell and Loop with M = 2I,
+ * the twin dragon tile and the quincunx scheme with |det M| = 2
+ */
+extern const int lattice_mask_count;
+
+/*
+ * @param number mask number {1, 2, ...}
+ * @return mask or NULL if no mask is implemented for this number
+ */
+const lattice_mask_t* select_lattice_mask(int number);
+
+/*
+ * Box spline mask for M = 2I, a(z) = 4 prod_i (1 + z^xi_i) / 2.
+ * @param directions direction vectors xi_i, two integers each
+ * @param name name of the mask
+ */
+lattice_mask_t box_spline_mask(const std::vector<int>& directions, const std::string& name);
+
+/*
+ * tensor product mask a[k0] b[k1] for M = 2I of phi_a(x) phi_b(y)
+ */
+lattice_mask_t tensor_lattice_mask(const mask_t& a, const mask_t& b);
+
+
+/*
+ * rectangle of lattice points k, first[0] <= k0 < first[0] + columns and
+ * first[1] <= k1 < first[1] + rows, row major along k0
+ */
+typedef struct {
+    long long first[2];
+    size_t columns;
+    size_t rows;
+}lattice_box_t;
+
+/*
+ * nonzero tap a[M t + e] of the coset of the digit e
+ */
+typedef struct {
+    int t[2];
+    double value;
+}lattice_tap_t;
+
+/*
+ * Coset form of a mask: with the digits e, one per coset of Z^2 / M Z^2,
+ *   S[M n + e] = sum_t a[M t + e] S'[n - t],
+ * so every fine point is one sparse convolution of the coarse level. Along
+ * a row of fine points the cosets repeat with period p, and p steps along
+ * the row are the step M^-1 (p, 0) on the coarse level.
+ */
+typedef struct {
+    int dilation[2][2];
+    int adjugate[2][2];                       /* det M * M^-1 */
+    int determinant;
+    int period;                               /* p */
+    int coarse_step[2];                       /* M^-1 (p, 0) */
+    std::vector<int> coset;                   /* digit index of the key (adj k mod |det|) */
+    std::vector<int> digit;                   /* e, two integers per coset */
+    std::vector<std::vector<lattice_tap_t> > taps;
+}lattice_polyphase_t;
+
+/*
+ * @param mask bivariate mask
+ * @param polyphase coset form of mask
+ * @return false if M is singular or |det M| < 2
+ */
+bool lattice_polyphase(const lattice_mask_t& mask, lattice_polyphase_t& polyphase);
+
+
+/*
+ * Levels of the bivariate cascade from the delta sequence
+ *   S_{j+1}[k] = sum_m a[k - M m] S_j[m],
+ * sample k of level j approximates phi(M^-j k). All levels but the last
+ * are computed into memory, each one cut to the box of its nonzero
+ * samples; the last level is produced strip by strip of rows and never
+ * held as a whole, so the memory is the previous level, 1 / |det M| of
+ * the last one, plus one strip per thread. Rows are computed in tiles of
+ * columns, every coset of a tile as one sparse convolution along the
+ * coarse step, contiguous for M = 2I. Every sample is computed by the
+ * same operations in the same order, so the result does not depend on
+ * the tiling or on the number of threads.
+ */
+class LatticeSubdivision
+{
+public:
+    /*
+     * @param mask bivariate mask, copied
+     */
+    explicit LatticeSubdivision(const lattice_mask_t& mask);
+
+    /* false if the dilation matrix is not supported */
+    bool valid() const { return supported; }
+
+    /*
+     * @param pool threads used by run() and stream(), NULL (default) computes serially
+     */
+    void set_thread_pool(ThreadPool* pool) { threads = pool; }
+
+    /*
+     * computes the levels up to depth - 1 and the box of level depth
+     * @param depth number of subdivision steps, 0..max_depth
+     * @return false if depth is out of range or memory is exhausted
+     */
+    bool run(int depth);
+
+    int depth() const { return levels; }
+
+    /* box of the last level, it contains every nonzero sample */
+    const lattice_box_t& box() const { return last; }
+
+    /*
+     * the last level row by row of the box
+     * @return false if memory is exhausted or the consumer stopped
+     */
+    bool stream(const strip_consumer_t& consumer) const;
+
+    /*
+     * The last level as file: format_matlab writes the matrix Z over the
+     * lattice points X, Y = M^-depth k and a surface plot, the binary
+     * formats write Z row by row of the box (NumPy with the shape rows x
+     * columns).
+     * @return false if the file cannot be written or memory is exhausted
+     */
+    bool write(const char* filename, output_format_t format, double& min_value, double& max_value) const;
+
+    const lattice_mask_t& mask() const { return refinement; }
+
+    static const int max_depth = 30;
+
+private:
+    lattice_mask_t refinement;
+    lattice_polyphase_t polyphase;
+    bool supported;
+    int levels;
+    lattice_box_t previous;         /* box of level depth - 1 */
+    AlignedBuffer<double> values;   /* level depth - 1 */
+    lattice_box_t last;
+    ThreadPool* threads;
+};
+
+/*
+ * Checks the lattice cascade: tensor product masks of 2, 7 and 9 against
+ * refine_tensor(), the Courant element against its closed form, the twin
+ * dragon against the characteristic function of its tile, the sums of all
+ * levels, and threaded against serial levels bit for bit.
+ * @param log receives a summary table, may be NULL
+ * @return true if all checks pass
+ */
+bool verify_lattice(std::ostream* log);
+
+#endif /* SUBDIVISION_LATTICE_CASCADE_H */
@@ -0,0 +1,105 @@
+/*
+ * masks.cpp
+ * Refinement masks of the implemented refinable functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include "masks.h"
+#include "kernels.h"
+
+using namespace std;
+
+
+// <editor-fold defaultstate="collapsed" desc="data of implemented refinable functions">
+static constexpr double sqrt3 = 1.7320508075688772; /* sqrt(3.0) rounded to double */
+
+static constexpr fixed_mask_t<2> Haar = {{1.0, 1.0}, "Haar"}; /* Haar */
+
+static constexpr fixed_mask_t<3> N2 = {{1.0/2.0, 1.0, 1.0/2.0}, "N_2"}; /* N_2 */
+
+static constexpr fixed_mask_t<4> N3 = {{1.0/4.0, 3.0/4.0, 3.0/4.0, 1.0/4.0}, "N_3"}; /* N_3 */
+
+static constexpr fixed_mask_t<5> N4 = {{1.0/8.0, 1.0/2.0, 3.0/4.0, 1.0/2.0, 1.0/8.0}, "N_4"}; /* N_4 */
+
+static constexpr fixed_mask_t<6> N5 = {{1.0/16.0, 5.0/16.0, 10.0/16.0, 10.0/16.0, 5.0/16.0, 1.0/16.0}, "N_5"}; /* N_5 */
+
+static constexpr fixed_mask_t<7> N6 = {{1.0/32.0, 6.0/32.0, 15.0/32.0, 20.0/32.0, 15.0/32.0, 6.0/32.0, 1.0/32.0}, "N_6"}; /* N_6 */
+
+static constexpr fixed_mask_t<7> I4 = {{-1.0/16.0, 0.0, 9.0/16.0, 1.0, 9.0/16.0, 0.0, -1.0/16.0}, "I_4"}; /* I_4 */
+
+static constexpr fixed_mask_t<11> I6 = {{3.0/256.0, 0.0, -25.0/256.0, 0.0, 150.0/256.0, 1.0, 150.0/256.0, 0.0, -25.0/256.0, 0.0, 3.0/256.0}, "I_6"}; /* I_6 */
+
+static constexpr fixed_mask_t<4> D2 = {{(1.0+sqrt3)/4.0, (3.0+sqrt3)/4.0, (3.0-sqrt3)/4.0, (1.0-sqrt3)/4.0}, "Daubechies_2"}; /* Daubechies 2 */
+
+static constexpr fixed_mask_t<6> CDF13d = {{-1.0/8.0, 1.0/8.0, 1.0, 1.0, 1.0/8.0, -1.0/8.0}, "CDF_1_3_dual"}; /* CDF (1,3) dual */
+
+static constexpr fixed_mask_t<5> CDF22d = {{-1.0/4.0, 1.0/2.0, 3.0/2.0, 1.0/2.0, -1.0/4.0}, "CDF_2_2_dual"}; /* CDF (2,2) dual */
+
+static constexpr fixed_mask_t<12> CDF35d = {{-5.0/256.0, 15.0/256.0, 19.0/256.0, -97.0/256.0, -26.0/256.0, 350.0/256.0, 350.0/256.0, -26.0/256.0, -97.0/256.0, 19.0/256.0, 15.0/256.0, -5.0/256.0}, "CDF_3_5_dual"}; /* CDF (3,5) dual */
+
+static constexpr fixed_mask_t<15> CDF46d = {{70.0/8192.0, -70.0/2048.0, -110.0/8192.0, 230.0/1024.0, -1114.0/8192.0, -1466.0/2048.0, 5250.0/8192.0, 1050.0/512.0, 5250.0/8192.0, -1466.0/2048.0, -1114.0/8192.0, 230.0/1024.0, -110.0/8192.0, -70.0/2048.0, 70.0/8192.0}, "CDF_4_6_dual"}; /* CDF (4,6) dual */
+// </editor-fold>
+
+const mask_t builtin_masks[] = {
+    runtime_mask(Haar),
+    runtime_mask(N2),
+    runtime_mask(N3),
+    runtime_mask(N4),
+    runtime_mask(N5),
+    runtime_mask(N6),
+    runtime_mask(I4),
+    runtime_mask(I6),
+    runtime_mask(D2),
+    runtime_mask(CDF13d),
+    runtime_mask(CDF22d),
+    runtime_mask(CDF35d),
+    runtime_mask(CDF46d)
+};
+
+const int builtin_mask_count = sizeof(builtin_masks) / sizeof(builtin_masks[0]);
+
+/* every built-in mask has an unrolled kernel in the dispatch table */
+static_assert(CDF46d.length <= max_fixed_length, "longest built-in mask needs an unrolled kernel");
+
+
+const mask_t* select_mask(int number)
+{
+    if (number < 1 || number > builtin_mask_count) { return NULL; }
+
+    return &builtin_masks[number - 1];
+}
+
+
+bool derivative_mask(const mask_t& mask, int r, vector<double>& factored)
+{
+    factored.assign(mask.entry, mask.entry + mask.length);
+    if (r < 0 || r >= mask.length) { return false; }
+
+    double scale = 0.0;
+    for (int m = 0; m < mask.length; m++) { scale += fabs(mask.entry[m]); }
+
+    for (int i = 0; i < r; i++)
+    {
+        /* a(z) = (1 + z) q(z), q_0 = a_0, q_m = a_m - q_{m-1}, the remainder has to vanish */
+        const int M = (int) factored.size() - 1;
+        vector<double> quotient(M);
+        double previous = 0.0;
+        for (int m = 0; m < M; m++)
+        {
+            quotient[m] = factored[m] - previous;
+            previous = quotient[m];
+        }
+        if (fabs(factored[M] - previous) > 1e-12 * scale) { return false; }
+
+        for (int m = 0; m < M; m++) { quotient[m] *= 2.0; }
+        factored.swap(quotient);
+    }
+
+    return true;
+}
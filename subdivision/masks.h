@@ -0,0 +1,79 @@
+/*
+ * masks.h
+ * Refinement masks of the implemented refinable functions.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_MASKS_H
+#define SUBDIVISION_MASKS_H
+
+#include <string>
+#include <vector>
+
+
+/*
+ * data structure for refinable mask
+ */
+typedef struct {
+    const double* entry;
+    int length;
+    std::string name;
+}mask_t;
+
+
+/*
+ * refinable mask with length and coefficients known at compile time,
+ * e.g. constexpr fixed_mask_t<3> N2 = {{1.0/2.0, 1.0, 1.0/2.0}, "N_2"};
+ */
+template <int L>
+struct fixed_mask_t {
+    static const int length = L;
+    double entry[L];
+    const char* name;
+};
+
+/*
+ * @param mask compile time mask
+ * @return runtime view on the coefficients of mask
+ */
+template <int L>
+mask_t runtime_mask(const fixed_mask_t<L>& mask)
+{
+    mask_t view = {mask.entry, L, mask.name};
+    return view;
+}
+
+
+/*
+ * implemented refinable functions, numbered 1..builtin_mask_count in the
+ * order of the selection menu of subdivision.cpp
+ */
+extern const mask_t builtin_masks[];
+extern const int builtin_mask_count;
+
+/*
+ * @param number mask number {1, 2, ...} as shown in the selection menu
+ * @return mask or NULL if no mask is implemented for this number
+ */
+const mask_t* select_mask(int number);
+
+/*
+ * Derivative refinement mask: if a(z) = ((1 + z)/2)^r c(z), then phi is
+ * N_r convolved with the refinable function phi_c of the mask c, and
+ *   phi^(r)(x) = sum_i (-1)^i binom(r, i) phi_c(x - i),
+ * so the derivatives come from the cascade of c = 2^r a(z) / (1 + z)^r.
+ * The sum rule order of a has to be at least r, and phi_c continuous for
+ * point values, which usually limits r to the sum rule order minus 2.
+ * @param mask refinement mask a
+ * @param r derivative order
+ * @param factored length - r coefficients of c, sum 2
+ * @return false if (1 + z)^r does not divide a(z)
+ */
+bool derivative_mask(const mask_t& mask, int r, std::vector<double>& factored);
+
+#endif /* SUBDIVISION_MASKS_H */
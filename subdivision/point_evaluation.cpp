@@ -0,0 +1,398 @@
+/*
+ * point_evaluation.cpp
+ * Exact values of refinable functions at integers and dyadic points.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+#include "point_evaluation.h"
+#include "cascade.h"
+#include "gram.h"
+
+using namespace std;
+
+
+bool solve_linear_system(vector<double>& A, vector<double>& b, int n)
+{
+    for (int col = 0; col < n; col++)
+    {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++)
+        {
+            if (fabs(A[row*n + col]) > fabs(A[pivot*n + col])) { pivot = row; }
+        }
+        if (fabs(A[pivot*n + col]) < 1e-12) { return false; }
+
+        if (pivot != col)
+        {
+            for (int c = 0; c < n; c++) { swap(A[col*n + c], A[pivot*n + c]); }
+            swap(b[col], b[pivot]);
+        }
+
+        for (int row = col + 1; row < n; row++)
+        {
+            const double factor = A[row*n + col] / A[col*n + col];
+            if (factor == 0.0) { continue; }
+            for (int c = col; c < n; c++) { A[row*n + c] -= factor * A[col*n + c]; }
+            b[row] -= factor * b[col];
+        }
+    }
+
+    for (int row = n - 1; row >= 0; row--)
+    {
+        double value = b[row];
+        for (int c = row + 1; c < n; c++) { value -= A[row*n + c] * b[c]; }
+        b[row] = value / A[row*n + row];
+    }
+
+    return true;
+}
+
+
+bool integer_values(const mask_t& mask, vector<double>& values)
+{
+    const int M = mask.length - 1;
+    values.assign(M + 1, 0.0);
+    if (M < 1) { return false; }
+
+    /*
+     * unknowns phi(0), ..., phi(M-1), phi(M) = 0:
+     * rows 0..M-2 of (T - I) phi = 0, the last row is replaced by the
+     * normalization sum phi(n) = 1. Under the sum rules the columns of T
+     * sum to 1, so the dropped row depends on the others.
+     */
+    vector<double> A(M * M, 0.0), b(M, 0.0);
+    for (int n = 0; n < M - 1; n++)
+    {
+        for (int m = 0; m < M; m++)
+        {
+            const int l = 2*n - m;
+            A[n*M + m] = ((0 <= l && l <= M) ? mask.entry[l] : 0.0) - ((n == m) ? 1.0 : 0.0);
+        }
+    }
+    for (int m = 0; m < M; m++) { A[(M-1)*M + m] = 1.0; }
+    b[M-1] = 1.0;
+
+    if (!solve_linear_system(A, b, M)) { return false; }
+    for (int n = 0; n < M; n++) { values[n] = b[n]; }
+
+    /* phi(0) = a[0] phi(0), so phi(0) vanishes unless a[0] = 1 */
+    if (mask.entry[0] != 1.0) { values[0] = 0.0; }
+
+    /* check all eigenvalue equations, including the dropped one */
+    double residual = 0.0;
+    for (int n = 0; n <= M; n++)
+    {
+        double Tv = 0.0;
+        for (int m = 0; m <= M; m++)
+        {
+            const int l = 2*n - m;
+            if (0 <= l && l <= M) { Tv += mask.entry[l] * values[m]; }
+        }
+        residual = max(residual, fabs(Tv - values[n]));
+    }
+
+    return residual < 1e-10;
+}
+
+
+PointEvaluation::PointEvaluation(const mask_t& mask)
+    : PointEvaluation(mask, 0)
+{
+}
+
+
+PointEvaluation::PointEvaluation(const mask_t& mask, int derivative)
+    : derivative_order(derivative)
+{
+    const bool factorized = derivative_mask(mask, derivative, coefficients);
+    const mask_t factored = {coefficients.data(), (int) coefficients.size(), mask.name};
+    M = factored.length - 1;
+    solved = factorized && integer_values(factored, phi);
+
+    /* phi^(r)(n) = sum_i (-1)^i binom(r, i) phi_c(n - i) */
+    integers.assign(M + derivative_order + 1, 0.0);
+    for (int n = 0; solved && n <= M + derivative_order; n++)
+    {
+        double binomial = 1.0;
+        for (int i = 0; i <= derivative_order; i++)
+        {
+            if (0 <= n - i && n - i <= M) { integers[n] += ((i % 2 == 0) ? binomial : -binomial) * phi[n - i]; }
+            binomial = binomial * (derivative_order - i) / (i + 1);
+        }
+    }
+}
+
+
+double PointEvaluation::evaluate(int64_t k, int j, vector<double>& w, vector<double>& next) const
+{
+    if (k < 0 || j < 0 || j > 62 || (k >> j) >= M) { return 0.0; }
+
+    /* w_0[n] = phi(n) */
+    w.assign(phi.begin(), phi.begin() + M);
+
+    const double* a = coefficients.data();
+    for (int i = 1; i <= j; i++)
+    {
+        const int d = (int) ((k >> (i - 1)) & 1); /* digits of k from the least significant one */
+
+        for (int n = 0; n < M; n++)
+        {
+            /* w_i[n] = sum_l a[2n + d - l] w_{i-1}[l] */
+            const int lower = max(0, 2*n + d - M);
+            const int upper = min(M - 1, 2*n + d);
+            double value = 0.0;
+            for (int l = lower; l <= upper; l++)
+            {
+                value += a[2*n + d - l] * w[l];
+            }
+            next[n] = value;
+        }
+        w.swap(next);
+    }
+
+    return w[k >> j];
+}
+
+
+/*
+ * phi^(r)(k / 2^j) = sum_i (-1)^i binom(r, i) phi_c((k - i 2^j) / 2^j)
+ */
+double PointEvaluation::derivative(int64_t k, int j, vector<double>& w, vector<double>& next) const
+{
+    if (derivative_order == 0) { return evaluate(k, j, w, next); }
+    if (j < 0 || j > 62) { return 0.0; }
+
+    double value = 0.0, binomial = 1.0;
+    for (int i = 0; i <= derivative_order; i++)
+    {
+        const double term = evaluate(k - ((int64_t) i << j), j, w, next);
+        value += ((i % 2 == 0) ? binomial : -binomial) * term;
+        binomial = binomial * (derivative_order - i) / (i + 1);
+    }
+
+    return value;
+}
+
+
+double PointEvaluation::operator()(int64_t k, int j) const
+{
+    vector<double> w(M), next(M);
+
+    return derivative(k, j, w, next);
+}
+
+
+void PointEvaluation::evaluate(const int64_t* k, int j, double* values, size_t n) const
+{
+    vector<double> w(M), next(M);
+
+    for (size_t i = 0; i < n; i++)
+    {
+        values[i] = derivative(k[i], j, w, next);
+    }
+}
+
+
+/*
+ * order m if mask is the mask 2^(1-m) binom(m, i) of the B-spline N_m, else 0
+ */
+static int bspline_order(const mask_t& mask)
+{
+    const int m = mask.length - 1;
+    double binomial = 1.0;
+    for (int i = 0; i <= m; i++)
+    {
+        if (fabs(mask.entry[i] - binomial / ldexp(1.0, m - 1)) > 1e-15) { return 0; }
+        binomial = binomial * (m - i) / (i + 1);
+    }
+
+    return m;
+}
+
+/*
+ * cardinal B-spline N_m(x) with support [0, m], right continuous
+ */
+static double bspline(int m, double x)
+{
+    if (m == 1) { return (0.0 <= x && x < 1.0) ? 1.0 : 0.0; }
+
+    return (x * bspline(m - 1, x) + (m - x) * bspline(m - 1, x - 1.0)) / (m - 1);
+}
+
+
+bool verify_point_evaluation(ostream* log)
+{
+    const int levels = 6;
+    bool all_equal = true;
+
+    for (int i = 0; i < builtin_mask_count; i++)
+    {
+        const mask_t& mask = builtin_masks[i];
+        const PointEvaluation phi(mask);
+        if (!phi.valid())
+        {
+            if (log != NULL) { *log << mask.name << ": no point values (eigenvalue 1 not simple)\n"; }
+            continue;
+        }
+
+        /*
+         * reference by the refinement equation on whole levels,
+         * phi(k / 2^j) = sum_m a[m] phi((k - m 2^(j-1)) / 2^(j-1))
+         */
+        const int M = mask.length - 1;
+        const int order = bspline_order(mask);
+        vector<double> level = phi.values_at_integers(), finer;
+        double deviation = 0.0, bspline_deviation = 0.0, scale = 1.0;
+        for (int j = 1; j <= levels; j++)
+        {
+            const int64_t half = (int64_t) 1 << (j - 1);
+            finer.assign(M * (half << 1) + 1, 0.0);
+            for (int64_t k = 0; k < (int64_t) finer.size(); k++)
+            {
+                for (int m = 0; m <= M; m++)
+                {
+                    const int64_t coarse = k - m * half;
+                    if (0 <= coarse && coarse < (int64_t) level.size()) { finer[k] += mask.entry[m] * level[coarse]; }
+                }
+            }
+            level.swap(finer);
+
+            for (int64_t k = 0; k < (int64_t) level.size(); k++)
+            {
+                const double value = phi(k, j);
+                scale = max(scale, fabs(level[k]));
+                deviation = max(deviation, fabs(value - level[k]));
+                if (order > 0)
+                {
+                    bspline_deviation = max(bspline_deviation, fabs(value - bspline(order, ldexp((double) k, -j))));
+                }
+            }
+        }
+
+        const bool equal = deviation <= 1e-12 * scale && bspline_deviation <= 1e-12;
+        all_equal = all_equal && equal;
+
+        if (log != NULL)
+        {
+            *log << mask.name << ": point evaluation up to level " << levels << " "
+                 << (equal ? "agrees with" : "DIFFERS from") << " the refinement equation"
+                 << (order > 0 ? " and the closed form B-spline" : "")
+                 << " (deviation " << max(deviation, bspline_deviation) << ")\n";
+        }
+    }
+
+    return all_equal;
+}
+
+
+
+/*
+ * N_m^(r)(x) = 1/(m-1-r)! sum_i (-1)^i binom(m, i) (x - i)_+^(m-1-r)
+ */
+static double bspline_derivative(int m, int r, double x)
+{
+    double value = 0.0, binomial = 1.0, factorial = 1.0;
+    for (int i = 0; i <= m && i <= x; i++)
+    {
+        value += ((i % 2 == 0) ? binomial : -binomial) * pow(x - i, m - 1 - r);
+        binomial = binomial * (m - i) / (i + 1);
+    }
+    for (int i = 2; i < m - r; i++) { factorial *= i; }
+
+    return (x < m) ? value / factorial : 0.0;
+}
+
+
+bool verify_derivatives(ostream* log)
+{
+    bool all_equal = true;
+    const int depth = 10, j = 6;
+
+    if (log != NULL)
+    {
+        *log << "\nMask         | r | Closed form or differences | Cascade, " << depth << " steps\n"
+             << "-------------------------------------------------------------------\n";
+    }
+    for (int number = 1; number <= builtin_mask_count; number++)
+    {
+        const mask_t& mask = *select_mask(number);
+        const int M = mask.length - 1;
+        const bool bspline = (mask.name.compare(0, 2, "N_") == 0);
+
+        for (int r = 1; r <= min(2, sum_rule_order(mask) - 2); r++)
+        {
+            const PointEvaluation derivative(mask, r), lower(mask, r - 1);
+            Subdivision S(mask, r);
+            if (!derivative.valid() || !S.run(depth))
+            {
+                /* a mask without derivative or point values is reported, a failed cascade fails */
+                const bool failed = derivative.valid();
+                if (log != NULL)
+                {
+                    *log << setw(12) << left << mask.name << right << " | " << r << " | " << setw(26) << "-" << " | "
+                         << (!S.valid() ? "no derivative mask" : !derivative.valid() ? "no point values" : "cascade FAILED")
+                         << "\n";
+                }
+                all_equal = all_equal && !failed;
+                continue;
+            }
+
+            /* the cascade of phi_c converges to the point values if phi_c is continuous */
+            double cascade = 0.0, scale = 0.0;
+            const double* values = S.values();
+            for (int64_t k = 0; k <= ((int64_t) M << j); k++)
+            {
+                const double exact = derivative(k, j);
+                cascade = max(cascade, fabs(values[k << (depth - j)] - exact));
+                scale = max(scale, fabs(exact));
+            }
+
+            if (!bspline && !(cascade <= 0.1 * scale))
+            {
+                if (log != NULL)
+                {
+                    *log << setw(12) << left << mask.name << right << " | " << r << " | " << setw(26) << "-"
+                         << " | no continuous limit\n";
+                }
+                continue;
+            }
+
+            double difference = 0.0;
+            for (int64_t k = 1; k < ((int64_t) M << j); k++)
+            {
+                const double x = ldexp((double) k, -j);
+                double expected;
+                if (bspline)
+                {
+                    expected = bspline_derivative(M, r, x);
+                }
+                else
+                {
+                    /* central difference of phi^(r-1) with h = 2^-20 */
+                    const int64_t n = k << (20 - j);
+                    expected = (lower(n + 1, 20) - lower(n - 1, 20)) * ldexp(1.0, 19);
+                }
+                difference = max(difference, fabs(derivative(k, j) - expected));
+            }
+
+            const double bound = bspline ? 1e-12 * max(1.0, scale) : 1e-4 * max(1.0, scale);
+            if (log != NULL)
+            {
+                *log << setw(12) << left << mask.name << right << " | " << r << " | " << setw(26) << difference
+                     << " | " << cascade << "\n";
+            }
+            all_equal = all_equal && difference <= bound && cascade <= 0.1 * scale;
+        }
+    }
+
+    return all_equal;
+}
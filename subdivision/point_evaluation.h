@@ -0,0 +1,116 @@
+/*
+ * point_evaluation.h
+ * Exact values of refinable functions at integers and dyadic points.
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_POINT_EVALUATION_H
+#define SUBDIVISION_POINT_EVALUATION_H
+
+#include <cstddef>
+#include <ostream>
+#include <stdint.h>
+#include <vector>
+#include "masks.h"
+
+
+/*
+ * Gaussian elimination with partial pivoting
+ * @param A n x n matrix in row major order, overwritten
+ * @param b right hand side, receives the solution
+ * @return false if A is (numerically) singular
+ */
+bool solve_linear_system(std::vector<double>& A, std::vector<double>& b, int n);
+
+/*
+ * Values phi(0), ..., phi(M) of the refinable function of mask at the
+ * integers. They form the eigenvector of the transfer matrix
+ * T[n][m] = a[2n-m] for the eigenvalue 1, normalized to sum 1. phi is
+ * taken right continuous, i.e. phi(M) = 0 at the end of the support.
+ * @param mask refinement mask
+ * @param values phi(0), ..., phi(M)
+ * @return false if the eigenvalue 1 is not simple or the mask violates
+ *         the sum rules, values are undefined then
+ */
+bool integer_values(const mask_t& mask, std::vector<double>& values);
+
+
+/*
+ * Evaluation of phi at single dyadic points x = k / 2^j. With
+ * y_i = (k mod 2^i) / 2^i the vectors w_i[n] = phi(y_i + n), n = 0..M-1,
+ * satisfy w_i[n] = sum_m a[m] w_{i-1}[2n + d_i - m] with the binary digit
+ * d_i of k, starting from the integer values w_0. Following the binary
+ * digits of k costs O(j * M * length) operations per point instead of the
+ * O(M * 2^j * length) of a cascade up to level j.
+ */
+class PointEvaluation
+{
+public:
+    explicit PointEvaluation(const mask_t& mask);
+
+    /*
+     * Values of phi^(r) = sum_i (-1)^i binom(r, i) phi_c(. - i) by the
+     * point evaluation of the derivative mask c of derivative_mask().
+     * @param mask refinement mask
+     * @param derivative order r, 0 gives phi
+     */
+    PointEvaluation(const mask_t& mask, int derivative);
+
+    /* false if the derivative mask or the values at the integers do not exist */
+    bool valid() const { return solved; }
+
+    /* phi^(r)(0), ..., phi^(r)(M) */
+    const std::vector<double>& values_at_integers() const { return integers; }
+
+    /*
+     * @param k numerator
+     * @param j exponent of the denominator, 0 <= j <= 62
+     * @return phi(k / 2^j), or phi^(r)(k / 2^j)
+     */
+    double operator()(int64_t k, int j) const;
+
+    /*
+     * @param k numerators
+     * @param j exponent of the common denominator
+     * @param values phi(k[i] / 2^j), or phi^(r)(k[i] / 2^j)
+     * @param n number of points
+     */
+    void evaluate(const int64_t* k, int j, double* values, size_t n) const;
+
+private:
+    double evaluate(int64_t k, int j, std::vector<double>& w, std::vector<double>& next) const;
+    double derivative(int64_t k, int j, std::vector<double>& w, std::vector<double>& next) const;
+
+    std::vector<double> coefficients; /* mask of phi, or c for derivatives */
+    int derivative_order;
+    int M; /* length of coefficients -1 */
+    std::vector<double> phi;          /* phi_c at the integers */
+    std::vector<double> integers;     /* phi^(r) at the integers */
+    bool solved;
+};
+
+
+/*
+ * Compare PointEvaluation of all built-in masks with the values which the
+ * refinement equation gives on whole dyadic levels, and the B-spline masks
+ * with the closed form N_m, at all points k / 2^j up to level 6.
+ * @param log stream for a report per mask, may be NULL
+ * @return true if all values agree up to rounding
+ */
+bool verify_point_evaluation(std::ostream* log);
+
+/*
+ * Compare the derivatives of the point evaluation with the closed form of
+ * the B-splines and with central differences of the values, and the
+ * levels of the derivative cascade with the point evaluation.
+ * @param log stream for a table of the differences, may be NULL
+ * @return true if all differences are within the expected bounds
+ */
+bool verify_derivatives(std::ostream* log);
+
+#endif /* SUBDIVISION_POINT_EVALUATION_H */
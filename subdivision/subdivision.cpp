@@ -10,311 +10,1071 @@
  */
 
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
-#include <fstream>
+#include <iomanip>
+#include <sstream>
 #include <math.h>
 #include <stdint.h>
+#include <string>
+#include <vector>
+#include "masks.h"
+#include "kernels.h"
+#include "cascade.h"
+#include "point_evaluation.h"
+#include "gram.h"
+#include "tensor_cascade.h"
+#include "lattice_cascade.h"
+#include "../common/batch.h"
+#include "../common/timer.h"
+#include "../common/output_writer.h"
+#include "../common/precision.h"
+#include "../common/table_cache.h"
+#include "../libmiscwavelets/verify_interface.h"
 
 using namespace std;
 
 
 
 /*
- * data structure for refinable mask
+ * @return "_d<r>" for derivatives, empty for r = 0
  */
-typedef struct {
-    const double* entry;
-    int length;
-    string name;
-}mask_t;
+static string derivative_suffix(int derivative)
+{
+    return (derivative > 0) ? "_d" + to_string(derivative) : string();
+}
 
 
+/*
+ * write n samples of any precision as doubles, in chunks
+ */
+template <typename T>
+static void write_samples(BufferedWriter& ofs, const T* values, size_t n, output_format_t format)
+{
+    double chunk[1024];
+    for (size_t k = 0; k < n; k += 1024)
+    {
+        const size_t count = min(n - k, (size_t) 1024);
+        for (size_t i = 0; i < count; i++) { chunk[i] = to_double(values[k + i]); }
+        ofs.write_values(chunk, count, format);
+    }
+}
+
+static void write_samples(BufferedWriter& ofs, const double* values, size_t n, output_format_t format)
+{
+    ofs.write_values(values, n, format);
+}
+
 
 /*
- *
+ * write the levels of S
+ * @param filename output file
+ * @param S subdivision after run()
+ * @param format format_matlab writes a script plotting every level, the
+ *        binary formats write the final level, sample k belongs to
+ *        x = k / 2^depth
+ * @return false if the file cannot be written
  */
-int main(int argc, char** argv)
+template <typename T>
+static bool write_output_file(const char* filename, const BasicSubdivision<T>& S, output_format_t format)
 {
-    cout << "Subdivision to visualize refinable functions." << endl;
+    const mask_t& mask = S.mask();
+    const int M = (mask.length) - 1; /* length of mask -1 */
+    int counter = 0;
+    BufferedWriter ofs;
+    if (!ofs.open(filename)) { return false; }
+
+    if (format != format_matlab)
+    {
+        const size_t samples = S.level_size(S.depth());
+        if (format == format_npy) { write_npy_header(ofs, vector<size_t>(1, samples)); }
+        write_samples(ofs, S.values(), samples, format);
+        return ofs.close();
+    }
+
+    // <editor-fold defaultstate="collapsed" desc="results are written to file">
+
+    /* plot of every step */
+#if 1
+    ofs << "figure;\n";
+
+    for (int step = 0; step < S.depth()+1; step ++)
+    {
+        const double h = pow(2.0, (-1)*step);
+        counter = 0;
+        ofs << "\nX = [";
+        for (double d = 0; d < M; d += h)
+        {
+            ofs << d << " ";
+            counter++;
+        }
+        ofs << "];\nY = [";
+        const T* values = S.level(step);
+        for (int k = 0; k < counter; k++)
+        {
+            ofs << to_double(values[k]) << " ";
+        }
+        ofs << "];\nplot(X,Y);\ntitle('step " << step << "');\npause(0.4);clf;\n";
+        //cout << counter << endl;
+    }
+
+    ofs << "\nplot(X,Y, 'b', 'LineWidth', 2);\n"
+        << "%axis tight;\n%set(gca, 'FontSize', 14);\n"
+        << "title('mask = ";
+    for (int i = 0; i < M; i++)
+    {
+        //ofs << mask[i] << ", ";
+        ofs << *(mask.entry + i) << ", ";
+    }
+    ofs << *(mask.entry + M) //<< mask[M]
+        << "');\n"
+        << "\nset(gca, 'FontSize', 20);\n";
+
+
+    /* plot of result only */
+#else
+    ofs << "X = [";
+    for (double d = 0; d < M; d += pow(2.0, (-1)*S.depth()))
+    {
+        ofs << d << " ";
+        counter++;
+    }
+    ofs << "];\nY = [";
+    const T* values = S.values();
+    for (int k = 0; k < counter; k++)
+    {
+        ofs << to_double(values[k]) << " ";
+    }
+
+
+    ofs << "];\n\nfigure;\nplot(X,Y); % , 'k', 'LineWidth', 2);\n"
+        << "%axis tight;\n%set(gca, 'FontSize', 14);\n"
+        << "title('mask = ";
+    for (int i = 0; i < M; i++)
+    {
+        //ofs << mask[i] << ", ";
+        ofs << *(mask.entry + i) << ", ";
+    }
+    ofs << *(mask.entry + M) //<< mask[M]
+        << "');\n";
+#endif
 
-    /*
-     * data of implemented refinable functions
-     */
-    const int mask_max_length = 20; /* maximal length of mask */
-    mask_t mask, maskHaar, maskN2, maskN3, maskN4, maskN5, maskN6, maskI4, maskI6, maskD2, maskCDF13d, maskCDF22d, maskCDF35d, maskCDF46d;
-
-    // <editor-fold defaultstate="collapsed" desc="data of implemented refinable functions">
-    const double Haar[] = {1.0, 1.0}; /* Haar */
-    maskHaar.entry = Haar;
-    maskHaar.length = 2;
-    maskHaar.name = "Haar";
-
-    const double N2[] = {1.0/2.0, 1.0, 1.0/2.0}; /* N_2 */
-    maskN2.entry = N2;
-    maskN2.length = 3;
-    maskN2.name = "N_2";
-
-    const double N3[] = {1.0/4.0, 3.0/4.0, 3.0/4.0, 1.0/4.0}; /* N_3 */
-    maskN3.entry = N3;
-    maskN3.length = 4;
-    maskN3.name = "N_3";
-
-    const double N4[] = {1.0/8.0, 1.0/2.0, 3.0/4.0, 1.0/2.0, 1.0/8.0}; /* N_4 */
-    maskN4.entry = N4;
-    maskN4.length = 5;
-    maskN4.name = "N_4";
-
-    const double N5[] = {1.0/16.0, 5.0/16.0, 10.0/16.0, 10.0/16.0, 5.0/16.0, 1.0/16.0}; /* N_5 */
-    maskN5.entry = N5;
-    maskN5.length = 6;
-    maskN5.name = "N_5";
-
-    const double N6[] = {1.0/32.0, 6.0/32.0, 15.0/32.0, 20.0/32.0, 15.0/32.0, 6.0/32.0, 1.0/32.0}; /* N_6 */
-    maskN6.entry = N6;
-    maskN6.length = 7;
-    maskN6.name = "N_6";
-
-    const double I4[] = {-1.0/16.0, 0.0, 9.0/16.0, 1.0, 9.0/16.0, 0.0, -1.0/16.0}; /* I_4 */
-    maskI4.entry = I4;
-    maskI4.length = 7;
-    maskI4.name = "I_4";
-
-    const double I6[] = {3.0/256.0, 0.0, -25.0/256.0, 0.0, 150.0/256.0, 1.0, 150.0/256.0, 0.0, -25.0/256.0, 0.0, 3.0/256.0}; /* I_6 */
-    maskI6.entry = I6;
-    maskI6.length = 11;
-    maskI6.name = "I_6";
-
-    const double D2[] = {(1.0+sqrt(3.0))/4.0, (3.0+sqrt(3.0))/4.0, (3.0-sqrt(3.0))/4.0, (1.0-sqrt(3.0))/4.0}; /* Daubechies 2 */
-    maskD2.entry = D2;
-    maskD2.length = 4;
-    maskD2.name = "Daubechies_2";
-
-    const double CDF13d[] = {-1.0/8.0, 1.0/8.0, 1.0, 1.0, 1.0/8.0, -1.0/8.0}; /* CDF (1,3) dual */
-    maskCDF13d.entry = CDF13d;
-    maskCDF13d.length = 6;
-    maskCDF13d.name = "CDF_1_3_dual";
-
-    const double CDF22d[] = {-1.0/4.0, 1.0/2.0, 3.0/2.0, 1.0/2.0, -1.0/4.0}; /* CDF (2,2) dual */
-    maskCDF22d.entry = CDF22d;
-    maskCDF22d.length = 5;
-    maskCDF22d.name = "CDF_2_2_dual";
-
-    const double CDF35d[] = {-5.0/256.0, 15.0/256.0, 19.0/256.0, -97.0/256.0, -26.0/256.0, 350.0/256.0, 350.0/256.0, -26.0/256.0, -97.0/256.0, 19.0/256.0, 15.0/256.0, -5.0/256.0}; /* CDF (3,5) dual */
-    maskCDF35d.entry = CDF35d;
-    maskCDF35d.length = 12;
-    maskCDF35d.name = "CDF_3_5_dual";
-
-    const double CDF46d[] = {70.0/8192.0, -70.0/2048.0, -110.0/8192.0, 230.0/1024.0, -1114.0/8192.0, -1466.0/2048.0, 5250.0/8192.0, 1050.0/512.0, 5250.0/8192.0, -1466.0/2048.0, -1114.0/8192.0, 230.0/1024.0, -110.0/8192.0, -70.0/2048.0, 70.0/8192.0}; /* CDF (4,6) dual */
-    maskCDF46d.entry = CDF46d;
-    maskCDF46d.length = 15;
-    maskCDF46d.name = "CDF_4_6_dual";
     // </editor-fold>
 
-    int selected_mask = 0;
+    return ofs.close();
+}
 
-    cout << "\nNumber | Refinement function" << endl
-         << "----------------------------" << endl
-         << "   1   |  Haar            " << endl
-         << "   2   |  N_2             " << endl
-         << "   3   |  N_3             " << endl
-         << "   4   |  N_4             " << endl
-         << "   5   |  N_5             " << endl
-         << "   6   |  N_6             " << endl
-         << "   7   |  I_4             " << endl
-         << "   8   |  I_6             " << endl
-         << "   9   |  Daubechies 2    " << endl
-         << "  10   |  CDF (1,3) dual  " << endl
-         << "  11   |  CDF (2,2) dual  " << endl
-         << "  12   |  CDF (3,5) dual  " << endl
-         << "  13   |  CDF (4,6) dual  " << endl
-         << "\nSelect mask {1, 2, ...}: ";
-    cin >> selected_mask;
-
-    switch (selected_mask)
-    {
-        // <editor-fold defaultstate="collapsed" desc="switch cases">
-        case 1:
-            mask = maskHaar;
-            break;
-        case 2:
-            mask = maskN2;
-            break;
-        case 3:
-            mask = maskN3;
-            break;
-        case 4:
-            mask = maskN4;
-            break;
-        case 5:
-            mask = maskN5;
-            break;
-        case 6:
-            mask = maskN6;
-            break;
-        case 7:
-            mask = maskI4;
-            break;
-        case 8:
-            mask = maskI6;
-            break;
-        case 9:
-            mask = maskD2;
-            break;
-        case 10:
-            mask = maskCDF13d;
-            break;
-        case 11:
-            mask = maskCDF22d;
-            break;
-        case 12:
-            mask = maskCDF35d;
-            break;
-        case 13:
-            mask = maskCDF46d;
-            break;
-        // </editor-fold>
-
-        default:
-            cout << "\nNo mask implemented for this input.\nProgram end." << endl;
-            return 1;
-            break;
+
+
+/*
+ * check norm of mask: the sum of the mask elements should be equal to 2
+ */
+static bool check_norm(const mask_t& mask)
+{
+    double norm_of_mask = 0.0;
+    for (int i = 0; i < mask.length; i++)
+    {
+        norm_of_mask += *(mask.entry + i);
     }
 
-    cout << "\nOutput:" << endl;
+    return (norm_of_mask == 2.0);
+}
 
-    /* program parameters */
-    const int max_steps = 8; /* maximal subdivision steps, e.g., 8 */
-    const int M = (mask.length) - 1; /* length of mask -1 */
-    //double S[max_steps + 2][(int) (pow(2.0, (max_steps + 1)) * (double) M) + 1] = {0.0};
-    double S[max_steps + 2][(int) (pow(2.0, (max_steps + 1)) * (double) mask_max_length)] = {0.0};
-    int lowerk, upperk, lowerm, upperm;
-    double value;
 
 
-    /* subdivision scheme */
-    S[1][M+1] = 1.0;
+/*
+ * print level sizes, ranges and timing of S, buffered in one write
+ */
+template <typename T>
+static void print_summary(const BasicSubdivision<T>& S, precision_t precision, int threads, double seconds)
+{
+    ostringstream summary;
 
-    for (int j = 1; j <= max_steps; j++) /* subdivision steps */
+    summary << "\nLevel |      Samples |          Min |          Max\n"
+            << "----------------------------------------------------\n";
+    for (int j = 0; j <= S.depth(); j++)
     {
-        lowerk = (-1) * (int) (pow(2.0, (j)) * (double) M);
-        upperk =        (int) (pow(2.0, (j)) * (double) M);
+        summary << setw(5) << j << " | " << setw(12) << S.level_size(j) << " | ";
+
+        const T* values = S.level(j);
+        if (values == NULL)
+        {
+            summary << setw(12) << "-" << " | " << setw(12) << "-" << "\n";
+            continue;
+        }
 
-        for (int k = lowerk; k <= upperk; k++)
+        T min_value = values[0], max_value = values[0];
+        for (size_t k = 1; k < S.level_size(j); k++)
         {
-            value = 0.0;
-            lowerm = (int) max( (-1.0) * pow(2.0, (j-1)) * (double) M, ceil((double) (k-M) / 2.0) );
-            upperm = (int) min( pow(2.0, (j-1)) * (double) M, floor((double) k / 2.0) );
+            min_value = min(min_value, values[k]);
+            max_value = max(max_value, values[k]);
+        }
+        summary << setw(12) << to_double(min_value) << " | " << setw(12) << to_double(max_value) << "\n";
+    }
+
+    summary << "\nSubdivision steps: " << S.depth() << "\n"
+            << "Precision: " << precision_name(precision) << "\n"
+            << "Instruction set: " << isa_name(selected_isa()) << "\n"
+            << "Threads: " << threads << "\n"
+            << "Time: " << seconds << " s\n";
+
+    cout << summary.str();
+}
+
+
+
+/*
+ * print the differences of successive levels and the error estimate of an
+ * adaptive run
+ */
+static void print_convergence(const convergence_t& result, double tolerance)
+{
+    ostringstream report;
+
+    report << "\nLevel |   Difference |         Rate\n"
+           << "-------------------------------------\n";
+    for (int j = 1; j <= result.depth; j++)
+    {
+        report << setw(5) << j << " | " << setw(12) << result.difference[j] << " | ";
+        if (j >= 2 && result.difference[j-1] > 0.0) { report << setw(12) << result.difference[j] / result.difference[j-1]; }
+        else { report << setw(12) << "-"; }
+        report << "\n";
+    }
+
+    report << "\nTolerance: " << tolerance << "\n"
+           << "Reached level: " << result.depth << "\n"
+           << "Estimated error: " << result.error << "\n";
+    if (result.diverged)
+    {
+        report << "Warning: Differences of successive levels do not decay, the cascade does not converge uniformly.\n";
+    }
+    else if (!result.converged)
+    {
+        report << "Warning: Tolerance not reached within the subdivision steps.\n";
+    }
+
+    cout << report.str();
+}
+
+
+
+/*
+ * Batch mode: compute a list of (mask, subdivision steps) jobs without user
+ * input, the jobs are distributed over the threads of a pool.
+ *
+ * Usage: subdivision --batch [--masks 1,2,...] [--steps 8,12,...]
+ *                    [--jobs file] [--threads n] [--dir directory]
+ *                    [--tolerance eps]
+ *
+ * --masks and --steps form all combinations (default: all masks, 8 steps),
+ * each line "mask steps" of a job file adds one job. The output of each
+ * job is written to subdivision_<mask>_<steps>.m (or the extension of the
+ * selected output format), subdivision_<mask>_d<r>_<steps>.m with
+ * --derivative r. With --tolerance the steps are upper limits of
+ * an adaptive run and the file name holds the level reached.
+ */
+static int batch(int argc, char** argv, verbosity_t verbosity, output_format_t format, double tolerance, int derivative)
+{
+    vector<int> masks, steps;
+    vector<job_t> jobs;
+    string dir, error;
+    int threads = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        const string option = argv[i];
+        const char* value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        bool valid = (value != NULL);
 
-            for (int m = lowerm; m <= upperm; m++)
+        if (option == "--masks")        { valid = valid && parse_int_list(value, masks); }
+        else if (option == "--steps")   { valid = valid && parse_int_list(value, steps); }
+        else if (option == "--threads") { valid = valid && (threads = atoi(value)) >= 0; }
+        else if (option == "--dir")     { if (valid) { dir = value; } }
+        else if (option == "--jobs")
+        {
+            if (valid && !read_job_file(value, 2, 2, jobs, error))
             {
-                //value += mask[k - 2*m] * S[j][m + (int) pow(2.0, (j-1)) * M + 1];
-                value += *(mask.entry + (k - 2*m)) * S[j][m + (int) pow(2.0, (j-1)) * M + 1];
+                cout << "\n" << error << ".\nProgram end." << endl;
+                return 1;
             }
+        }
+        else { valid = false; }
 
-            S[j+1][k + (int) (pow(2.0, j) * (double) M) + 1] =  value;
-
-            cout << "(" << j << ", " << k << "): value = " << value << endl;
+        if (!valid)
+        {
+            cout << "\nInvalid batch option '" << option << "'.\nProgram end." << endl;
+            return 1;
         }
+        i++;
     }
 
+    if (jobs.empty() || !masks.empty() || !steps.empty())
+    {
+        if (masks.empty()) { for (int m = 1; m <= builtin_mask_count; m++) { masks.push_back(m); } }
+        if (steps.empty()) { steps.push_back(8); }
 
-    /* setup output file */
-    char filename[250];
-    const char *cstr = mask.name.c_str();
-    sprintf(filename, "subdivision_%s.m", cstr); //, max_steps);
-    ofstream ofs;
+        for (size_t m = 0; m < masks.size(); m++)
+        {
+            for (size_t j = 0; j < steps.size(); j++)
+            {
+                jobs.push_back(job_t{masks[m], steps[j]});
+            }
+        }
+    }
 
-    /* ask user if output should be written to file */
-    char answer;
-    int counter = 0;
-    cout << "\nWrite output to file '" << filename << "' [y,N]? ";
-    cin >> answer;
-    if (answer == 'y' || answer == 'Y' )
+    /* validate all jobs before starting */
+    for (size_t i = 0; i < jobs.size(); i++)
     {
-        ofs.open(filename);
+        if (select_mask(jobs[i][0]) == NULL)
+        {
+            cout << "\nNo mask implemented for " << jobs[i][0] << ".\nProgram end." << endl;
+            return 1;
+        }
+        if (!Subdivision(*select_mask(jobs[i][0]), derivative).valid())
+        {
+            cout << "\nMask " << select_mask(jobs[i][0])->name << " has no derivative mask of order " << derivative << ".\nProgram end." << endl;
+            return 1;
+        }
+        if (jobs[i][1] < 0 || jobs[i][1] > Subdivision::max_depth)
+        {
+            cout << "\nSubdivision steps have to be in {0, ..., " << Subdivision::max_depth << "}.\nProgram end." << endl;
+            return 1;
+        }
+    }
 
-       // <editor-fold defaultstate="collapsed" desc="results are written to file">
+    ThreadPool pool(threads);
+    cout << "\nJobs: " << jobs.size() << "\nThreads: " << pool.size() << endl;
 
-        /* plot of every step */
-#if 1
-        ofs << "figure;" << endl;
+    /* every job is computed serially by one thread, reports are printed in job order */
+    vector<string> report(jobs.size());
+    vector<int> failed(jobs.size(), 0);
+    pool.run(jobs.size(), [&] (size_t i) {
+        const mask_t& mask = *select_mask(jobs[i][0]);
+        Subdivision S(mask, derivative);
+        if (format == format_matlab) { S.retain_all_levels(); }
+        Timer timer;
 
-        for (int step = 0; step < max_steps+1; step ++)
+        convergence_t convergence;
+        const bool computed = (tolerance > 0.0) ? S.run_adaptive(tolerance, jobs[i][1], convergence) : S.run(jobs[i][1]);
+        const int depth = S.depth();
+
+        char filename[250];
+        sprintf(filename, "subdivision_%s%s_%d%s", mask.name.c_str(), derivative_suffix(derivative).c_str(), depth, format_extension(format));
+        const string path = output_path(dir, filename);
+
+        if (!computed)
         {
-            counter = 0;
-            ofs << "\nX = [";
-            for (double d = 0; d < M; d += pow(2.0, (-1)*step))
+            report[i] = mask.name + ": not enough memory";
+            failed[i] = 1;
+        }
+        else if (!write_output_file(path.c_str(), S, format))
+        {
+            report[i] = mask.name + ": cannot write " + path;
+            failed[i] = 1;
+        }
+        else
+        {
+            ostringstream line;
+            line << path;
+            if (verbosity >= verbosity_summary)
             {
-                ofs << d << " ";
-                counter++;
+                line << " (" << S.level_size(depth) << " samples, " << timer.seconds() << " s)";
             }
-            ofs << "];\nY = [";
-            //for (int j = 1+pow(2.0,max_steps)*M; j < sizeof(S[max_steps+1])/sizeof(*S[max_steps+1]); j++ )
-            for (int j = 1+pow(2.0,step)*M; j < (1+pow(2.0,step)*M) + counter; j++ )
+            if (tolerance > 0.0)
             {
-                ofs << S[step+1][j] << " ";
+                line << " (estimated error " << convergence.error;
+                if (convergence.diverged) { line << ", Warning: no convergence"; }
+                line << ")";
             }
-            ofs << "];\nplot(X,Y);\ntitle('step " << step << "');\npause(0.4);clf;" << endl;
-            //cout << counter << endl;
+            if (!check_norm(mask)) { line << " (Warning: Norm of mask does not equal 2.)"; }
+            report[i] = line.str();
         }
+    });
+
+    int failures = 0;
+    cout << "\nOutput:" << endl;
+    for (size_t i = 0; i < jobs.size(); i++)
+    {
+        cout << report[i] << "\n";
+        failures += failed[i];
+    }
+
+    cout << "\n" << (jobs.size() - failures) << " of " << jobs.size() << " jobs done." << endl
+         << "\nProgram end." << endl;
+
+    return (failures == 0) ? 0 : 1;
+}
+
+
+
+/*
+ * Usage: subdivision --point <mask number> <k> <j>
+ * Prints phi(k / 2^j), or phi^(r)(k / 2^j) with --derivative r, without
+ * running the cascade.
+ */
+static int point_value(int argc, char** argv, int derivative)
+{
+    if (argc != 5)
+    {
+        cout << "\nUsage: subdivision --point <mask number> <k> <j>.\nProgram end." << endl;
+        return 1;
+    }
+
+    const mask_t* mask = select_mask(atoi(argv[2]));
+    const int64_t k = atoll(argv[3]);
+    const int j = atoi(argv[4]);
+    if (mask == NULL || j < 0 || j > 62)
+    {
+        cout << "\nMask has to be in 1..." << builtin_mask_count
+             << " and j in 0...62.\nProgram end." << endl;
+        return 1;
+    }
+
+    const PointEvaluation phi(*mask, derivative);
+    if (!phi.valid())
+    {
+        cout << "\nNo values at the integers for mask " << mask->name;
+        if (derivative > 0) { cout << " and derivative " << derivative; }
+        cout << ".\nProgram end." << endl;
+        return 1;
+    }
+
+    const vector<double>& integers = phi.values_at_integers();
+    cout << "\nMask: " << mask->name << "\nValues at the integers:";
+    for (size_t n = 0; n < integers.size(); n++)
+    {
+        cout << " " << setprecision(17) << integers[n];
+    }
+    cout << "\nphi" << string(derivative, '\'') << "(" << k << " / 2^" << j << ") = " << setprecision(17) << phi(k, j) << endl
+         << "\nProgram end." << endl;
+
+    return 0;
+}
+
+
+
+/*
+ * Usage: subdivision --gram <mask number> <r> [second mask number]
+ * Prints the inner products int phi^(r)(x) phi~^(r)(x - k) dx, phi~ = phi
+ * without a second mask: r = 0 gives the mass, r = 1 the stiffness matrix.
+ */
+static int gram_matrix(int argc, char** argv)
+{
+    if (argc != 4 && argc != 5)
+    {
+        cout << "\nUsage: subdivision --gram <mask number> <r> [second mask number].\nProgram end." << endl;
+        return 1;
+    }
+
+    const mask_t* a = select_mask(atoi(argv[2]));
+    const mask_t* b = select_mask(atoi((argc == 5) ? argv[4] : argv[2]));
+    const int r = atoi(argv[3]);
+    if (a == NULL || b == NULL || r < 0 || r > max_gram_derivative)
+    {
+        cout << "\nMasks have to be in 1..." << builtin_mask_count
+             << " and r in 0..." << max_gram_derivative << ".\nProgram end." << endl;
+        return 1;
+    }
+
+    Timer timer;
+    const band_t* band = select_gram(*a, *b, r);
+    const double elapsed = timer.seconds();
+    if (band == NULL)
+    {
+        cout << "\nNo inner products for " << a->name << " and " << b->name << " with r = " << r
+             << ", sum rule orders " << sum_rule_order(*a) << " and " << sum_rule_order(*b)
+             << " need at least " << 2*r + 1 << " together.\nProgram end." << endl;
+        return 1;
+    }
+
+    cout << "\nMasks: " << a->name << ", " << b->name << "\nDerivative: " << r
+         << "\nBand: " << band_lower(*band) << " lower, " << band_upper(*band) << " upper diagonals\n" << endl;
+    print_band(*band, cout);
+    cout << "\nComputed in " << setprecision(3) << elapsed * 1e6 << " us.\n"
+         << "\nProgram end." << endl;
+
+    return 0;
+}
+
+
+
+/*
+ * Usage: subdivision --tensor <mask number> <second mask number> <subdivision steps> [threads]
+ * Computes phi_a(x) phi_b(y) and writes the grid of the final level to
+ * subdivision_<a>_<b>_<steps> in the selected output format.
+ */
+static int tensor_product(int argc, char** argv, verbosity_t verbosity, output_format_t format)
+{
+    if (argc != 5 && argc != 6)
+    {
+        cout << "\nUsage: subdivision --tensor <mask number> <second mask number> <subdivision steps> [threads].\nProgram end." << endl;
+        return 1;
+    }
+
+    const mask_t* a = select_mask(atoi(argv[2]));
+    const mask_t* b = select_mask(atoi(argv[3]));
+    const int steps = atoi(argv[4]);
+    const int threads = (argc == 6) ? atoi(argv[5]) : 1;
+    if (a == NULL || b == NULL || steps < 0 || steps > Subdivision::max_depth || threads < 0)
+    {
+        cout << "\nMasks have to be in 1..." << builtin_mask_count << ", subdivision steps in {0, ..., "
+             << Subdivision::max_depth << "} and threads nonnegative.\nProgram end." << endl;
+        return 1;
+    }
+
+    TensorSubdivision S(*a, *b);
+    ThreadPool pool(threads);
+    if (pool.size() > 1)
+    {
+        S.set_thread_pool(&pool);
+    }
+
+    Timer timer;
+    if (!S.run(steps))
+    {
+        cout << "\nNot enough memory for " << steps << " subdivision steps.\nProgram end." << endl;
+        return 1;
+    }
+
+    char filename[250];
+    sprintf(filename, "subdivision_%s_%s_%d%s", a->name.c_str(), b->name.c_str(), steps, format_extension(format));
+    double min_value, max_value;
+    if (!S.write(filename, format, min_value, max_value))
+    {
+        cout << "\nCannot write output file '" << filename << "'.\nProgram end." << endl;
+        return 1;
+    }
+    const double seconds = timer.seconds();
 
-        ofs << "\nplot(X,Y, 'b', 'LineWidth', 2);" << endl
-            << "%axis tight;\n%set(gca, 'FontSize', 14);" << endl
-            << "title('mask = ";
-        for (int i = 0; i < M; i++)
+    if (verbosity >= verbosity_summary)
+    {
+        cout << "\nMasks: " << a->name << " (x), " << b->name << " (y)"
+             << "\nGrid: " << S.rows() << " x " << S.columns()
+             << "\nMin: " << min_value << "\nMax: " << max_value
+             << "\nInstruction set: " << isa_name(selected_isa())
+             << "\nThreads: " << pool.size()
+             << "\nTime: " << seconds << " s" << endl;
+    }
+    cout << "\nOutput written to: " << endl
+         << filename << endl
+         << "\nProgram end." << endl;
+
+    return 0;
+}
+
+
+
+/*
+ * Usage: subdivision --lattice <lattice mask number> <subdivision steps> [threads]
+ * Bivariate cascade with the dilation matrix of the mask, the last level
+ * is streamed into the output file strip by strip.
+ */
+static int lattice(int argc, char** argv, verbosity_t verbosity, output_format_t format)
+{
+    const int number = (argc >= 4) ? atoi(argv[2]) : 0;
+    const int steps = (argc >= 4) ? atoi(argv[3]) : -1;
+    const int threads = (argc == 5) ? atoi(argv[4]) : 1;
+    if ((argc != 4 && argc != 5) || select_lattice_mask(number) == NULL || steps < 0
+        || steps > LatticeSubdivision::max_depth || threads < 0)
+    {
+        cout << "\nUsage: subdivision --lattice <lattice mask number> <subdivision steps> [threads].\n"
+             << "Lattice masks:";
+        for (int i = 1; i <= lattice_mask_count; i++)
         {
-            //ofs << mask[i] << ", ";
-            ofs << *(mask.entry + i) << ", ";
+            cout << " " << i << " (" << select_lattice_mask(i)->name << ")";
         }
-        ofs << *(mask.entry + M) //<< mask[M]
-            << "');" << endl
-            << "\nset(gca, 'FontSize', 20);" << endl;
+        cout << ", subdivision steps in {0, ..., " << LatticeSubdivision::max_depth << "}.\nProgram end." << endl;
+        return 1;
+    }
 
+    const lattice_mask_t& mask = *select_lattice_mask(number);
+    LatticeSubdivision S(mask);
+    ThreadPool pool(threads);
+    if (pool.size() > 1)
+    {
+        S.set_thread_pool(&pool);
+    }
 
-        /* plot of result only */
-#else
-        ofs << "X = [";
-        for (double d = 0; d < M; d += pow(2.0, (-1)*max_steps))
+    Timer timer;
+    if (!S.run(steps))
+    {
+        cout << "\nNot enough memory for " << steps << " subdivision steps.\nProgram end." << endl;
+        return 1;
+    }
+
+    char filename[250];
+    sprintf(filename, "subdivision_%s_%d%s", mask.name.c_str(), steps, format_extension(format));
+    double min_value, max_value;
+    if (!S.write(filename, format, min_value, max_value))
+    {
+        cout << "\nCannot write output file '" << filename << "'.\nProgram end." << endl;
+        return 1;
+    }
+    const double seconds = timer.seconds();
+
+    if (verbosity >= verbosity_summary)
+    {
+        const lattice_box_t& box = S.box();
+        cout << "\nMask: " << mask.name
+             << "\nDilation: [" << mask.dilation[0][0] << " " << mask.dilation[0][1] << "; "
+             << mask.dilation[1][0] << " " << mask.dilation[1][1] << "]"
+             << "\nGrid: " << box.rows << " x " << box.columns << ", k0 from " << box.first[0]
+             << ", k1 from " << box.first[1]
+             << "\nMin: " << min_value << "\nMax: " << max_value
+             << "\nThreads: " << pool.size()
+             << "\nTime: " << seconds << " s" << endl;
+    }
+    cout << "\nOutput written to: " << endl
+         << filename << endl
+         << "\nProgram end." << endl;
+
+    return 0;
+}
+
+
+
+/*
+ * Usage: subdivision --precisions <mask number> <subdivision steps> [threads]
+ * Runs the cascade of the mask in float, double, long double and
+ * double-double and reports time, throughput and the largest difference of
+ * the last level to double-double, absolute and relative to its maximum.
+ */
+static int precision_report(int argc, char** argv)
+{
+    const int number = (argc >= 4) ? atoi(argv[2]) : 0;
+    const int steps = (argc >= 4) ? atoi(argv[3]) : -1;
+    const int threads = (argc == 5) ? atoi(argv[4]) : 1;
+    if ((argc != 4 && argc != 5) || select_mask(number) == NULL || steps < 0
+        || steps > Subdivision::max_depth || threads < 0)
+    {
+        cout << "\nUsage: subdivision --precisions <mask number> <subdivision steps> [threads].\n"
+             << "Subdivision steps in {0, ..., " << Subdivision::max_depth << "}.\nProgram end." << endl;
+        return 1;
+    }
+
+    const mask_t& mask = *select_mask(number);
+    ThreadPool pool(threads);
+    vector<precision_run_t> runs;
+    double scale;
+    if (!compare_precisions(mask, steps, pool, runs, scale))
+    {
+        cout << "\nNot enough memory for " << steps << " subdivision steps.\nProgram end." << endl;
+        return 1;
+    }
+
+    const size_t samples = Subdivision(mask).level_size(steps);
+    ostringstream report;
+    report << "\nMask: " << mask.name << "\nSubdivision steps: " << steps
+           << "\nInstruction set: " << isa_name(selected_isa()) << "\nThreads: " << pool.size() << "\n"
+           << "\n    Precision |   Time (s) |    Samples/s |   Difference |     Relative\n"
+           << "---------------------------------------------------------------------------\n";
+    for (int p = precision_float; p <= precision_double_double; p++)
+    {
+        const precision_run_t& run = runs[p];
+        report << setw(13) << precision_name((precision_t) p) << " | " << setw(10) << run.seconds << " | "
+               << setw(12) << samples / max(run.seconds, 1e-9) << " | ";
+        if (p == precision_double_double)
         {
-            ofs << d << " ";
-            counter++;
+            report << setw(12) << "-" << " | " << setw(12) << "-" << "\n";
         }
-        ofs << "];\nY = [";
-        //for (int j = 1+pow(2.0,max_steps)*M; j < sizeof(S[max_steps+1])/sizeof(*S[max_steps+1]); j++ )
-        for (int j = 1+pow(2.0,max_steps)*M; j < (1+pow(2.0,max_steps)*M) + counter; j++ )
+        else
         {
-            ofs << S[max_steps+1][j] << " ";
+            report << setw(12) << run.difference << " | " << setw(12) << run.difference / scale << "\n";
         }
+    }
+    cout << report.str() << "\nProgram end." << endl;
+
+    return 0;
+}
+
 
 
-        ofs << "];\n\nfigure;\nplot(X,Y); % , 'k', 'LineWidth', 2);" << endl
-            << "%axis tight;\n%set(gca, 'FontSize', 14);" << endl
-            << "title('mask = ";
-        for (int i = 0; i < M; i++)
+/*
+ * The main program with --table-cache: the final level is mapped from the
+ * table cache, on a miss it is computed and stored. The matlab output
+ * plots the final level only.
+ * @return 0 on success, 1 if the table cannot be computed, stored or written
+ */
+static int cached_subdivision(const string& directory, unsigned long long capacity, const mask_t& mask,
+                              precision_t precision, int derivative, int steps, int threads, verbosity_t verbosity,
+                              const char* filename, output_format_t format, bool write_output)
+{
+    TableCache cache(directory, capacity);
+    if (!cache.valid())
+    {
+        cout << "\nCannot open table cache '" << directory << "'.\nProgram end." << endl;
+        return 1;
+    }
+
+    const uint64_t key = final_level_key(mask, precision, derivative, steps);
+    const size_t count = Subdivision(mask, derivative).level_size(steps);
+    ThreadPool pool(threads);
+
+    Timer timer;
+    MappedTable table;
+    bool generated;
+    if (!cache.fetch(key, count, [&] (double* values, size_t n) { return final_level(mask, precision, derivative, steps, pool, values, n); },
+                     table, &generated))
+    {
+        cout << "\nCannot compute or store the table of " << steps << " subdivision steps.\nProgram end." << endl;
+        return 1;
+    }
+    const double seconds = timer.seconds();
+
+    const double* values = table.data();
+    if (verbosity >= verbosity_trace)
+    {
+        ostringstream lines;
+        for (size_t k = 0; k < count; k++)
         {
-            //ofs << mask[i] << ", ";
-            ofs << *(mask.entry + i) << ", ";
+            lines << "(" << steps << ", " << k << "): value = " << values[k] << '\n';
+        }
+        cout << lines.str();
+    }
+
+    if (verbosity >= verbosity_summary)
+    {
+        const double min_value = *min_element(values, values + count);
+        const double max_value = *max_element(values, values + count);
+        ostringstream summary;
+        summary << "\nTable: " << cache.table_path(key) << (generated ? " (generated)" : " (cached)") << "\n"
+                << "Samples: " << count << "\n"
+                << "Min: " << min_value << "\n"
+                << "Max: " << max_value << "\n"
+                << "\nSubdivision steps: " << steps << "\n"
+                << "Precision: " << precision_name(precision) << "\n"
+                << "Threads: " << pool.size() << "\n"
+                << "Time: " << seconds << " s\n";
+        cout << summary.str();
+    }
+
+    if (write_output)
+    {
+        BufferedWriter ofs;
+        bool written = ofs.open(filename);
+        if (written && format != format_matlab)
+        {
+            if (format == format_npy) { write_npy_header(ofs, vector<size_t>(1, count)); }
+            ofs.write_values(values, count, format);
+        }
+        else if (written)
+        {
+            const double h = ldexp(1.0, -steps);
+            ofs << "X = [";
+            for (size_t k = 0; k < count; k++) { ofs << k * h << " "; }
+            ofs << "];\nY = [";
+            for (size_t k = 0; k < count; k++) { ofs << values[k] << " "; }
+            ofs << "];\n\nfigure;\nplot(X,Y, 'b', 'LineWidth', 2);\n"
+                << "title('" << mask.name << ", step " << steps << "');\n"
+                << "\nset(gca, 'FontSize', 20);\n";
+        }
+        if (!(ofs.close() && written))
+        {
+            cout << "\nCannot write output file '" << filename << "'." << endl;
+            return 1;
         }
-        ofs << *(mask.entry + M) //<< mask[M]
-            << "');" << endl;
+
+        cout << "\nOutput written to: " << endl
+             << filename << endl;
+    }
+
+    return 0;
+}
+
+
+/*
+ * the subdivision of the main program with samples of type T
+ * @return 0 on success, 1 if memory is exhausted or the file cannot be written
+ */
+template <typename T>
+static int subdivide(const mask_t& mask, precision_t precision, int derivative, int max_steps, int threads,
+                     double tolerance, verbosity_t verbosity, const char* filename, output_format_t format,
+                     bool write_output)
+{
+    /* program parameters */
+    BasicSubdivision<T> S(mask, derivative);
+    ThreadPool pool(threads);
+    if (pool.size() > 1)
+    {
+        S.set_thread_pool(&pool);
+    }
+
+#if 1
+    if ((write_output && format == format_matlab) || verbosity >= verbosity_trace)
+    {
+        S.retain_all_levels(); /* needed for the plot of every step and the trace below */
+    }
 #endif
 
-        // </editor-fold>
+    /* subdivision scheme */
+    Timer timer;
+    convergence_t convergence;
+    if (!((tolerance > 0.0) ? S.run_adaptive(tolerance, max_steps, convergence) : S.run(max_steps)))
+    {
+        cout << "\nNot enough memory for " << max_steps << " subdivision steps.\nProgram end." << endl;
+        return 1;
+    }
+    const double seconds = timer.seconds();
+
+    if (verbosity >= verbosity_trace)
+    {
+        for (int j = 1; j <= S.depth(); j++)
+        {
+            const T* values = S.level(j);
+            for (size_t k = 0; k < S.level_size(j); k++)
+            {
+                cout << "(" << j << ", " << k << "): value = " << to_double(values[k]) << '\n';
+            }
+        }
+    }
+
+    if (verbosity >= verbosity_summary)
+    {
+        print_summary(S, precision, pool.size(), seconds);
+    }
+    if (tolerance > 0.0)
+    {
+        print_convergence(convergence, tolerance);
+    }
+
+
+    if (write_output)
+    {
+        if (!write_output_file(filename, S, format))
+        {
+            cout << "\nCannot write output file '" << filename << "'." << endl;
+            return 1;
+        }
 
-        ofs.close();
 
         cout << "\nOutput written to: " << endl
              << filename << endl;
     }
 
-    /* check norm of mask: the sum of the mask elements should be equal to 2 */
-    double norm_of_mask = 0.0;
-    for (int i = 0; i < mask.length; i++)
+    return 0;
+}
+
+
+
+/*
+ * Usage: subdivision [mask number] [subdivision steps] [threads]
+ *        subdivision --batch ...
+ *        subdivision --point <mask number> <k> <j>
+ *        subdivision --gram <mask number> <r> [second mask number]
+ *        subdivision --tensor <mask number> <second mask number> <steps> [threads]
+ *        subdivision --lattice <lattice mask number> <steps> [threads]
+ *        subdivision --precisions <mask number> <steps> [threads]
+ *        subdivision --verify
+ *
+ * -q suppresses the summary, -v additionally prints every sample.
+ * --format {m, npy, f64, f32} selects the output format (default m).
+ * --tolerance eps refines until the estimated error is below eps, the
+ * subdivision steps (default 20) become an upper limit.
+ * --derivative r computes phi^(r) by the cascade of the derivative mask.
+ * --precision {float, double, long_double, double_double} selects the type
+ * of the samples (default double), the output is rounded to double.
+ * --table-cache directory maps the final level from a cache of tables
+ * shared by processes and stores it there on a miss, --table-limit MB
+ * bounds the size of the cache (default 1024).
+ */
+int main(int argc, char** argv)
+{
+    const verbosity_t verbosity = take_verbosity(argc, argv);
+
+    cout << "Subdivision to visualize refinable functions." << endl;
+
+    string format_name;
+    output_format_t format = format_matlab;
+    if (take_option(argc, argv, "--format", format_name) && !parse_output_format(format_name, format))
     {
-        norm_of_mask += *(mask.entry + i);
+        cout << "\nOutput format has to be m, npy, f64 or f32.\nProgram end." << endl;
+        return 1;
+    }
+
+    string tolerance_value;
+    double tolerance = 0.0;
+    if (take_option(argc, argv, "--tolerance", tolerance_value) && !((tolerance = atof(tolerance_value.c_str())) > 0.0))
+    {
+        cout << "\nTolerance has to be positive.\nProgram end." << endl;
+        return 1;
+    }
+
+    string derivative_value;
+    int derivative = 0;
+    if (take_option(argc, argv, "--derivative", derivative_value) && (derivative = atoi(derivative_value.c_str())) < 0)
+    {
+        cout << "\nDerivative order has to be nonnegative.\nProgram end." << endl;
+        return 1;
+    }
+
+    string precision_value;
+    precision_t precision = precision_double;
+    if (take_option(argc, argv, "--precision", precision_value) && !parse_precision(precision_value, precision))
+    {
+        cout << "\nPrecision has to be float, double, long_double or double_double.\nProgram end." << endl;
+        return 1;
+    }
+
+    string table_cache, table_limit;
+    const bool use_table_cache = take_option(argc, argv, "--table-cache", table_cache);
+    long long limit = 1024; /* megabytes of the table cache */
+    if (take_option(argc, argv, "--table-limit", table_limit) && (limit = atoll(table_limit.c_str())) < 1)
+    {
+        cout << "\nTable cache limit has to be positive.\nProgram end." << endl;
+        return 1;
+    }
+    if (use_table_cache && tolerance > 0.0)
+    {
+        cout << "\nThe table cache needs a fixed number of subdivision steps, no tolerance.\nProgram end." << endl;
+        return 1;
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--batch")
+    {
+        return batch(argc, argv, verbosity, format, tolerance, derivative);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--point")
+    {
+        return point_value(argc, argv, derivative);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--tensor")
+    {
+        return tensor_product(argc, argv, verbosity, format);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--lattice")
+    {
+        return lattice(argc, argv, verbosity, format);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--gram")
+    {
+        return gram_matrix(argc, argv);
+    }
+
+    if (argc >= 2 && string(argv[1]) == "--precisions")
+    {
+        return precision_report(argc, argv);
+    }
+
+    /* compare the vectorized refinement kernels with the scalar reference and the point evaluation with the refinement equation */
+    if (argc == 2 && string(argv[1]) == "--verify")
+    {
+        bool all_equal = true;
+        cout << "\nInstruction set: " << isa_name(detect_isa()) << "\n" << endl;
+        for (int i = 0; i < builtin_mask_count; i++)
+        {
+            all_equal = verify_kernels(builtin_masks[i], &cout) && all_equal;
+        }
+        all_equal = verify_point_evaluation(&cout) && all_equal;
+        cout << endl;
+        all_equal = verify_gram(&cout) && all_equal;
+        all_equal = verify_tensor(&cout) && all_equal;
+        all_equal = verify_lattice(&cout) && all_equal;
+        all_equal = verify_precisions(&cout) && all_equal;
+        all_equal = verify_derivatives(&cout) && all_equal;
+        all_equal = verify_table_cache(&cout) && all_equal;
+        all_equal = verify_c_refinable(&cout) && all_equal;
+        cout << (all_equal ? "\nAll kernels agree." : "\nWarning: Kernels differ.") << endl;
+        return all_equal ? 0 : 1;
+    }
+
+    int selected_mask = 0;
+    int max_steps = (tolerance > 0.0) ? 20 : 8; /* maximal subdivision steps, e.g., 8 */
+    int threads = 1;   /* threads per level, 0 uses all hardware threads */
+
+    /* check if user passed mask and subdivision steps as program parameter */
+    if (argc >= 2)
+    {
+        selected_mask = atoi(argv[1]);
+        if (argc >= 3) { max_steps = atoi(argv[2]); }
+        if (argc >= 4) { threads = atoi(argv[3]); }
+        cout << "\nMask: " << selected_mask << endl
+             << "Subdivision steps: " << max_steps << endl;
+    }
+    else
+    {
+        cout << "\nNumber | Refinement function" << endl
+             << "----------------------------" << endl
+             << "   1   |  Haar            " << endl
+             << "   2   |  N_2             " << endl
+             << "   3   |  N_3             " << endl
+             << "   4   |  N_4             " << endl
+             << "   5   |  N_5             " << endl
+             << "   6   |  N_6             " << endl
+             << "   7   |  I_4             " << endl
+             << "   8   |  I_6             " << endl
+             << "   9   |  Daubechies 2    " << endl
+             << "  10   |  CDF (1,3) dual  " << endl
+             << "  11   |  CDF (2,2) dual  " << endl
+             << "  12   |  CDF (3,5) dual  " << endl
+             << "  13   |  CDF (4,6) dual  " << endl
+             << "\nSelect mask {1, 2, ...}: ";
+        cin >> selected_mask;
+    }
+
+    const mask_t* selected = select_mask(selected_mask);
+    if (selected == NULL)
+    {
+        cout << "\nNo mask implemented for this input.\nProgram end." << endl;
+        return 1;
+    }
+    const mask_t& mask = *selected;
+
+    if (!Subdivision(mask, derivative).valid())
+    {
+        cout << "\nMask " << mask.name << " has no derivative mask of order " << derivative
+             << ", its sum rule order is " << sum_rule_order(mask) << ".\nProgram end." << endl;
+        return 1;
+    }
+
+    if (max_steps < 0 || max_steps > Subdivision::max_depth)
+    {
+        cout << "\nSubdivision steps have to be in {0, ..., " << Subdivision::max_depth << "}.\nProgram end." << endl;
+        return 1;
+    }
+
+    /* setup output file */
+    char filename[250];
+    const char *cstr = mask.name.c_str();
+    sprintf(filename, "subdivision_%s%s%s", cstr, derivative_suffix(derivative).c_str(), format_extension(format)); //, max_steps);
+
+    /* ask user if output should be written to file */
+    char answer = 'n';
+    cout << "\nWrite output to file '" << filename << "' [y,N]? ";
+    cin >> answer;
+    const bool write_output = (answer == 'y' || answer == 'Y');
+
+    cout << "\nOutput:" << endl;
+
+    int status;
+    if (use_table_cache)
+    {
+        status = cached_subdivision(table_cache, (unsigned long long) limit << 20, mask, precision, derivative, max_steps,
+                                    threads, verbosity, filename, format, write_output);
+    }
+    else
+    {
+        switch (precision)
+        {
+            case precision_float:
+                status = subdivide<float>(mask, precision, derivative, max_steps, threads, tolerance, verbosity, filename, format, write_output);
+                break;
+            case precision_long_double:
+                status = subdivide<long double>(mask, precision, derivative, max_steps, threads, tolerance, verbosity, filename, format, write_output);
+                break;
+            case precision_double_double:
+                status = subdivide<dd_real>(mask, precision, derivative, max_steps, threads, tolerance, verbosity, filename, format, write_output);
+                break;
+            default:
+                status = subdivide<double>(mask, precision, derivative, max_steps, threads, tolerance, verbosity, filename, format, write_output);
+        }
     }
+    if (status != 0) { return status; }
 
-    if (norm_of_mask != 2.0)
+    if (!check_norm(mask))
     {
         cout << "\nWarning: Norm of mask does not equal 2." << endl;
     }
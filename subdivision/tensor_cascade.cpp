@@ -0,0 +1,216 @@
+/*
+ * tensor_cascade.cpp
+ * Tensor product subdivision for bivariate refinable functions phi_a(x) phi_b(y).
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#include <cstring>
+#include <math.h>
+#include <algorithm>
+#include <new>
+#include "tensor_cascade.h"
+
+using namespace std;
+
+/* columns of a tile of the column pass, the taps of a tile stay in the first level cache */
+static const size_t tile_columns = 512;
+
+/* smaller grids are not worth waking up the threads */
+static const size_t min_rows_per_thread = 16;
+
+
+/*
+ * row pass for the coarse rows [begin, end), each row is copied behind
+ * the zeros the kernel reads in front of it
+ */
+static void refine_rows(const polyphase_t& a, refine_kernel_t kernel, const double* coarse, size_t columns,
+                        size_t begin, size_t end, double* refined)
+{
+    const size_t per_line = cache_line_size / sizeof(double);
+    const size_t padding = ((a.padding + per_line - 1) / per_line) * per_line;
+    AlignedBuffer<double> row(padding + columns);
+
+    for (size_t i = begin; i < end; i++)
+    {
+        memcpy(row.data() + padding, coarse + i * columns, columns * sizeof(double));
+        kernel(a, row.data() + padding, 0, columns, refined + i * 2 * columns);
+    }
+}
+
+
+/*
+ * column pass for the fine rows [begin, end): fine row 2i + p is
+ * sum_t tap_p[t] refined row (i - t), tile by tile of columns
+ */
+static void refine_columns(const polyphase_t& b, const double* refined, size_t rows, size_t columns,
+                           size_t begin, size_t end, double* fine)
+{
+    const size_t stride = 2 * columns, fine_columns = 2 * columns - 1;
+
+    for (size_t c0 = 0; c0 < fine_columns; c0 += tile_columns)
+    {
+        const size_t c1 = min(fine_columns, c0 + tile_columns);
+        for (size_t k = begin; k < end; k++)
+        {
+            const size_t i = k / 2;
+            const vector<double>& tap = (k % 2 == 0) ? b.even : b.odd;
+            double* out = fine + k * fine_columns;
+
+            for (size_t c = c0; c < c1; c++) { out[c] = 0.0; }
+            for (size_t t = 0; t < tap.size() && t <= i; t++)
+            {
+                if (i - t >= rows) { continue; }
+                const double tap_t = tap[t];
+                const double* in = refined + (i - t) * stride;
+                for (size_t c = c0; c < c1; c++) { out[c] += tap_t * in[c]; }
+            }
+        }
+    }
+}
+
+
+bool refine_tensor(const polyphase_t& a, const polyphase_t& b, const double* coarse, size_t rows, size_t columns,
+                   double* fine, ThreadPool* pool)
+{
+    if (rows == 0 || columns == 0) { return true; }
+
+    AlignedBuffer<double> refined;
+    try
+    {
+        refined.resize(rows * 2 * columns);
+    }
+    catch (const bad_alloc&)
+    {
+        return false;
+    }
+
+    const refine_kernel_t kernel = refine_kernel(selected_isa(), (int) (a.even.size() + a.odd.size()));
+    const size_t fine_rows = 2 * rows - 1;
+
+    if (pool == NULL)
+    {
+        refine_rows(a, kernel, coarse, columns, 0, rows, refined.data());
+        refine_columns(b, refined.data(), rows, columns, 0, fine_rows, fine);
+    }
+    else
+    {
+        pool->parallel_for(0, rows, 1, min_rows_per_thread, [&] (size_t begin, size_t end) {
+            refine_rows(a, kernel, coarse, columns, begin, end, refined.data());
+        });
+        pool->parallel_for(0, fine_rows, 2, min_rows_per_thread, [&] (size_t begin, size_t end) {
+            refine_columns(b, refined.data(), rows, columns, begin, end, fine);
+        });
+    }
+
+    return true;
+}
+
+
+
+TensorSubdivision::TensorSubdivision(const mask_t& a, const mask_t& b)
+    : along_x(a), along_y(b), threads(NULL)
+{
+}
+
+
+void TensorSubdivision::set_thread_pool(ThreadPool* pool)
+{
+    threads = pool;
+    along_x.set_thread_pool(pool);
+    along_y.set_thread_pool(pool);
+}
+
+
+bool TensorSubdivision::run(int depth)
+{
+    return along_x.run(depth) && along_y.run(depth);
+}
+
+
+bool TensorSubdivision::stream(const strip_consumer_t& consumer) const
+{
+    if (depth() < 0) { return false; }
+
+    return stream_tensor_product(values_x(), columns(), values_y(), rows(), threads, consumer);
+}
+
+
+bool TensorSubdivision::write(const char* filename, output_format_t format, double& min_value, double& max_value) const
+{
+    if (depth() < 0) { return false; }
+
+    /* sample j of a level of depth J belongs to x = j / 2^J */
+    vector<double> x(columns()), y(rows());
+    for (size_t j = 0; j < x.size(); j++) { x[j] = ldexp((double) j, -depth()); }
+    for (size_t i = 0; i < y.size(); i++) { y[i] = ldexp((double) i, -depth()); }
+
+    const string title = along_x.mask().name + "(x) " + along_y.mask().name + "(y)";
+    return write_tensor_product(filename, format, title, x.data(), values_x(), x.size(),
+                                y.data(), values_y(), y.size(), threads, min_value, max_value);
+}
+
+
+
+bool verify_tensor(ostream* log)
+{
+    const int numbers[] = {2, 7, 9};
+    const int steps = 4;
+    bool valid = true;
+    double max_error = 0.0;
+    ThreadPool pool(2);
+
+    for (int p : numbers)
+    {
+        for (int q : numbers)
+        {
+            const mask_t& a = *select_mask(p);
+            const mask_t& b = *select_mask(q);
+            const polyphase_t pa = polyphase(a), pb = polyphase(b);
+
+            /* bivariate cascade from the delta sequence, serially and threaded */
+            size_t rows = b.length, columns = a.length;
+            vector<double> level(rows * columns, 0.0), threaded;
+            level[0] = 1.0;
+            threaded = level;
+            for (int j = 1; j <= steps; j++)
+            {
+                vector<double> fine((2*rows - 1) * (2*columns - 1)), fine_threaded(fine.size());
+                valid = valid && refine_tensor(pa, pb, level.data(), rows, columns, fine.data(), NULL);
+                valid = valid && refine_tensor(pa, pb, threaded.data(), rows, columns, fine_threaded.data(), &pool);
+                level.swap(fine);
+                threaded.swap(fine_threaded);
+                rows = 2*rows - 1;
+                columns = 2*columns - 1;
+            }
+            valid = valid && memcmp(level.data(), threaded.data(), level.size() * sizeof(double)) == 0;
+
+            /* tensor product of the univariate cascades */
+            TensorSubdivision S(a, b);
+            valid = valid && S.run(steps) && S.rows() == rows && S.columns() == columns;
+            double error = 0.0, scale = 0.0;
+            S.stream([&] (size_t first, const double* values, size_t count) {
+                for (size_t k = 0; k < count * columns; k++)
+                {
+                    error = max(error, fabs(values[k] - level[first * columns + k]));
+                    scale = max(scale, fabs(values[k]));
+                }
+                return true;
+            });
+            max_error = max(max_error, error);
+            valid = valid && error <= 1e-14 * max(1.0, scale);
+        }
+    }
+
+    if (log != NULL)
+    {
+        *log << "Tensor products: " << sizeof(numbers) / sizeof(numbers[0]) * (sizeof(numbers) / sizeof(numbers[0]))
+             << " pairs, error " << max_error << (valid ? "" : "  FAILED") << "\n";
+    }
+
+    return valid;
+}
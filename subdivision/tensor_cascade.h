@@ -0,0 +1,111 @@
+/*
+ * tensor_cascade.h
+ * Tensor product subdivision for bivariate refinable functions phi_a(x) phi_b(y).
+ *
+ * This software is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either expressed or implied.
+ *
+ * Contact:  AG Numerik, Philipps-University Marburg
+ */
+
+#ifndef SUBDIVISION_TENSOR_CASCADE_H
+#define SUBDIVISION_TENSOR_CASCADE_H
+
+#include <cstddef>
+#include <ostream>
+#include <vector>
+#include "masks.h"
+#include "kernels.h"
+#include "cascade.h"
+#include "../common/aligned_buffer.h"
+#include "../common/thread_pool.h"
+#include "../common/tensor_grid.h"
+
+
+/*
+ * One step of the bivariate cascade with the tensor product mask
+ * a[k] b[l] on a grid of rows x columns samples, row major, x along the
+ * rows (mask a) and y along the columns (mask b):
+ *   fine[k][l] = sum_{m,n} b[k-2m] a[l-2n] coarse[m][n].
+ * Row pass: every coarse row is refined by the polyphase kernel of a.
+ * Column pass: the fine rows 2i and 2i+1 are the sums of the refined rows
+ * i-t times the even and odd taps of b, computed as whole rows tile by
+ * tile of columns, so no column is gathered or transposed and the taps
+ * of a tile stay in the cache.
+ * @param a, b polyphase forms of the masks
+ * @param coarse rows * columns samples
+ * @param fine (2 rows - 1) * (2 columns - 1) samples
+ * @param pool threads, NULL computes serially, the result does not depend
+ *        on the number of threads
+ * @return false if memory is exhausted
+ */
+bool refine_tensor(const polyphase_t& a, const polyphase_t& b, const double* coarse, size_t rows, size_t columns,
+                   double* fine, ThreadPool* pool);
+
+
+/*
+ * Levels of phi_a(x) phi_b(y) on [0, M_a] x [0, M_b]: the delta sequence
+ * is a tensor product, so the bivariate cascade from it is the tensor
+ * product of the univariate cascades. Both are run by Subdivision (row
+ * pass and column pass), the grid of the final level is produced strip by
+ * strip by stream_tensor_product() and never held in memory as a whole.
+ */
+class TensorSubdivision
+{
+public:
+    /*
+     * @param a mask along x, the coefficients are not copied
+     * @param b mask along y
+     */
+    TensorSubdivision(const mask_t& a, const mask_t& b);
+
+    /*
+     * @param pool threads used by run() and stream(), NULL (default) computes serially
+     */
+    void set_thread_pool(ThreadPool* pool);
+
+    /*
+     * @param depth number of subdivision steps
+     * @return false if depth is out of range or memory is exhausted
+     */
+    bool run(int depth);
+
+    int depth() const { return along_x.depth(); }
+
+    /* samples per row (along x) and per column (along y) of the final level */
+    size_t columns() const { return along_x.level_size(depth()); }
+    size_t rows() const { return along_y.level_size(depth()); }
+
+    /* univariate factors of the final level */
+    const double* values_x() const { return along_x.values(); }
+    const double* values_y() const { return along_y.values(); }
+
+    /*
+     * the final level, F[i][j] = phi_b(i / 2^depth) phi_a(j / 2^depth)
+     * @return false if memory is exhausted or the consumer stopped
+     */
+    bool stream(const strip_consumer_t& consumer) const;
+
+    /*
+     * the final level as file, see write_tensor_product()
+     * @return false if the file cannot be written
+     */
+    bool write(const char* filename, output_format_t format, double& min_value, double& max_value) const;
+
+private:
+    Subdivision along_x;
+    Subdivision along_y;
+    ThreadPool* threads;
+};
+
+/*
+ * Compare a few steps of refine_tensor() from the delta sequence with the
+ * tensor product of the univariate cascades for all pairs of the masks 2,
+ * 7 and 9, serially and with two threads.
+ * @param log receives a summary line, may be NULL
+ * @return true if all agree within rounding and the threaded steps bit for bit
+ */
+bool verify_tensor(std::ostream* log);
+
+#endif /* SUBDIVISION_TENSOR_CASCADE_H */